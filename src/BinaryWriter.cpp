@@ -0,0 +1,152 @@
+/*
+ * BinaryWriter.cpp
+ *
+ * Compact binary frames for AUX devices, see BinaryWriter.h
+ */
+
+#include "RepRapFirmware.h"
+
+BinaryWriter::BinaryWriter(OutputBuffer *buf, bool framed) : buf(buf), framed(framed), sum1(0), sum2(0), blockLength(0)
+{
+	if (framed)
+	{
+		buf->cat((char)frameDelimiter);
+	}
+}
+
+// Consistent Overhead Byte Stuffing: each block of up to 254 non-zero bytes is preceded by its length plus one.
+// A block shorter than 254 bytes stands for the block followed by a zero byte.
+void BinaryWriter::Put(uint8_t b)
+{
+	if (!framed)
+	{
+		buf->cat((char)b);
+		return;
+	}
+
+	sum1 = (sum1 + b) % 255;
+	sum2 = (sum2 + sum1) % 255;
+
+	if (b == 0)
+	{
+		FlushBlock();
+	}
+	else
+	{
+		block[blockLength++] = b;
+		if (blockLength == maxBlockLength)
+		{
+			FlushBlock();
+		}
+	}
+}
+
+void BinaryWriter::FlushBlock()
+{
+	buf->cat((char)(blockLength + 1));
+	buf->cat((const char *)block, blockLength);
+	blockLength = 0;
+}
+
+void BinaryWriter::Byte(uint8_t value)
+{
+	Put(value);
+}
+
+void BinaryWriter::UInt(uint32_t value)
+{
+	while (value >= 0x80)
+	{
+		Put((uint8_t)(value | 0x80));
+		value >>= 7;
+	}
+	Put((uint8_t)value);
+}
+
+void BinaryWriter::Int(int32_t value)
+{
+	UInt(((uint32_t)value << 1) ^ (uint32_t)(value >> 31));
+}
+
+void BinaryWriter::Fixed(float value, uint8_t decimals)
+{
+	double scaled = value;
+	while (decimals != 0)
+	{
+		scaled *= 10.0;
+		--decimals;
+	}
+	Int((int32_t)lrint(max<double>(min<double>(scaled, 2147483647.0), -2147483647.0)));
+}
+
+void BinaryWriter::String(const char *s, size_t maxLength)
+{
+	const size_t length = strnlen(s, maxLength);
+	UInt(length);
+	for (size_t i = 0; i < length; i++)
+	{
+		Put((uint8_t)s[i]);
+	}
+}
+
+void BinaryWriter::Reply(OutputBuffer *reply)
+{
+	UInt((reply == nullptr) ? 0 : reply->Length());
+	while (reply != nullptr)
+	{
+		for (size_t i = 0; i < reply->DataLength(); i++)
+		{
+			Put((uint8_t)reply->Data()[i]);
+		}
+		reply = OutputBuffer::Release(reply);
+	}
+}
+
+void BinaryWriter::Bytes(const OutputBuffer *src, size_t start, size_t length)
+{
+	for (; src != nullptr && length != 0; src = src->Next())
+	{
+		if (start >= src->DataLength())
+		{
+			start -= src->DataLength();
+			continue;
+		}
+		const size_t count = min<size_t>(src->DataLength() - start, length);
+		for (size_t i = 0; i < count; i++)
+		{
+			Put((uint8_t)src->Data()[start + i]);
+		}
+		length -= count;
+		start = 0;
+	}
+}
+
+/*static*/ void BinaryWriter::Fingerprint(const OutputBuffer *src, size_t start, size_t length, StatusFingerprint& fp)
+{
+	for (; src != nullptr && length != 0; src = src->Next())
+	{
+		if (start >= src->DataLength())
+		{
+			start -= src->DataLength();
+			continue;
+		}
+		const size_t count = min<size_t>(src->DataLength() - start, length);
+		for (size_t i = 0; i < count; i++)
+		{
+			fp.AddByte((uint8_t)src->Data()[start + i]);
+		}
+		length -= count;
+		start = 0;
+	}
+}
+
+void BinaryWriter::Finish()
+{
+	const uint8_t check1 = (uint8_t)sum1, check2 = (uint8_t)sum2;
+	Put(check1);
+	Put(check2);
+	FlushBlock();									// the decoder drops the zero implied at the end of the last block
+	buf->cat((char)frameDelimiter);
+}
+
+// End
@@ -0,0 +1,51 @@
+/*
+ * BinaryWriter.h
+ *
+ * Writes a compact binary frame into a chain of OutputBuffers, for devices on the AUX port that don't want to parse
+ * JSON. Unsigned numbers are sent as little-endian base-128 varints, signed numbers are zigzag-encoded first, and
+ * floats are sent as signed integers scaled by a power of ten, i.e. with the same precision as the JSON responses.
+ * Strings are sent as a varint length followed by the bytes.
+ *
+ * The payload is followed by a Fletcher-16 checksum and sent COBS-encoded between two zero bytes. A frame therefore
+ * never contains a zero byte, so a device can resynchronise at the next zero and tell frames apart from the JSON text
+ * that is still sent for messages and beeps.
+ *
+ * An unframed writer appends the plain encoded bytes to its buffer instead. The status frame uses one to encode its sections
+ * once, so that it can fingerprint them to find out which ones have changed and then copy the bytes of those into the frame.
+ */
+
+#ifndef BINARYWRITER_H_
+#define BINARYWRITER_H_
+
+class BinaryWriter
+{
+  public:
+	BinaryWriter(OutputBuffer *buf, bool framed = true);
+
+	void Byte(uint8_t value);
+	void UInt(uint32_t value);
+	void Int(int32_t value);
+	void Fixed(float value, uint8_t decimals);					// sent as Int(value * 10^decimals)
+	void String(const char *s, size_t maxLength = 0xFFFF);
+	void Reply(OutputBuffer *reply);							// send a whole chain as a string and release it
+	void Bytes(const OutputBuffer *src, size_t start, size_t length);	// copy bytes written by an unframed writer
+	void Finish();												// append the checksum and end the frame
+
+	static void Fingerprint(const OutputBuffer *src, size_t start, size_t length, StatusFingerprint& fp);
+
+	static const uint8_t frameDelimiter = 0;
+
+  private:
+	static const size_t maxBlockLength = 254;
+
+	void Put(uint8_t b);
+	void FlushBlock();
+
+	OutputBuffer *buf;
+	bool framed;
+	uint16_t sum1, sum2;
+	size_t blockLength;
+	uint8_t block[maxBlockLength];								// the COBS block being assembled
+};
+
+#endif /* BINARYWRITER_H_ */
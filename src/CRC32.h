@@ -0,0 +1,24 @@
+/*
+ * CRC32.h
+ *
+ * The standard CRC-32 (as used by zip and Ethernet), so that a client can check that an uploaded file has arrived
+ * intact. It is worked out a span at a time from the data as it is written to the file.
+ */
+
+#ifndef CRC32_H_
+#define CRC32_H_
+
+class CRC32
+{
+  public:
+	CRC32() { Reset(); }
+
+	void Reset() { crc = 0xFFFFFFFF; }
+	void Update(const char *data, size_t len);
+	uint32_t Get() const { return ~crc; }
+
+  private:
+	uint32_t crc;
+};
+
+#endif /* CRC32_H_ */
@@ -0,0 +1,137 @@
+/*
+ * CommandProfiler.cpp
+ *
+ * Execution statistics for G-Codes, see CommandProfiler.h
+ */
+
+//*************************************************************************************
+
+#include "RepRapFirmware.h"
+
+CommandProfiler::CommandProfiler(Platform* p) : platform(p)
+{
+	Init();
+}
+
+void CommandProfiler::Init()
+{
+	numEntries = 0;
+	otherEntry.letter = 0;
+	otherEntry.code = 0;
+	otherEntry.count = 0;
+}
+
+// Find the entry for a code, adding it if we haven't seen it before
+CommandProfiler::ProfileEntry *CommandProfiler::Find(char letter, int code)
+{
+	for (size_t i = 0; i < numEntries; i++)
+	{
+		if (entries[i].letter == letter && entries[i].code == code)
+		{
+			return &entries[i];
+		}
+	}
+
+	ProfileEntry *entry;
+	if (numEntries < COMMAND_PROFILE_ENTRIES)
+	{
+		entry = &entries[numEntries++];
+		entry->letter = letter;
+		entry->code = code;
+		entry->count = 0;
+	}
+	else
+	{
+		entry = &otherEntry;
+	}
+	return entry;
+}
+
+void CommandProfiler::Record(char letter, int code, const GCodeBuffer *gb)
+{
+	const uint32_t elapsed = micros() - gb->ExecutionStartTime();
+	const uint32_t calls = gb->ExecutionCalls();
+
+	ProfileEntry *entry = Find(letter, code);
+	if (entry->count == 0)
+	{
+		entry->totalTime = entry->totalCalls = 0;
+		entry->minTime = elapsed;
+		entry->maxTime = entry->maxCallTime = entry->maxCalls = 0;
+	}
+	++entry->count;
+	entry->totalTime += elapsed;
+	entry->minTime = min<uint32_t>(entry->minTime, elapsed);
+	entry->maxTime = max<uint32_t>(entry->maxTime, elapsed);
+	entry->maxCallTime = max<uint32_t>(entry->maxCallTime, gb->ExecutionMaxCallTime());
+	entry->totalCalls += calls;
+	entry->maxCalls = max<uint32_t>(entry->maxCalls, calls);
+}
+
+void CommandProfiler::Report()
+{
+	platform->Message(GENERIC_MESSAGE, "Command execution times in microseconds:\n");
+	for (size_t i = 0; i <= numEntries; i++)
+	{
+		const ProfileEntry& entry = (i < numEntries) ? entries[i] : otherEntry;
+		if (entry.count == 0)
+		{
+			continue;
+		}
+
+		char name[8];
+		if (entry.letter == 0)
+		{
+			strcpy(name, "other");
+		}
+		else
+		{
+			snprintf(name, ARRAY_SIZE(name), "%c%d", entry.letter, entry.code);
+		}
+		platform->MessageF(GENERIC_MESSAGE, "%s: count %lu, min %lu, avg %lu, max %lu, max blocking %lu, spins avg %lu max %lu\n",
+							name, entry.count, entry.minTime, (uint32_t)(entry.totalTime / entry.count), entry.maxTime, entry.maxCallTime,
+							(uint32_t)(entry.totalCalls / entry.count), entry.maxCalls);
+	}
+}
+
+OutputBuffer *CommandProfiler::GetJsonResponse()
+{
+	OutputBuffer *response;
+	if (!OutputBuffer::Allocate(response))
+	{
+		return nullptr;
+	}
+
+	response->copy("{\"profile\":[");
+	bool first = true;
+	for (size_t i = 0; i <= numEntries; i++)
+	{
+		const ProfileEntry& entry = (i < numEntries) ? entries[i] : otherEntry;
+		if (entry.count == 0)
+		{
+			continue;
+		}
+
+		if (!first)
+		{
+			response->cat(",");
+		}
+		first = false;
+
+		if (entry.letter == 0)
+		{
+			response->cat("{\"code\":\"other\"");
+		}
+		else
+		{
+			response->catf("{\"code\":\"%c%d\"", entry.letter, entry.code);
+		}
+		response->catf(",\"count\":%lu,\"min\":%lu,\"avg\":%lu,\"max\":%lu,\"maxBlocking\":%lu,\"avgSpins\":%lu,\"maxSpins\":%lu}",
+						entry.count, entry.minTime, (uint32_t)(entry.totalTime / entry.count), entry.maxTime, entry.maxCallTime,
+						(uint32_t)(entry.totalCalls / entry.count), entry.maxCalls);
+	}
+	response->cat("]}");
+	return response;
+}
+
+// End
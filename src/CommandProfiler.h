@@ -0,0 +1,46 @@
+/*
+ * CommandProfiler.h
+ *
+ * Execution statistics for the commands that GCodes::ActOnCode runs. For each G-, M- and T-code we record how
+ * often it was run, how long it took from the first attempt to execute it until it completed (min/avg/max),
+ * the longest time a single attempt blocked the main loop, and how many calls to GCodes::Spin it needed.
+ * Codes that don't fit in the table are added up in a single "other" entry.
+ */
+
+#ifndef COMMANDPROFILER_H_
+#define COMMANDPROFILER_H_
+
+const size_t COMMAND_PROFILE_ENTRIES = 32;				// Number of different codes we keep statistics for
+
+class CommandProfiler
+{
+  public:
+    CommandProfiler(Platform* p);
+    void Init();										// Discard all the statistics
+    void Record(char letter, int code, const GCodeBuffer *gb);	// Record a code that has just completed
+    void Report();										// Print the table for M123
+    OutputBuffer *GetJsonResponse();					// Get the table in JSON format for M408 S6
+
+  private:
+    struct ProfileEntry
+    {
+        char letter;									// 'G', 'M' or 'T', or 0 for the entry that collects the other codes
+        int code;
+        uint32_t count;
+        uint64_t totalTime;								// Times are in microseconds
+        uint32_t minTime;
+        uint32_t maxTime;
+        uint32_t maxCallTime;							// Longest time we spent in a single call to ActOnCode
+        uint64_t totalCalls;							// Number of calls to ActOnCode, i.e. iterations of GCodes::Spin
+        uint32_t maxCalls;
+    };
+
+    ProfileEntry *Find(char letter, int code);
+
+    Platform* platform;
+    ProfileEntry entries[COMMAND_PROFILE_ENTRIES];
+    ProfileEntry otherEntry;
+    size_t numEntries;
+};
+
+#endif /* COMMANDPROFILER_H_ */
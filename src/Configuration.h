@@ -121,6 +121,7 @@ const size_t MACHINE_NAME_LENGTH = 40;
 const size_t PASSWORD_LENGTH = 20;
 
 const size_t GCODE_LENGTH = 100;
+const size_t SERIAL_LINE_QUEUE_LENGTH = 1024;		// Receive queue for the windowed serial protocol, must hold several G-Codes
 const size_t GCODE_REPLY_LENGTH = 2048;
 const size_t MESSAGE_LENGTH = 256;
 
@@ -160,6 +161,7 @@ const float FILAMENT_WIDTH = 1.75;					// Millimetres
 #define GCODE_DIR "0:/gcodes/"						// Ditto - G-Codes
 #define SYS_DIR "0:/sys/";							// Ditto - System files
 #define MACRO_DIR "0:/macros/"						// Ditto - Macro files
+#define GCODE_INDEX_DIR "0:/sys/index"				// Ditto - Index files built when G-Code files are uploaded (no trailing '/')
 
 #define CONFIG_FILE "config.g"
 #define DEFAULT_FILE "default.g"
@@ -0,0 +1,303 @@
+/****************************************************************************************************
+
+RepRapFirmware - DirectoryCache
+
+This class keeps part of the sorted listing of the directory the LCD is showing in RAM. See DirectoryCache.h for details.
+
+-----------------------------------------------------------------------------------------------------
+
+Licence: GPL
+
+****************************************************************************************************/
+
+#include "RepRapFirmware.h"
+
+DirectoryCache::DirectoryCache(Platform *p) : platform(p)
+{
+	InvalidateAll();
+	hits = scans = 0;
+}
+
+// Hash a path without the volume prefix, ignoring case. We use FNV-1a like GCodeIndex does.
+/*static*/ uint32_t DirectoryCache::Hash(const char *path, size_t length)
+{
+	uint32_t hash = 2166136261u;
+	for (size_t i = 0; i < length; ++i)
+	{
+		hash = (hash ^ (uint8_t)toupper(path[i])) * 16777619u;
+	}
+	return hash;
+}
+
+/*static*/ uint32_t DirectoryCache::ParentHash(const char *location)
+{
+	location = MassStorage::SkipVolume(location);
+	const char * const lastSlash = strrchr(location, '/');
+	return Hash(location, (lastSlash == nullptr) ? 0 : lastSlash - location);
+}
+
+// Make a directory the cached one. If it wasn't already, read the start of its sorted listing.
+bool DirectoryCache::Select(const char *dir)
+{
+	// Remove the trailing '/' from the directory name
+	char loc[FILENAME_LENGTH];
+	size_t len = strnlen(dir, ARRAY_UPB(loc));
+	if (len != 0 && dir[len - 1] == '/')
+	{
+		--len;
+	}
+	memcpy(loc, dir, len);
+	loc[len] = 0;
+
+	if (valid && StringEquals(MassStorage::SkipVolume(directory), MassStorage::SkipVolume(loc)))
+	{
+		return true;
+	}
+
+	strcpy(directory, loc);
+	const char * const path = MassStorage::SkipVolume(directory);
+	directoryHash = Hash(path, strlen(path));
+	windowStart = 0;
+	return Scan(nullptr, false);
+}
+
+// Directories come before files, otherwise sort by name ignoring case
+/*static*/ bool DirectoryCache::Precedes(const DirectoryEntry& a, const DirectoryEntry& b)
+{
+	if (a.isDirectory != b.isDirectory)
+	{
+		return a.isDirectory;
+	}
+	return strcasecmp(a.name, b.name) < 0;
+}
+
+// Read the whole directory once, counting the entries and keeping the first ones in sorted order that come after 'bound',
+// or the last ones that come before it if 'before' is set. A null bound means from the start of the listing.
+bool DirectoryCache::Scan(const DirectoryEntry *bound, bool before)
+{
+	const uint32_t startTime = micros();
+	++scans;
+	valid = false;
+	numDirectories = numFiles = windowCount = 0;
+
+	DIR dir;
+	dir.lfn = nullptr;
+	if (f_opendir(&dir, directory) != FR_OK)
+	{
+		return false;
+	}
+
+	DirectoryEntry candidate;
+	FILINFO entry;
+	entry.lfname = candidate.name;
+	entry.lfsize = ARRAY_SIZE(candidate.name);
+
+	for (;;)
+	{
+		candidate.name[0] = 0;
+		if (f_readdir(&dir, &entry) != FR_OK)
+		{
+			return false;
+		}
+		if (entry.fname[0] == 0)
+		{
+			break;
+		}
+		if (StringEquals(entry.fname, ".") || StringEquals(entry.fname, ".."))
+		{
+			continue;
+		}
+
+		if (candidate.name[0] == 0)
+		{
+			strncpy(candidate.name, entry.fname, ARRAY_SIZE(candidate.name));
+		}
+		candidate.date = entry.fdate;
+		candidate.size = entry.fsize;
+		candidate.isDirectory = (entry.fattrib & AM_DIR);
+		if (candidate.isDirectory)
+		{
+			++numDirectories;
+		}
+		else
+		{
+			++numFiles;
+		}
+
+		uint8_t slot = windowCount;			// the next free entry until the window is full
+		if (before)
+		{
+			// Keep the entries nearest before the bound
+			if (!Precedes(candidate, *bound))
+			{
+				continue;
+			}
+			if (windowCount == DIRECTORY_CACHE_ENTRIES)
+			{
+				if (!Precedes(entries[order[0]], candidate))
+				{
+					continue;
+				}
+
+				// Drop the first entry and insert this one in its place
+				slot = order[0];
+				size_t pos = 0;
+				while (pos + 1 < windowCount && Precedes(entries[order[pos + 1]], candidate))
+				{
+					order[pos] = order[pos + 1];
+					++pos;
+				}
+				entries[slot] = candidate;
+				order[pos] = slot;
+				continue;
+			}
+		}
+		else
+		{
+			// Keep the entries nearest after the bound
+			if (bound != nullptr && !Precedes(*bound, candidate))
+			{
+				continue;
+			}
+			if (windowCount == DIRECTORY_CACHE_ENTRIES)
+			{
+				if (!Precedes(candidate, entries[order[windowCount - 1]]))
+				{
+					continue;
+				}
+				--windowCount;
+				slot = order[windowCount];		// drop the last entry
+			}
+		}
+
+		// Insertion sort, the FAT directory is usually roughly in creation order so this is as good as anything
+		size_t pos = windowCount;
+		while (pos != 0 && Precedes(candidate, entries[order[pos - 1]]))
+		{
+			order[pos] = order[pos - 1];
+			--pos;
+		}
+		entries[slot] = candidate;
+		order[pos] = slot;
+		++windowCount;
+	}
+
+	platform->GetIoStatistics()->Record(ioDirectory, startTime);
+	valid = true;
+	return true;
+}
+
+bool DirectoryCache::Count(const char *dir, size_t& numDirs, size_t& numFls)
+{
+	if (!Select(dir))
+	{
+		return false;
+	}
+	numDirs = numDirectories;
+	numFls = numFiles;
+	return true;
+}
+
+bool DirectoryCache::GetEntry(const char *dir, size_t index, FileInfo& info)
+{
+	if (!Select(dir) || index >= numDirectories + numFiles)
+	{
+		return false;
+	}
+
+	if (index >= windowStart && index < windowStart + windowCount)
+	{
+		++hits;
+	}
+	else
+	{
+		// Move the window so that the wanted entry is in the middle of it. We can only start or end the new window
+		// at an entry that we already have, so a long jump takes several scans.
+		do
+		{
+			DirectoryEntry bound;
+			if (windowCount == 0)
+			{
+				return false;							// the directory has changed since the last scan
+			}
+			if (index < windowStart)
+			{
+				const size_t windowEnd = min<size_t>(max<size_t>(index + DIRECTORY_CACHE_ENTRIES/2, windowStart), windowStart + windowCount - 1);
+				bound = entries[order[windowEnd - windowStart]];
+				if (!Scan(&bound, true) || windowCount > windowEnd)
+				{
+					return false;
+				}
+				windowStart = windowEnd - windowCount;
+			}
+			else
+			{
+				const size_t wantedStart = (index > DIRECTORY_CACHE_ENTRIES/2) ? index - DIRECTORY_CACHE_ENTRIES/2 : 0;
+				const size_t newStart = min<size_t>(max<size_t>(wantedStart, windowStart + 1), windowStart + windowCount);
+				bound = entries[order[newStart - 1 - windowStart]];
+				if (!Scan(&bound, false))
+				{
+					return false;
+				}
+				windowStart = newStart;
+			}
+		} while (index < windowStart || index >= windowStart + windowCount);
+	}
+
+	const DirectoryEntry& entry = entries[order[index - windowStart]];
+	info.isDirectory = entry.isDirectory;
+	info.size = entry.size;
+	uint16_t day = entry.date & 0x1F;
+	if (day == 0)
+	{
+		// This can happen if a transfer hasn't been processed completely.
+		day = 1;
+	}
+	info.day = day;
+	info.month = (entry.date & 0x01E0) >> 5;
+	info.year = (entry.date >> 9) + 1980;
+	strncpy(info.fileName, entry.name, ARRAY_SIZE(info.fileName));
+	info.fileName[ARRAY_UPB(info.fileName)] = 0;
+	return true;
+}
+
+// Discard the listing if a file or directory in it has been created, changed or deleted, or if it is in a directory that has been renamed or deleted
+void DirectoryCache::Invalidate(const char *location)
+{
+	InvalidateDirectory(ParentHash(location));
+
+	location = MassStorage::SkipVolume(location);
+	size_t locationLength = strlen(location);
+	if (locationLength != 0 && location[locationLength - 1] == '/')
+	{
+		--locationLength;
+	}
+	const char * const path = MassStorage::SkipVolume(directory);
+	if (valid && strncasecmp(path, location, locationLength) == 0 && (path[locationLength] == 0 || path[locationLength] == '/'))
+	{
+		valid = false;
+	}
+}
+
+void DirectoryCache::InvalidateDirectory(uint32_t hash)
+{
+	if (valid && hash == directoryHash)
+	{
+		valid = false;
+	}
+}
+
+// Discard everything, called when the SD card has been removed
+void DirectoryCache::InvalidateAll()
+{
+	valid = false;
+}
+
+void DirectoryCache::Diagnostics()
+{
+	platform->MessageF(GENERIC_MESSAGE, "Directory cache: entries %u to %u of %u in %s, %lu hits, %lu scans\n",
+						(valid) ? windowStart : 0, (valid) ? windowStart + windowCount : 0, (valid) ? numDirectories + numFiles : 0,
+						(valid) ? ((MassStorage::SkipVolume(directory)[0] == 0) ? "/" : directory) : "(none)", hits, scans);
+}
+
+// End
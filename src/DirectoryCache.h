@@ -0,0 +1,64 @@
+/****************************************************************************************************
+
+RepRapFirmware - DirectoryCache
+
+This class keeps a window of the sorted listing of one directory in RAM, so that the LCD file browser
+can fetch the entry shown in each row without walking the FAT directory from the start every time.
+Directories come first, then files, each sorted by name. The window covers the rows on display and
+some either side of them. When a row outside it is wanted, one pass over the directory fills a new
+window around that row, so scrolling through a folder of any size needs one scan per half window.
+The cached entries are discarded whenever a file in that directory is created, changed, renamed or deleted.
+
+-----------------------------------------------------------------------------------------------------
+
+Licence: GPL
+
+****************************************************************************************************/
+
+#ifndef DIRECTORYCACHE_H
+#define DIRECTORYCACHE_H
+
+const size_t DIRECTORY_CACHE_ENTRIES = 16;			// Number of sorted entries kept, must be more than the LCD rows and no more than 256
+
+class DirectoryCache
+{
+public:
+	DirectoryCache(Platform *p);
+	bool GetEntry(const char *dir, size_t index, FileInfo& info);	// Get the entry at this position of the sorted listing
+	bool Count(const char *dir, size_t& numDirectories, size_t& numFiles);
+	void Invalidate(const char *location);			// A file or directory has been created, changed or deleted
+	void InvalidateDirectory(uint32_t hash);		// A file in the directory with this hash has been changed
+	void InvalidateAll();
+	void Diagnostics();
+
+	static uint32_t ParentHash(const char *location);	// Get the hash of the directory that a file is in
+	static uint32_t Hash(const char *path, size_t length);	// Get the hash of a path without the volume prefix, ignoring case
+
+private:
+	struct DirectoryEntry
+	{
+		char name[FILENAME_LENGTH];
+		uint32_t size;
+		uint16_t date;								// FAT date
+		bool isDirectory;
+	};
+
+	bool Select(const char *dir);					// Make this the cached directory, scanning it if it wasn't already
+	bool Scan(const DirectoryEntry *bound, bool before);
+	static bool Precedes(const DirectoryEntry& a, const DirectoryEntry& b);
+
+	Platform *platform;
+	char directory[FILENAME_LENGTH];				// path of the cached directory without the trailing slash
+	uint32_t directoryHash;
+	bool valid;
+	size_t numDirectories, numFiles;				// total number of entries in the directory
+	size_t windowStart;								// position of the first cached entry in the sorted listing
+	size_t windowCount;								// number of cached entries
+	DirectoryEntry entries[DIRECTORY_CACHE_ENTRIES];
+	uint8_t order[DIRECTORY_CACHE_ENTRIES];			// indices of entries[] in sorted order
+	uint32_t hits, scans;
+};
+
+#endif
+
+// vim: ts=4:sw=4
@@ -7,18 +7,54 @@
 
 uint32_t FileStore::longestWriteTime = 0;
 
-FileStore::FileStore(Platform* p) : platform(p)
+FileStore *FileStore::readAheadOwner = nullptr;
+uint32_t FileStore::readAheadBuffers[2][FileReadAheadLen/4];
+size_t FileStore::currentReadAheadBuffer = 0;
+bool FileStore::readAheadValid = false;
+unsigned int FileStore::readAheadStart = 0;
+unsigned int FileStore::readAheadEnd = 0;
+
+FileStore *FileStore::writeBehindOwner = nullptr;
+size_t FileStore::writeBehindCount = 0;
+
+uint32_t FileStore::bytesRead = 0;
+uint32_t FileStore::readTime = 0;
+uint32_t FileStore::readAheads = 0;
+uint32_t FileStore::stalls = 0;
+uint32_t FileStore::stallTime = 0;
+uint32_t FileStore::longestStall = 0;
+
+FileStore::FileStore(Platform* p) : platform(p), cacheEntry(-1)
 {
 }
 
+// This is also called for every file when the SD card has been removed, so we mustn't leave the shared buffers to a file that has gone
 void FileStore::Init()
 {
+	if (IsReadingAhead())
+	{
+		readAheadOwner = nullptr;
+		readAheadValid = false;
+	}
+	if (IsWritingBehind())
+	{
+		writeBehindOwner = nullptr;						// the data belongs to a file on the old card, so don't flush it
+		writeBehindCount = 0;
+	}
+	if (IsCached())
+	{
+		platform->GetMacroCache()->Release(cacheEntry);
+	}
+
 	bufferPointer = 0;
 	inUse = false;
 	writing = false;
+	preallocated = false;
 	lastBufferEntry = 0;
 	openCount = 0;
 	closeRequested = false;
+	cacheEntry = -1;
+	cachedData = nullptr;
 }
 
 // Open a local file (for example on an SD card).
@@ -39,9 +75,12 @@ bool FileStore::Open(const char* directory, const char* fileName, bool write)
 	}
 
 	writing = write;
+	preallocated = false;
 	lastBufferEntry = FileBufLen;
 
+	const uint32_t startTime = micros();
 	FRESULT openReturn = f_open(&file, location, (writing) ?  FA_CREATE_ALWAYS | FA_WRITE : FA_OPEN_EXISTING | FA_READ);
+	platform->GetIoStatistics()->Record(ioOpen, startTime);
 	if (openReturn != FR_OK)
 	{
 		// We no longer report an error if opening a file in read mode fails unless debugging is enabled, because sometimes that is quite normal.
@@ -53,12 +92,33 @@ bool FileStore::Open(const char* directory, const char* fileName, bool write)
 		return false;
 	}
 
+	if (writing)
+	{
+		platform->GetMassStorage()->FileChanged(location);
+		directoryHash = DirectoryCache::ParentHash(location);
+		const char * const path = MassStorage::SkipVolume(location);
+		fileHash = DirectoryCache::Hash(path, strlen(path));
+	}
+
 	bufferPointer = (writing) ? 0 : FileBufLen;
 	inUse = true;
 	openCount = 1;
 	return true;
 }
 
+// Open a file that is held by the macro cache. The entry has been locked for us and we unlock it when the file is closed.
+// This is protected - only Platform can access it.
+void FileStore::OpenCached(int entry, const char *data, size_t length)
+{
+	cacheEntry = entry;
+	cachedData = data;
+	writing = false;
+	bufferPointer = 0;
+	lastBufferEntry = length;
+	inUse = true;
+	openCount = 1;
+}
+
 void FileStore::Duplicate()
 {
 	if (!inUse)
@@ -110,6 +170,16 @@ bool FileStore::Close()
 		return true;
 	}
 
+	if (IsCached())
+	{
+		platform->GetMacroCache()->Release(cacheEntry);
+		cacheEntry = -1;
+		inUse = false;
+		lastBufferEntry = 0;
+		closeRequested = false;
+		return true;
+	}
+
 	bool ok = true;
 	if (writing)
 	{
@@ -117,6 +187,19 @@ bool FileStore::Close()
 	}
 
 	FRESULT fr = f_close(&file);
+	if (writing)
+	{
+		platform->GetMassStorage()->GetDirectoryCache()->InvalidateDirectory(directoryHash);	// the size of the file is now different
+		platform->GetMacroCache()->InvalidateFile(fileHash);	// a macro run while the file was being written may have cached part of it
+	}
+	if (IsReadingAhead())
+	{
+		readAheadOwner = nullptr;
+	}
+	if (IsWritingBehind())
+	{
+		writeBehindOwner = nullptr;
+	}
 	inUse = false;
 	writing = false;
 	lastBufferEntry = 0;
@@ -131,12 +214,29 @@ bool FileStore::Seek(FilePosition pos)
 		platform->Message(GENERIC_MESSAGE, "Attempt to seek on a non-open file.\n");
 		return false;
 	}
+	if (IsCached())
+	{
+		bufferPointer = min<unsigned int>(pos, lastBufferEntry);
+		return pos <= lastBufferEntry;
+	}
 	if (writing)
 	{
 		WriteBuffer();
+		FlushWriteBehind();
 	}
 	FRESULT fr = f_lseek(&file, pos);
-	bufferPointer = (writing) ? 0 : FileBufLen;
+	if (writing)
+	{
+		bufferPointer = 0;
+	}
+	else
+	{
+		bufferPointer = lastBufferEntry = BufferLength();
+		if (IsReadingAhead())
+		{
+			readAheadValid = false;
+		}
+	}
 	return fr == FR_OK;
 }
 
@@ -149,14 +249,26 @@ FilePosition FileStore::Position() const
 		return (FilePosition)0;
 	}
 
+	if (IsCached())
+	{
+		return bufferPointer;
+	}
+
 	FilePosition pos = file.fptr;
 	if (writing)
 	{
 		pos += bufferPointer;
 	}
-	else if (bufferPointer < lastBufferEntry)
+	else
 	{
-		pos -= (lastBufferEntry - bufferPointer);
+		if (bufferPointer < lastBufferEntry)
+		{
+			pos -= (lastBufferEntry - bufferPointer);
+		}
+		if (IsReadingAhead() && readAheadValid)
+		{
+			pos -= (readAheadEnd - readAheadStart);
+		}
 	}
 	return pos;
 }
@@ -175,7 +287,7 @@ FilePosition FileStore::Length() const
 		platform->Message(GENERIC_MESSAGE, "Attempt to size non-open file.\n");
 		return 0;
 	}
-	return file.fsize;
+	return (IsCached()) ? lastBufferEntry : file.fsize;
 }
 
 float FileStore::FractionRead() const
@@ -194,7 +306,7 @@ uint8_t FileStore::Status()
 	if (!inUse)
 		return (uint8_t)IOStatus::nothing;
 
-	if (lastBufferEntry == FileBufLen)
+	if (lastBufferEntry == BufferLength() && !IsCached())
 		return (uint8_t)IOStatus::byteAvailable;
 
 	if (bufferPointer < lastBufferEntry)
@@ -203,18 +315,108 @@ uint8_t FileStore::Status()
 	return (uint8_t)IOStatus::nothing;
 }
 
+// Refill the read buffer. If we are using the read-ahead buffers and the spare one has been filled already, we just swap them.
 bool FileStore::ReadBuffer()
 {
-	FRESULT readStatus = f_read(&file, GetBuffer(), FileBufLen, &lastBufferEntry);	// Read a chunk of file
+	unsigned int start, end;
+	if (IsReadingAhead())
+	{
+		if (readAheadValid)
+		{
+			currentReadAheadBuffer ^= 1;
+			readAheadValid = false;
+			bufferPointer = readAheadStart;
+			lastBufferEntry = readAheadEnd;
+			return true;
+		}
+
+		// The reader has to wait for the SD card
+		const uint32_t startTime = micros();
+		if (!ReadBlock(GetBuffer(), start, end))
+		{
+			return false;
+		}
+		const uint32_t time = micros() - startTime;
+		++stalls;
+		stallTime += time;
+		longestStall = max<uint32_t>(longestStall, time);
+	}
+	else if (!ReadBlock(GetBuffer(), start, end))
+	{
+		return false;
+	}
+
+	bufferPointer = start;
+	lastBufferEntry = end;
+	return true;
+}
+
+// Read the next chunk of the file into a buffer, returning the indices of the data in it.
+// Data in the read-ahead buffers is placed so that each read ends on a sector boundary. After a seek to the middle of a sector,
+// this lets FatFs transfer whole sectors straight into our buffer, several at a time if they are in the same cluster.
+bool FileStore::ReadBlock(uint8_t *buffer, unsigned int& start, unsigned int& end)
+{
+	const unsigned int offset = (IsReadingAhead()) ? file.fptr % FileSectorSize : 0;
+	UINT bytesReturned;
+	const uint32_t startTime = micros();
+	FRESULT readStatus = f_read(&file, buffer + offset, BufferLength() - offset, &bytesReturned);
+	readTime += micros() - startTime;
+	platform->GetIoStatistics()->Record(ioRead, startTime, bytesReturned);
 	if (readStatus != FR_OK)
 	{
 		platform->Message(GENERIC_MESSAGE, "Error reading file.\n");
 		return false;
 	}
-	bufferPointer = 0;
+
+	bytesRead += bytesReturned;
+	start = offset;
+	end = offset + bytesReturned;
 	return true;
 }
 
+// Let this file use the read-ahead buffers. Only one file can have them, normally the one being printed.
+// If an upload is using their memory as its write-behind buffer, we write out what it has collected and take them over.
+// The upload carries on writing straight to the file.
+bool FileStore::EnableReadAhead()
+{
+	if (!inUse || writing || IsCached() || (readAheadOwner != nullptr && !IsReadingAhead()))
+	{
+		return false;
+	}
+
+	if (!IsReadingAhead())
+	{
+		if (writeBehindOwner != nullptr)
+		{
+			if (!writeBehindOwner->FlushWriteBehind())
+			{
+				return false;
+			}
+			writeBehindOwner = nullptr;
+		}
+
+		// Discard the data in the normal buffer, we will read it again into the read-ahead buffer
+		const FilePosition pos = Position();
+		readAheadOwner = this;
+		return Seek(pos);
+	}
+	return true;
+}
+
+// Fill the spare read-ahead buffer while the reader is still busy with the current one, so that it needn't wait for the SD card when it gets to the end.
+// This is called when the reader of the file is waiting for something else anyway.
+void FileStore::ReadAhead()
+{
+	if (IsReadingAhead() && !readAheadValid && lastBufferEntry == FileReadAheadLen && file.fptr < file.fsize)
+	{
+		if (ReadBlock(reinterpret_cast<uint8_t*>(readAheadBuffers[currentReadAheadBuffer ^ 1]), readAheadStart, readAheadEnd))
+		{
+			readAheadValid = true;
+			++readAheads;
+		}
+	}
+}
+
 // Single character read via the buffer
 bool FileStore::Read(char& b)
 {
@@ -224,7 +426,7 @@ bool FileStore::Read(char& b)
 		return false;
 	}
 
-	if (bufferPointer >= FileBufLen)
+	if (bufferPointer >= BufferLength() && !IsCached())
 	{
 		bool ok = ReadBuffer();
 		if (!ok)
@@ -239,12 +441,48 @@ bool FileStore::Read(char& b)
 		return false;
 	}
 
-	b = (char) GetBuffer()[bufferPointer];
+	b = (IsCached()) ? cachedData[bufferPointer] : (char) GetBuffer()[bufferPointer];
 	bufferPointer++;
 
 	return true;
 }
 
+// Return a pointer to the data that has been read into the buffer but not consumed yet, refilling the buffer first if it is empty.
+// This allows callers to scan whole buffers instead of reading the file one byte at a time.
+// Returns false if no more data is available.
+bool FileStore::GetBufferedData(const char*& data, size_t& len)
+{
+	if (!inUse)
+	{
+		platform->Message(GENERIC_MESSAGE, "Attempt to read from a non-open file.\n");
+		return false;
+	}
+
+	if (bufferPointer >= BufferLength() && !IsCached())
+	{
+		bool ok = ReadBuffer();
+		if (!ok)
+		{
+			return false;
+		}
+	}
+
+	if (bufferPointer >= lastBufferEntry)
+	{
+		return false;
+	}
+
+	data = ((IsCached()) ? cachedData : reinterpret_cast<const char*>(GetBuffer())) + bufferPointer;
+	len = lastBufferEntry - bufferPointer;
+	return true;
+}
+
+// Mark some of the data returned by GetBufferedData as consumed
+void FileStore::SkipBufferedData(size_t len)
+{
+	bufferPointer = min<unsigned int>(bufferPointer + len, lastBufferEntry);
+}
+
 // Block read, doesn't use the buffer
 int FileStore::Read(char* extBuf, size_t nBytes)
 {
@@ -254,9 +492,23 @@ int FileStore::Read(char* extBuf, size_t nBytes)
 		return -1;
 	}
 
-	bufferPointer = FileBufLen;			// invalidate the buffer
+	if (IsCached())
+	{
+		const size_t bytesRead = min<size_t>(nBytes, lastBufferEntry - bufferPointer);
+		memcpy(extBuf, cachedData + bufferPointer, bytesRead);
+		bufferPointer += bytesRead;
+		return (int)bytesRead;
+	}
+
+	bufferPointer = BufferLength();		// invalidate the buffer
+	if (IsReadingAhead())
+	{
+		readAheadValid = false;
+	}
 	UINT bytes_read;
+	const uint32_t startTime = micros();
 	FRESULT readStatus = f_read(&file, extBuf, nBytes, &bytes_read);
+	platform->GetIoStatistics()->Record(ioRead, startTime, bytes_read);
 	if (readStatus != FR_OK)
 	{
 		platform->Message(GENERIC_MESSAGE, "Error reading file.\n");
@@ -269,7 +521,7 @@ bool FileStore::WriteBuffer()
 {
 	if (bufferPointer != 0)
 	{
-		bool ok = InternalWriteBlock((const char*)GetBuffer(), bufferPointer);
+		bool ok = WriteBlock((const char*)GetBuffer(), bufferPointer);
 		if (!ok)
 		{
 			platform->Message(GENERIC_MESSAGE, "Cannot write to file. Disc may be full.\n");
@@ -327,7 +579,57 @@ bool FileStore::Write(const char *s, size_t len)
 	{
 		return false;
 	}
-	return InternalWriteBlock(s, len);
+	return WriteBlock(s, len);
+}
+
+// Write a block of data, going through the write-behind buffer if we own it.
+// The buffer is only written out when it is full, so unless the file has been seeked to an odd position all the writes start and end on sector boundaries.
+bool FileStore::WriteBlock(const char *s, size_t len)
+{
+	if (!IsWritingBehind())
+	{
+		return InternalWriteBlock(s, len);
+	}
+
+	uint8_t * const buffer = WriteBehindBuffer();
+	while (len != 0)
+	{
+		if (writeBehindCount == 0 && len >= FileWriteBehindLen)
+		{
+			// There is at least a whole buffer full, so write as many whole sectors as we can directly
+			const size_t wholeSectors = len & ~(FileSectorSize - 1);
+			if (!InternalWriteBlock(s, wholeSectors))
+			{
+				return false;
+			}
+			s += wholeSectors;
+			len -= wholeSectors;
+		}
+		else
+		{
+			const size_t toCopy = min<size_t>(len, FileWriteBehindLen - writeBehindCount);
+			memcpy(buffer + writeBehindCount, s, toCopy);
+			writeBehindCount += toCopy;
+			s += toCopy;
+			len -= toCopy;
+			if (writeBehindCount == FileWriteBehindLen && !FlushWriteBehind())
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+bool FileStore::FlushWriteBehind()
+{
+	if (IsWritingBehind() && writeBehindCount != 0)
+	{
+		const size_t count = writeBehindCount;
+		writeBehindCount = 0;
+		return InternalWriteBlock(reinterpret_cast<const char*>(WriteBehindBuffer()), count);
+	}
+	return true;
 }
 
 // Debugging variables
@@ -341,6 +643,7 @@ bool FileStore::InternalWriteBlock(const char *s, size_t len)
 //	numRead = numWrite = 0;
 
 	FRESULT writeStatus = f_write(&file, s, len, &bytesWritten);
+	platform->GetIoStatistics()->Record(ioWrite, time, bytesWritten);
 	time = micros() - time;
 	if (time > longestWriteTime)
 	{
@@ -362,11 +665,66 @@ bool FileStore::Flush()
 		platform->Message(GENERIC_MESSAGE, "Attempt to flush a non-open file.\n");
 		return false;
 	}
-	if (!WriteBuffer())
+	if (!WriteBuffer() || !FlushWriteBehind())
 	{
 		return false;
 	}
-	return f_sync(&file) == FR_OK;
+	if (preallocated)
+	{
+		// Give back the clusters we allocated but didn't use
+		preallocated = false;
+		if (file.fptr < file.fsize && f_truncate(&file) != FR_OK)
+		{
+			return false;
+		}
+	}
+	const uint32_t startTime = micros();
+	const FRESULT fr = f_sync(&file);
+	platform->GetIoStatistics()->Record(ioSync, startTime);
+	return fr == FR_OK;
+}
+
+bool FileStore::EnableWriteBehind()
+{
+	if (!inUse || !writing || (writeBehindOwner != nullptr && !IsWritingBehind()) || readAheadOwner != nullptr)
+	{
+		return false;
+	}
+
+	if (!IsWritingBehind())
+	{
+		writeBehindOwner = this;
+		writeBehindCount = 0;
+	}
+	return true;
+}
+
+// Extend a new empty file to the given length and go back to the start, so that FatFs allocates the whole cluster chain now
+// instead of one cluster at a time while the data is being written. The clusters are usually contiguous because FatFs
+// allocates them from where it last left off. Flush or Close truncates the file to the data actually written.
+bool FileStore::Preallocate(FilePosition length)
+{
+	if (!inUse || !writing || file.fsize != 0 || length == 0)
+	{
+		return false;
+	}
+
+	preallocated = true;
+	const bool ok = (f_lseek(&file, length) == FR_OK && file.fptr == length);
+	if (f_lseek(&file, 0) != FR_OK || (!ok && f_truncate(&file) != FR_OK))
+	{
+		platform->Message(GENERIC_MESSAGE, "Cannot write to file. Disc may be full.\n");
+		return false;
+	}
+	if (!ok)
+	{
+		preallocated = false;
+		if (reprap.Debug(modulePlatform))
+		{
+			platform->MessageF(GENERIC_MESSAGE, "Can't preallocate %u bytes\n", length);
+		}
+	}
+	return ok;
 }
 
 float FileStore::GetAndClearLongestWriteTime()
@@ -376,4 +734,12 @@ float FileStore::GetAndClearLongestWriteTime()
 	return ret;
 }
 
+void FileStore::ReadDiagnostics()
+{
+	reprap.GetPlatform()->MessageF(GENERIC_MESSAGE, "File reads: %lu bytes in %.1fms (%.1fKB/s), %lu read ahead, %lu stalls totalling %.1fms (longest %.1fms)\n",
+									bytesRead, (float)readTime/1000.0, (readTime == 0) ? 0.0 : (float)bytesRead * (1000000.0/1024.0) / (float)readTime,
+									readAheads, stalls, (float)stallTime/1000.0, (float)longestStall/1000.0);
+	bytesRead = readTime = readAheads = stalls = stallTime = longestStall = 0;
+}
+
 // End
@@ -5,7 +5,12 @@
 
 typedef uint32_t FilePosition;
 const FilePosition noFilePosition = 0xFFFFFFFF;
-const size_t FileBufLen = 256;						// 512 would be more efficient, but need to free up some RAM first
+// Each of the MAX_FILES files has a buffer of FileBufLen bytes. The file being printed reads through the read-ahead buffers
+// instead, so a bigger buffer would cost MAX_FILES times the extra RAM for files that are small or rarely read.
+const size_t FileBufLen = 256;
+const size_t FileSectorSize = 512;
+const size_t FileReadAheadLen = 1024;				// Size of each of the two read-ahead buffers of the file being printed, must be a multiple of FileSectorSize
+const size_t FileWriteBehindLen = 2 * FileReadAheadLen;	// Size of the write-behind buffer of the file being uploaded, it shares the memory of the read-ahead buffers
 
 enum class IOStatus : uint8_t
 {
@@ -23,6 +28,8 @@ public:
 	uint8_t Status();								// Returns OR of IOStatus
 	bool Read(char& b);								// Read 1 byte
 	int Read(char* buf, size_t nBytes);				// Read a block of nBytes length
+	bool GetBufferedData(const char*& data, size_t& len);	// Get the data remaining in the read buffer, refilling it if necessary
+	void SkipBufferedData(size_t len);				// Consume len bytes returned by GetBufferedData
 	bool Write(char b);								// Write 1 byte
 	bool Write(const char *s, size_t len);			// Write a block of len bytes
 	bool Write(const char* s);						// Write a string
@@ -36,7 +43,12 @@ public:
 	float FractionRead() const;						// How far in we are
 	void Duplicate();								// Create a second reference to this file
 	bool Flush();									// Write remaining buffer data
+	bool EnableReadAhead();							// Use the double read-ahead buffer for this file, if no other file is using it
+	void ReadAhead();								// Fill the spare read-ahead buffer if it is empty
+	bool EnableWriteBehind();						// Collect block writes to this file in the write-behind buffer, if no other file is using it and no file is reading ahead
+	bool Preallocate(FilePosition length);			// Allocate the clusters for a new file of known length before writing it
 	static float GetAndClearLongestWriteTime();		// Return the longest time it took to write a block to a file, in milliseconds
+	static void ReadDiagnostics();					// Report and clear the read statistics
 
 	friend class Platform;
 
@@ -45,12 +57,20 @@ protected:
 	FileStore(Platform* p);
 	void Init();
     bool Open(const char* directory, const char* fileName, bool write);
+    void OpenCached(int entry, const char *data, size_t length);	// Read a file held by the macro cache
 
 private:
 	bool ReadBuffer();
+	bool ReadBlock(uint8_t *buffer, unsigned int& start, unsigned int& end);
 	bool WriteBuffer();
+	bool WriteBlock(const char *s, size_t len);
 	bool InternalWriteBlock(const char *s, size_t len);
-	uint8_t *GetBuffer() { return reinterpret_cast<uint8_t*>(buf32); }
+	bool FlushWriteBehind();
+	uint8_t *GetBuffer() { return (IsReadingAhead()) ? reinterpret_cast<uint8_t*>(readAheadBuffers[currentReadAheadBuffer]) : reinterpret_cast<uint8_t*>(buf32); }
+	size_t BufferLength() const { return (IsReadingAhead()) ? FileReadAheadLen : FileBufLen; }
+	bool IsCached() const { return cacheEntry >= 0; }
+	bool IsReadingAhead() const { return readAheadOwner == this; }
+	bool IsWritingBehind() const { return writeBehindOwner == this; }
 
     uint32_t buf32[FileBufLen/4];
 	Platform* platform;
@@ -63,8 +83,30 @@ private:
 
 	bool inUse;
 	bool writing;
+	uint32_t directoryHash;							// identifies the directory of a file being written, so we can update the directory cache when it is closed
+	uint32_t fileHash;								// identifies a file being written, so we can discard the macro cache's copy of it when it is closed
+	bool preallocated;								// true if the file may be longer than the data written, so it must be truncated when closed
+
+	int cacheEntry;									// Macro cache entry we are reading, or -1 if we are using the SD card
+	const char *cachedData;							// Contents of that entry. For cached files bufferPointer and lastBufferEntry index this.
 
 	static uint32_t longestWriteTime;
+
+	// The read-ahead buffers. The reader consumes one of them while the other one is filled when there is time to spare.
+	static FileStore *readAheadOwner;
+	static uint32_t readAheadBuffers[2][FileReadAheadLen/4];
+	static size_t currentReadAheadBuffer;
+	static bool readAheadValid;						// true if the spare buffer has been filled
+	static unsigned int readAheadStart, readAheadEnd;	// the data in the spare buffer
+
+	// The write-behind buffer. Block writes are collected here and written to the SD card in whole sectors.
+	// It is the memory of the read-ahead buffers, which only the file being printed uses, so an upload gets it unless a print is running.
+	static FileStore *writeBehindOwner;
+	static size_t writeBehindCount;
+	static uint8_t *WriteBehindBuffer() { return reinterpret_cast<uint8_t*>(readAheadBuffers); }
+
+	// Read statistics for M122
+	static uint32_t bytesRead, readTime, readAheads, stalls, stallTime, longestStall;
 };
 
 #endif
@@ -15,6 +15,7 @@ GCodeBuffer::GCodeBuffer(Platform* p, const char* id)
 	: platform(p), identity(id), checksumRequired(false), writingFileDirectory(nullptr), toolNumberAdjust(0)
 {
 	Init();
+	ResetModes();
 }
 
 void GCodeBuffer::Init()
@@ -23,6 +24,7 @@ void GCodeBuffer::Init()
 	readPointer = -1;
 	inComment = false;
 	state = GCodeState::idle;
+	executionCalls = 0;
 }
 
 int GCodeBuffer::CheckSum() const
@@ -137,6 +139,31 @@ bool GCodeBuffer::Put(const char *str, size_t len)
 	return false;
 }
 
+// Add a block of characters read from a file. The block may contain at most one newline, which must be the last character.
+// Once we are in a comment we skip straight to the end of the block instead of processing the comment character by character.
+bool GCodeBuffer::PutBlock(const char *str, size_t len)
+{
+	while (len != 0)
+	{
+		if (inComment && writingFileDirectory == nullptr)
+		{
+			if (str[len - 1] != '\n')
+			{
+				return false;			// the rest of this block is comment
+			}
+			str += len - 1;				// skip to the newline
+			len = 1;
+		}
+
+		if (Put(*str++))
+		{
+			return true;
+		}
+		--len;
+	}
+	return false;
+}
+
 // Does this buffer contain any code?
 
 bool GCodeBuffer::IsEmpty() const
@@ -356,11 +383,156 @@ bool GCodeBuffer::IsPollRequest()
 	return false;
 }
 
-// Return true if the specified M code can be executed concurrently with other requests.
-// These should be codes that do not modify the state (we make an exception for M111) and are always executed in a single call to function HandleMCode.
+namespace
+{
+	struct MCodeProperties
+	{
+		uint16_t code;
+		uint8_t flags;
+	};
+
+	// The M-codes that need special treatment, sorted by code number. Codes that aren't listed here have no flags set.
+	// Poll and concurrent codes must always be executed in a single call to GCodes::HandleMcode.
+	// Poll codes should not modify the state (we make an exception for M111).
+	constexpr MCodeProperties mcodeTable[] =
+	{
+		{ 0,	mcodeNeedsIdle },								// stop
+		{ 1,	mcodeNeedsIdle },								// sleep
+		{ 18,	mcodeNeedsIdle },								// motors off
+		{ 20,	mcodeSimulated },								// list files
+		{ 21,	mcodeSimulated },								// initialise SD card
+		{ 23,	mcodeSimulated },								// select file
+		{ 24,	mcodeNeedsIdle | mcodeSimulated },				// start or resume print
+		{ 25,	mcodeSimulated },								// pause print
+		{ 26,	mcodeSimulated },								// set SD position
+		{ 27,	mcodePoll | mcodeSimulated },					// report print status
+		{ 28,	mcodeSimulated },								// write to file
+		{ 29,	mcodeSimulated },								// end of file being written
+		{ 30,	mcodeSimulated },								// delete file
+		{ 32,	mcodeSimulated },								// select file and start print
+		{ 36,	mcodeSimulated },								// file information
+		{ 37,	mcodeSimulated },								// simulation mode
+		{ 81,	mcodeNeedsIdle },								// ATX power off
+		{ 82,	mcodeSimulated },								// absolute extrusion
+		{ 83,	mcodeSimulated },								// relative extrusion
+		{ 84,	mcodeNeedsIdle },								// motors off
+		{ 92,	mcodeNeedsIdle },								// steps/mm
+		{ 98,	mcodeNeedsIdle },								// call macro
+		{ 99,	mcodeNeedsIdle },								// return from macro
+		{ 104,	mcodeConcurrent },								// tool temperatures
+		{ 105,	mcodePoll | mcodeSimulated },					// temperatures and status
+		{ 106,	mcodeConcurrent },								// fan on
+		{ 107,	mcodeConcurrent },								// fan off
+		{ 109,	mcodeNeedsIdle },								// set temperature and wait
+		{ 111,	mcodePoll | mcodeSimulated },					// debug level
+		{ 114,	mcodePoll },									// report position
+		{ 116,	mcodeNeedsIdle },								// wait for temperatures
+		{ 117,	mcodeConcurrent },								// display message
+		{ 119,	mcodePoll },									// report endstops
+		{ 120,	mcodeNeedsIdle },								// push
+		{ 121,	mcodeNeedsIdle },								// pop
+		{ 122,	mcodePoll | mcodeSimulated },					// diagnostics
+		{ 140,	mcodeConcurrent },								// bed temperature
+		{ 190,	mcodeNeedsIdle },								// set bed temperature and wait
+		{ 220,	mcodeConcurrent },								// speed factor
+		{ 221,	mcodeConcurrent },								// extrusion factor
+		{ 226,	mcodeNeedsIdle },								// G-code initiated pause
+		{ 350,	mcodeNeedsIdle },								// microstepping
+		{ 400,	mcodeNeedsIdle },								// wait for moves to finish
+		{ 408,	mcodePoll },									// JSON status
+		{ 573,	mcodePoll },									// heater PWM
+		{ 578,	mcodeNeedsIdle },								// fire inkjet bits
+		{ 665,	mcodeNeedsIdle },								// delta configuration
+		{ 666,	mcodeNeedsIdle },								// delta endstop adjustments
+		{ 667,	mcodeNeedsIdle },								// CoreXY mode
+		{ 906,	mcodeNeedsIdle },								// motor currents
+		{ 999,	mcodeSimulated }								// reset
+	};
+
+	constexpr bool IsSorted(const MCodeProperties *table, size_t length)
+	{
+		return length < 2 || (table[0].code < table[1].code && IsSorted(table + 1, length - 1));
+	}
+
+	static_assert(IsSorted(mcodeTable, ARRAY_SIZE(mcodeTable)), "M-code table must be sorted by code number");
+}
+
+/*static*/ uint8_t GCodeBuffer::GetMCodeFlags(int code)
+{
+	size_t low = 0, high = ARRAY_SIZE(mcodeTable);
+	while (low < high)
+	{
+		const size_t mid = (low + high)/2;
+		if (mcodeTable[mid].code < code)
+		{
+			low = mid + 1;
+		}
+		else
+		{
+			high = mid;
+		}
+	}
+	return (low < ARRAY_SIZE(mcodeTable) && mcodeTable[low].code == code) ? mcodeTable[low].flags : 0;
+}
+
+// Return true if the specified M code can be executed while another source is running a macro
 /*static*/ bool GCodeBuffer::IsPollCode(int code)
 {
-	return code == 27 || code == 105 || code == 111 || code == 114 || code == 119 || code == 122 || code == 408 || code == 573;
+	return (GetMCodeFlags(code) & mcodePoll) != 0;
+}
+
+// Is this a complete code that we can execute while another source is running a macro or waiting for something?
+bool GCodeBuffer::IsConcurrentRequest()
+{
+	return state == GCodeState::executing && !IsEmpty() && Seen('M') && IsConcurrentCode(GetIValue());
+}
+
+// Return true if the specified M code doesn't need the move system or the GCodes state machine, so it can be executed out of turn
+/*static*/ bool GCodeBuffer::IsConcurrentCode(int code)
+{
+	return (GetMCodeFlags(code) & (mcodePoll | mcodeConcurrent)) != 0;
+}
+
+void GCodeBuffer::ResetRawExtruderPositions()
+{
+	for (size_t extruder = 0; extruder < DRIVES - AXES; extruder++)
+	{
+		lastRawExtruderPosition[extruder] = 0.0;
+	}
+}
+
+void GCodeBuffer::ResetModes()
+{
+	axesRelative = false;
+	drivesRelative = true;
+	ResetRawExtruderPositions();
+}
+
+void GCodeBuffer::CopyModesFrom(const GCodeBuffer *other)
+{
+	axesRelative = other->axesRelative;
+	drivesRelative = other->drivesRelative;
+	CopyRawExtruderPositionsFrom(other);
+}
+
+void GCodeBuffer::CopyRawExtruderPositionsFrom(const GCodeBuffer *other)
+{
+	for (size_t extruder = 0; extruder < DRIVES - AXES; extruder++)
+	{
+		lastRawExtruderPosition[extruder] = other->lastRawExtruderPosition[extruder];
+	}
+}
+
+// Called after each attempt to execute the current code. Codes that have to wait for something are attempted once per call to GCodes::Spin.
+void GCodeBuffer::NoteExecutionCall(uint32_t startTime, uint32_t callTime)
+{
+	if (executionCalls == 0)
+	{
+		executionStartTime = startTime;
+		executionMaxCallTime = 0;
+	}
+	++executionCalls;
+	executionMaxCallTime = max<uint32_t>(executionMaxCallTime, callTime);
 }
 
 // End
@@ -8,6 +8,15 @@
 #ifndef GCODEBUFFER_H_
 #define GCODEBUFFER_H_
 
+// Properties of the M-codes that we need to know before executing them, see the table in GCodeBuffer.cpp
+enum MCodeFlags : uint8_t
+{
+	mcodeNeedsIdle = 1,									// wait until all moves have finished before executing it
+	mcodeSimulated = 2,									// execute it in simulation mode
+	mcodePoll = 4,										// status request that can be executed while another source is running a macro
+	mcodeConcurrent = 8									// doesn't need the move system or the state machine, so it can be executed out of turn
+};
+
 // Small class to hold an individual GCode and provide functions to allow it to be parsed
 class GCodeBuffer
 {
@@ -16,6 +25,7 @@ class GCodeBuffer
     void Init(); 										// Set it up
     bool Put(char c);									// Add a character to the end
     bool Put(const char *str, size_t len);				// Add an entire string
+    bool PutBlock(const char *str, size_t len);			// Add a block of characters that ends at or before the next newline
     bool IsEmpty() const;								// Does this buffer contain any code?
     bool Seen(char c);									// Is a character present?
     float GetFValue();									// Get a float after a key letter
@@ -37,8 +47,25 @@ class GCodeBuffer
     void SetCommsProperties(uint32_t arg) { checksumRequired = (arg & 1); }
     bool StartingNewCode() const { return gcodePointer == 0; }
     bool IsPollRequest();
+    bool IsConcurrentRequest();							// Can this code be executed while another source is busy?
+    bool AxesRelative() const { return axesRelative; }
+    void SetAxesRelative(bool b) { axesRelative = b; }
+    bool DrivesRelative() const { return drivesRelative; }
+    void SetDrivesRelative(bool b) { drivesRelative = b; }
+    float GetRawExtruderPosition(size_t extruder) const { return lastRawExtruderPosition[extruder]; }
+    void SetRawExtruderPosition(size_t extruder, float pos) { lastRawExtruderPosition[extruder] = pos; }
+    void ResetRawExtruderPositions();
+    void ResetModes();									// Back to absolute axis and relative extruder positioning, extruders at zero
+    void CopyModesFrom(const GCodeBuffer *other);		// Take on the modes and extruder positions of another source
+    void CopyRawExtruderPositionsFrom(const GCodeBuffer *other);
+    void NoteExecutionCall(uint32_t startTime, uint32_t callTime);	// Keep track of how long the current code is taking
+    uint32_t ExecutionStartTime() const { return executionStartTime; }
+    uint32_t ExecutionCalls() const { return executionCalls; }
+    uint32_t ExecutionMaxCallTime() const { return executionMaxCallTime; }
 
     static bool IsPollCode(int code);
+    static bool IsConcurrentCode(int code);
+    static uint8_t GetMCodeFlags(int code);				// Look up the properties of an M-code
 
   private:
 
@@ -54,6 +81,12 @@ class GCodeBuffer
     GCodeState state;									// Idle, executing or paused
     const char* writingFileDirectory;					// If the G Code is going into a file, where that is
     int toolNumberAdjust;								// The adjustment to tool numbers in commands we receive
+    bool axesRelative;									// Modal state of this source: G90/G91...
+    bool drivesRelative;								// ...and M82/M83
+    float lastRawExtruderPosition[DRIVES - AXES];		// Extruder positions that absolute E values from this source are relative to
+    uint32_t executionStartTime;						// When we first tried to execute the current code
+    uint32_t executionCalls;							// How many times we have tried to execute it
+    uint32_t executionMaxCallTime;						// Longest time a single attempt took
 };
 
 // Get an Int after a G Code letter
@@ -0,0 +1,647 @@
+/****************************************************************************************************
+
+RepRapFirmware - GCodeIndex
+
+This class tokenises G-Code files while they are being uploaded or printed and writes a small sidecar
+index for each of them. See GCodeIndex.h for a description of the index.
+
+-----------------------------------------------------------------------------------------------------
+
+Licence: GPL
+
+****************************************************************************************************/
+
+#include "RepRapFirmware.h"
+
+//*************************************************************************************************
+// Access to existing index files
+
+// Is this a file we want to index?
+/*static*/ bool GCodeIndex::IsIndexable(const char *fileName)
+{
+	return StringEndsWith(fileName, ".gcode") || StringEndsWith(fileName, ".g")
+			|| StringEndsWith(fileName, ".gco") || StringEndsWith(fileName, ".gc");
+}
+
+// Get the 8.3 name of the index file for the specified G-Code file. We use the FNV-1a hash of the upper-case path without the volume prefix.
+/*static*/ void GCodeIndex::GetIndexFileName(const char *location, char *indexName)
+{
+	uint32_t hash = 2166136261u;
+	for (const char *p = MassStorage::SkipVolume(location); *p != 0; ++p)
+	{
+		hash = (hash ^ (uint8_t)toupper(*p)) * 16777619u;
+	}
+	snprintf(indexName, 13, "%08lx.idx", (unsigned long)hash);
+}
+
+// Open the index file of the specified file and read its header. Returns the open index file if the index is still valid, else nullptr.
+/*static*/ FileStore *GCodeIndex::OpenIndex(const char *location, GCodeIndexHeader& header)
+{
+	Platform * const platform = reprap.GetPlatform();
+	uint32_t fileSize, fileTimestamp;
+	if (!platform->GetMassStorage()->GetFileStatus(location, fileSize, fileTimestamp))
+	{
+		return nullptr;
+	}
+
+	char indexName[13];
+	GetIndexFileName(location, indexName);
+	FileStore * const indexFile = platform->GetFileStore(GCODE_INDEX_DIR, indexName, false);
+	if (indexFile == nullptr)
+	{
+		return nullptr;
+	}
+
+	if (indexFile->Read(reinterpret_cast<char*>(&header), sizeof(header)) != (int)sizeof(header)
+		|| header.magic != GCodeIndexMagic || header.version != GCodeIndexVersion
+		|| header.fileSize != fileSize || header.fileTimestamp != fileTimestamp
+		|| !StringEquals(MassStorage::SkipVolume(header.fileName), MassStorage::SkipVolume(location)))
+	{
+		indexFile->Close();
+		return nullptr;
+	}
+	return indexFile;
+}
+
+// Read the header of the index for the specified file. Returns true if a valid index was found.
+/*static*/ bool GCodeIndex::GetHeader(const char *directory, const char *fileName, GCodeIndexHeader& header)
+{
+	char location[FILENAME_LENGTH + 1];
+	strncpy(location, reprap.GetPlatform()->GetMassStorage()->CombineName(directory, fileName), ARRAY_SIZE(location));
+	location[ARRAY_UPB(location)] = 0;
+
+	FileStore * const indexFile = OpenIndex(location, header);
+	if (indexFile == nullptr)
+	{
+		return false;
+	}
+	indexFile->Close();
+	return true;
+}
+
+// Get the file information from the index of the specified file. Returns true if a valid index was found.
+/*static*/ bool GCodeIndex::GetFileInfo(const char *directory, const char *fileName, GCodeFileInfo& info)
+{
+	if (!IsIndexable(fileName))
+	{
+		return false;
+	}
+
+	GCodeIndexHeader header;
+	if (!GetHeader(directory, fileName, header) || !header.infoComplete)
+	{
+		return false;
+	}
+	info = header.info;
+	return true;
+}
+
+// Save the file information that PrintMonitor has parsed in an index without a layer table.
+// We don't replace an index that is still valid or one that is being written, which we can't read yet.
+/*static*/ bool GCodeIndex::StoreFileInfo(const char *directory, const char *fileName, const GCodeFileInfo& info)
+{
+	if (!info.isValid || !IsIndexable(fileName))
+	{
+		return false;
+	}
+
+	Platform * const platform = reprap.GetPlatform();
+	MassStorage * const massStorage = platform->GetMassStorage();
+	GCodeIndexHeader header;
+	strncpy(header.fileName, massStorage->CombineName(directory, fileName), ARRAY_SIZE(header.fileName));
+	header.fileName[ARRAY_UPB(header.fileName)] = 0;
+
+	uint32_t fileSize, fileTimestamp;
+	if (!massStorage->GetFileStatus(header.fileName, fileSize, fileTimestamp) || fileSize != info.fileSize)
+	{
+		return false;
+	}
+
+	char indexName[13];
+	GetIndexFileName(header.fileName, indexName);
+	FileStore *indexFile = platform->GetFileStore(GCODE_INDEX_DIR, indexName, false);
+	if (indexFile != nullptr)
+	{
+		GCodeIndexHeader oldHeader;
+		const bool obsolete = indexFile->Read(reinterpret_cast<char*>(&oldHeader), sizeof(oldHeader)) == (int)sizeof(oldHeader)
+								&& oldHeader.magic == GCodeIndexMagic
+								&& (oldHeader.version != GCodeIndexVersion || oldHeader.fileSize != fileSize || oldHeader.fileTimestamp != fileTimestamp
+									|| !StringEquals(MassStorage::SkipVolume(oldHeader.fileName), MassStorage::SkipVolume(header.fileName)));
+		indexFile->Close();
+		if (!obsolete)
+		{
+			return false;
+		}
+	}
+	else if (!massStorage->DirectoryExists(GCODE_INDEX_DIR) && !massStorage->MakeDirectory(GCODE_INDEX_DIR))
+	{
+		return false;
+	}
+
+	indexFile = platform->GetFileStore(GCODE_INDEX_DIR, indexName, true);
+	if (indexFile == nullptr)
+	{
+		return false;
+	}
+
+	header.magic = GCodeIndexMagic;
+	header.version = GCodeIndexVersion;
+	header.numLayers = 0;
+	header.fileSize = fileSize;
+	header.indexedLength = 0;							// so that printing the file still builds the layer table
+	header.fileTimestamp = fileTimestamp;
+	header.numMoves = 0;
+	header.printTime = 0.0;
+	header.infoComplete = true;
+	header.info = info;
+	bool ok = indexFile->Write(reinterpret_cast<const char*>(&header), sizeof(header));
+	ok = indexFile->Close() && ok;
+	if (!ok)
+	{
+		Invalidate(header.fileName);
+	}
+	return ok;
+}
+
+// Look up the start of a layer (counting from zero) in the index of the specified file
+/*static*/ bool GCodeIndex::FindLayer(const char *directory, const char *fileName, unsigned int layer, GCodeLayerEntry& entry)
+{
+	char location[FILENAME_LENGTH + 1];
+	strncpy(location, reprap.GetPlatform()->GetMassStorage()->CombineName(directory, fileName), ARRAY_SIZE(location));
+	location[ARRAY_UPB(location)] = 0;
+
+	GCodeIndexHeader header;
+	FileStore * const indexFile = OpenIndex(location, header);
+	if (indexFile == nullptr)
+	{
+		return false;
+	}
+
+	bool ok = layer < header.numLayers
+				&& indexFile->Seek(sizeof(GCodeIndexHeader) + layer * sizeof(GCodeLayerEntry))
+				&& indexFile->Read(reinterpret_cast<char*>(&entry), sizeof(entry)) == (int)sizeof(entry);
+	indexFile->Close();
+	return ok;
+}
+
+// Delete the index of a file that has been changed, renamed or deleted.
+// This is called from MassStorage and FileStore, so it must not use MassStorage::CombineName because 'location' may point to its buffer.
+/*static*/ void GCodeIndex::Invalidate(const char *location)
+{
+	if (IsIndexable(location))
+	{
+		char indexName[13];
+		GetIndexFileName(location, indexName);
+
+		char indexLocation[FILENAME_LENGTH + 1];
+		snprintf(indexLocation, ARRAY_SIZE(indexLocation), "%s/%s", GCODE_INDEX_DIR, indexName);
+		f_unlink(indexLocation);				// this fails quietly if there is no index
+	}
+}
+
+//*************************************************************************************************
+// Building new index files
+
+GCodeIndexer::GCodeIndexer(Platform *p) : platform(p), indexFile(nullptr)
+{
+}
+
+// Start indexing a file that is about to be written or printed.
+// If allowPartial is true, we keep the index even if we stop before the end of the file.
+bool GCodeIndexer::Start(const char *directory, const char *fileName, bool allowPartial)
+{
+	if (indexFile != nullptr || !GCodeIndex::IsIndexable(fileName))
+	{
+		// Already indexing another file, or this isn't a G-Code file
+		return false;
+	}
+
+	MassStorage * const massStorage = platform->GetMassStorage();
+	strncpy(header.fileName, massStorage->CombineName(directory, fileName), ARRAY_SIZE(header.fileName));
+	header.fileName[ARRAY_UPB(header.fileName)] = 0;
+
+	if (!massStorage->DirectoryExists(GCODE_INDEX_DIR) && !massStorage->MakeDirectory(GCODE_INDEX_DIR))
+	{
+		return false;
+	}
+
+	char indexName[13];
+	GCodeIndex::GetIndexFileName(header.fileName, indexName);
+	indexFile = platform->GetFileStore(GCODE_INDEX_DIR, indexName, true);
+	if (indexFile == nullptr)
+	{
+		return false;
+	}
+
+	// Write a placeholder for the header, it gets its final values when the file has been completed
+	header.magic = 0;
+	header.version = GCodeIndexVersion;
+	header.numLayers = 0;
+	header.fileSize = header.indexedLength = 0;
+	header.fileTimestamp = 0;
+	header.numMoves = 0;
+	header.printTime = 0.0;
+	header.infoComplete = false;
+	header.info.isValid = true;
+	header.info.fileSize = 0;
+	header.info.firstLayerHeight = 0.0;
+	header.info.objectHeight = 0.0;
+	header.info.layerHeight = 0.0;
+	header.info.numFilaments = 0;
+	header.info.generatedBy[0] = 0;
+	for (size_t extr = 0; extr < DRIVES - AXES; extr++)
+	{
+		header.info.filamentNeeded[extr] = 0.0;
+	}
+	if (!indexFile->Write(reinterpret_cast<const char*>(&header), sizeof(header)))
+	{
+		Finish(false);
+		return false;
+	}
+
+	// Set up the parser. We assume the same defaults as GCodes does after a reset.
+	linePointer = 0;
+	commentStart = ARRAY_SIZE(lineBuffer);
+	bytesProcessed = lineStart = 0;
+	for (size_t axis = 0; axis < AXES; axis++)
+	{
+		coords[axis] = 0.0;
+	}
+	extruderPosition = 0.0;
+	feedRate = DEFAULT_FEEDRATE;
+	lastLayerZ = 0.0;
+	currentTool = 0;
+	for (size_t tool = 0; tool < ARRAY_SIZE(toolTemperatures); tool++)
+	{
+		toolTemperatures[tool] = 0.0;
+	}
+	bedTemperature = 0.0;
+	axesRelative = false;
+	drivesRelative = true;
+	this->allowPartial = allowPartial;
+	zChangeState.z = 0.0;
+	zChangeState.filePos = 0;
+	zChangeState.extruderPosition = 0.0;
+	zChangeState.feedRate = feedRate;
+	zChangeState.tool = currentTool;
+	zChangeState.toolTemperature = zChangeState.bedTemperature = 0.0;
+	zChangeState.axesRelative = axesRelative;
+	zChangeState.drivesRelative = drivesRelative;
+	return true;
+}
+
+// Tokenise the next chunk of data written to the file
+void GCodeIndexer::Process(const char *data, size_t len)
+{
+	if (indexFile == nullptr)
+	{
+		return;
+	}
+
+	for (size_t i = 0; i < len; ++i)
+	{
+		const char c = data[i];
+		if (c == '\n')
+		{
+			ProcessLine();
+			if (indexFile == nullptr)
+			{
+				return;								// we gave up because the index couldn't be written
+			}
+			lineStart = bytesProcessed + 1;
+		}
+		else if (c != '\r' && linePointer < GCODE_LENGTH)
+		{
+			if (c == ';' && commentStart > linePointer)
+			{
+				commentStart = linePointer;
+			}
+			lineBuffer[linePointer++] = c;
+		}
+		++bytesProcessed;
+	}
+}
+
+// Finish the index after the indexed file has been closed or the print has stopped, or delete it if the upload failed
+void GCodeIndexer::Finish(bool success)
+{
+	if (indexFile == nullptr)
+	{
+		return;
+	}
+
+	if (success)
+	{
+		uint32_t fileSize, fileTimestamp;
+		if (platform->GetMassStorage()->GetFileStatus(header.fileName, fileSize, fileTimestamp)
+			&& (fileSize == bytesProcessed || (allowPartial && bytesProcessed < fileSize)))
+		{
+			if (linePointer != 0 && fileSize == bytesProcessed)
+			{
+				ProcessLine();						// the file didn't end with a newline
+				if (indexFile == nullptr)
+				{
+					return;
+				}
+			}
+
+			header.magic = GCodeIndexMagic;
+			header.fileSize = header.info.fileSize = fileSize;
+			header.indexedLength = bytesProcessed;
+			header.infoComplete = (bytesProcessed == fileSize);
+			header.fileTimestamp = fileTimestamp;
+			success = indexFile->Seek(0) && indexFile->Write(reinterpret_cast<const char*>(&header), sizeof(header));
+		}
+		else
+		{
+			success = false;
+		}
+	}
+
+	success = indexFile->Close() && success;
+	indexFile = nullptr;
+	if (!success)
+	{
+		GCodeIndex::Invalidate(header.fileName);
+	}
+	else if (reprap.Debug(modulePrintMonitor))
+	{
+		platform->MessageF(GENERIC_MESSAGE, "Indexed %s: %u layers, %lu moves, estimated print time %.0fs%s\n",
+							header.fileName, header.numLayers, header.numMoves, header.printTime,
+							(header.indexedLength == header.fileSize) ? "" : " (incomplete)");
+	}
+}
+
+// Process one complete line of G-Code
+void GCodeIndexer::ProcessLine()
+{
+	lineBuffer[linePointer] = 0;
+	const char *codeEnd = lineBuffer + min<size_t>(linePointer, commentStart);
+	if (commentStart < linePointer && header.info.generatedBy[0] == 0 && lineStart < GCODE_HEADER_SIZE)
+	{
+		CheckGeneratedBy(lineBuffer + commentStart + 1);
+	}
+	linePointer = 0;
+	commentStart = ARRAY_SIZE(lineBuffer);
+
+	// Skip leading white space and the line number, if any
+	const char *code = lineBuffer;
+	while (code < codeEnd && (*code == ' ' || *code == '\t'))
+	{
+		++code;
+	}
+	if (code < codeEnd && *code == 'N')
+	{
+		while (code < codeEnd && *code != ' ')
+		{
+			++code;
+		}
+		while (code < codeEnd && *code == ' ')
+		{
+			++code;
+		}
+	}
+	if (code + 1 >= codeEnd)
+	{
+		return;
+	}
+
+	const long codeNumber = strtol(code + 1, nullptr, 10);
+	switch (*code)
+	{
+	case 'G':
+		switch (codeNumber)
+		{
+		case 0:
+		case 1:
+		case 2:
+		case 3:
+			ProcessMove(code, codeEnd);
+			break;
+
+		case 90:
+			axesRelative = false;
+			break;
+
+		case 91:
+			axesRelative = true;
+			break;
+
+		case 92:
+			{
+				float value;
+				for (size_t axis = 0; axis < AXES; axis++)
+				{
+					if (ReadParameter(code, codeEnd, "XYZ"[axis], value))
+					{
+						coords[axis] = value;
+					}
+				}
+				if (ReadParameter(code, codeEnd, 'E', value))
+				{
+					extruderPosition = value;
+				}
+			}
+			break;
+
+		default:
+			break;
+		}
+		break;
+
+	case 'M':
+		switch (codeNumber)
+		{
+		case 82:
+			drivesRelative = false;
+			break;
+
+		case 83:
+			drivesRelative = true;
+			break;
+
+		case 104:
+		case 109:
+			{
+				float temperature, toolNumber;
+				if (ReadParameter(code, codeEnd, 'S', temperature))
+				{
+					const int tool = (ReadParameter(code, codeEnd, 'T', toolNumber)) ? (int)toolNumber : currentTool;
+					if (tool >= 0 && tool < (int)ARRAY_SIZE(toolTemperatures))
+					{
+						toolTemperatures[tool] = temperature;
+					}
+				}
+			}
+			break;
+
+		case 140:
+		case 190:
+			ReadParameter(code, codeEnd, 'S', bedTemperature);
+			break;
+
+		default:
+			break;
+		}
+		break;
+
+	case 'T':
+		currentTool = (int)codeNumber;
+		break;
+
+	default:
+		break;
+	}
+}
+
+// Process a G0, G1, G2 or G3 command. We treat arcs as straight lines, which is good enough for our estimates.
+void GCodeIndexer::ProcessMove(const char *code, const char *codeEnd)
+{
+	float newCoords[AXES];
+	float value;
+	for (size_t axis = 0; axis < AXES; axis++)
+	{
+		newCoords[axis] = coords[axis];
+		if (ReadParameter(code, codeEnd, "XYZ"[axis], value))
+		{
+			newCoords[axis] = (axesRelative) ? coords[axis] + value : value;
+		}
+	}
+
+	if (newCoords[Z_AXIS] != coords[Z_AXIS])
+	{
+		// Remember the state at the start of this line in case this turns out to be a layer change
+		zChangeState.filePos = lineStart;
+		zChangeState.extruderPosition = extruderPosition;
+		zChangeState.feedRate = feedRate;
+		zChangeState.tool = currentTool;
+		zChangeState.toolTemperature = (currentTool >= 0 && currentTool < (int)ARRAY_SIZE(toolTemperatures)) ? toolTemperatures[currentTool] : 0.0;
+		zChangeState.bedTemperature = bedTemperature;
+		zChangeState.axesRelative = axesRelative;
+		zChangeState.drivesRelative = drivesRelative;
+	}
+
+	if (ReadParameter(code, codeEnd, 'F', value) && value > 0.0)
+	{
+		feedRate = value;
+	}
+
+	float extrusion = 0.0;
+	if (ReadParameter(code, codeEnd, 'E', value))
+	{
+		extrusion = (drivesRelative) ? value : value - extruderPosition;
+		extruderPosition = (drivesRelative) ? extruderPosition + value : value;
+	}
+
+	const float distance = sqrtf(fsquare(newCoords[X_AXIS] - coords[X_AXIS]) + fsquare(newCoords[Y_AXIS] - coords[Y_AXIS])
+									+ fsquare(newCoords[Z_AXIS] - coords[Z_AXIS]));
+	for (size_t axis = 0; axis < AXES; axis++)
+	{
+		coords[axis] = newCoords[axis];
+	}
+
+	header.numMoves++;
+	header.printTime += ((distance > 0.0) ? distance : fabsf(extrusion)) * minutesToSeconds / feedRate;
+
+	if (currentTool >= 0 && currentTool < (int)(DRIVES - AXES))
+	{
+		header.info.filamentNeeded[currentTool] += extrusion;
+		if (extrusion != 0.0 && header.info.numFilaments <= (unsigned int)currentTool)
+		{
+			header.info.numFilaments = currentTool + 1;
+		}
+	}
+
+	// A printing move at a new height starts a new layer
+	if (extrusion > 0.0 && distance > 0.0)
+	{
+		const float z = coords[Z_AXIS];
+		if (header.numLayers == 0 || z > lastLayerZ + LAYER_HEIGHT_TOLERANCE)
+		{
+			AddLayer(z);
+		}
+		if (z > header.info.objectHeight)
+		{
+			header.info.objectHeight = z;
+		}
+	}
+}
+
+// Record the start of a new layer
+void GCodeIndexer::AddLayer(float z)
+{
+	if (header.numLayers == 0)
+	{
+		header.info.firstLayerHeight = z;
+	}
+	else if (header.numLayers == 1)
+	{
+		header.info.layerHeight = z - lastLayerZ;
+	}
+	lastLayerZ = z;
+
+	if (header.numLayers < MaxIndexedLayers)
+	{
+		zChangeState.z = z;
+		if (!indexFile->Write(reinterpret_cast<const char*>(&zChangeState), sizeof(zChangeState)))
+		{
+			// We can't use an index with missing layers, so give up
+			Finish(false);
+			return;
+		}
+		header.numLayers++;
+	}
+}
+
+// Look for a parameter in the code part of the current line
+bool GCodeIndexer::ReadParameter(const char *code, const char *codeEnd, char letter, float& value) const
+{
+	for (const char *p = code + 1; p < codeEnd; ++p)
+	{
+		if (*p == letter)
+		{
+			value = strtod(p + 1, nullptr);
+			return true;
+		}
+	}
+	return false;
+}
+
+// Look for the name of the slicer in a comment near the start of the file
+void GCodeIndexer::CheckGeneratedBy(const char *comment)
+{
+	const char *generatedByString = "generated by ";			// Slic3r and S3D
+	const char *slicedAtString = "Sliced at: ";					// Cura
+	const char *kisslicerString = " KISSlicer";					// KISSlicer
+
+	const char *pos = strstr(comment, generatedByString);
+	size_t i = 0;
+	if (pos != nullptr)
+	{
+		pos += strlen(generatedByString);
+	}
+	else if ((pos = strstr(comment, slicedAtString)) != nullptr)
+	{
+		pos += strlen(slicedAtString);
+		strcpy(header.info.generatedBy, "Cura at ");
+		i = strlen(header.info.generatedBy);
+	}
+	else if (StringStartsWith(comment, kisslicerString))
+	{
+		pos = comment + 1;
+	}
+	else
+	{
+		return;
+	}
+
+	// Store the name as it is, it is escaped when the JSON response is written
+	char * const generatedBy = header.info.generatedBy;
+	while (i < ARRAY_UPB(header.info.generatedBy) && *pos >= ' ')
+	{
+		generatedBy[i++] = *pos++;
+	}
+	generatedBy[i] = 0;
+}
+
+// vim: ts=4:sw=4
@@ -0,0 +1,120 @@
+/****************************************************************************************************
+
+RepRapFirmware - GCodeIndex
+
+This class tokenises G-Code files while they are being uploaded or printed and writes a small sidecar
+index for each of them. The index holds the file information normally obtained by PrintMonitor::GetFileInfo, a
+few statistics about the print and a table that maps each layer to its offset in the file, so that
+file information requests and resume-from-layer can be answered without scanning the file again.
+An index built while printing only covers the part of the file that was printed if the print was
+cancelled. It can still be used to resume from one of those layers, but not for file information.
+Files that were neither uploaded nor printed get an index without a layer table when PrintMonitor has
+parsed them, so that the next file information request for them needn't read the file again.
+
+Index files are stored in GCODE_INDEX_DIR using an 8.3 name derived from a hash of the full path of the
+G-Code file. Each index records the path, size and FAT timestamp of the file it describes, and it is
+only used if all of them still match.
+
+-----------------------------------------------------------------------------------------------------
+
+Licence: GPL
+
+****************************************************************************************************/
+
+#ifndef GCODEINDEX_H
+#define GCODEINDEX_H
+
+const uint32_t GCodeIndexMagic = 0x58444947;		// "GIDX"
+const uint16_t GCodeIndexVersion = 4;
+const uint16_t MaxIndexedLayers = 10000;			// We stop adding layers to the table after this many
+
+// Fixed-size header at the start of each index file. It is followed by numLayers GCodeLayerEntry records.
+struct GCodeIndexHeader
+{
+	uint32_t magic;
+	uint16_t version;
+	uint16_t numLayers;								// number of entries in the layer table
+	FilePosition fileSize;							// size of the indexed file
+	FilePosition indexedLength;						// number of bytes of the file that were indexed
+	uint32_t fileTimestamp;							// FAT date and time of the indexed file
+	uint32_t numMoves;								// number of G0/G1/G2/G3 commands
+	float printTime;								// rough print time estimate in seconds, ignoring acceleration
+	bool infoComplete;								// true if the file information covers the whole file
+	GCodeFileInfo info;
+	char fileName[FILENAME_LENGTH];					// full path of the indexed file, used to detect hash collisions
+};
+
+// One entry in the layer table. The machine state is recorded as it was at the start of the line at filePos.
+struct GCodeLayerEntry
+{
+	float z;										// height of the layer
+	FilePosition filePos;							// offset of the line that moved to this height
+	float extruderPosition;							// extruder position, only meaningful if the file uses absolute extrusion
+	float feedRate;									// feed rate in mm/min
+	int32_t tool;									// selected tool number
+	float toolTemperature;							// last active temperature set for that tool, or 0 if none was set
+	float bedTemperature;							// last bed temperature set, or 0 if none was set
+	bool axesRelative;								// G91 in force
+	bool drivesRelative;							// M83 in force
+};
+
+// Functions to access and invalidate existing index files
+class GCodeIndex
+{
+public:
+	static bool GetHeader(const char *directory, const char *fileName, GCodeIndexHeader& header);
+	static bool GetFileInfo(const char *directory, const char *fileName, GCodeFileInfo& info);
+	static bool StoreFileInfo(const char *directory, const char *fileName, const GCodeFileInfo& info);	// Create an index holding only the file information
+	static bool FindLayer(const char *directory, const char *fileName, unsigned int layer, GCodeLayerEntry& entry);
+	static void Invalidate(const char *location);	// Delete the index of the specified file, if any
+	static bool IsIndexable(const char *fileName);	// Is this the name of a file we index?
+
+	friend class GCodeIndexer;
+
+private:
+	static void GetIndexFileName(const char *location, char *indexName);
+	static FileStore *OpenIndex(const char *location, GCodeIndexHeader& header);
+};
+
+// Class to build an index while a file is being written
+class GCodeIndexer
+{
+public:
+	GCodeIndexer(Platform *p);
+	bool Start(const char *directory, const char *fileName, bool allowPartial);	// Start indexing a file, returns false if we can't or needn't index it
+	void Process(const char *data, size_t len);					// Tokenise the next chunk of the file
+	void Finish(bool success);									// Finalise the index after the file has been closed or the print has stopped, or discard it
+	bool IsActive() const { return indexFile != nullptr; }
+
+private:
+	void ProcessLine();
+	void ProcessMove(const char *code, const char *codeEnd);
+	void AddLayer(float z);
+	bool ReadParameter(const char *code, const char *codeEnd, char letter, float& value) const;
+	void CheckGeneratedBy(const char *comment);
+
+	Platform *platform;
+	FileStore *indexFile;
+	GCodeIndexHeader header;
+
+	char lineBuffer[GCODE_LENGTH + 1];
+	size_t linePointer;								// number of characters in lineBuffer
+	size_t commentStart;							// index of the first comment character in lineBuffer
+	FilePosition bytesProcessed;					// offset of the next character we process
+	FilePosition lineStart;							// offset of the line in lineBuffer
+
+	float coords[AXES];								// current position of the axes
+	float extruderPosition;							// current position of the extruder when using absolute extrusion
+	float feedRate;									// current feed rate in mm/min
+	float lastLayerZ;
+	int currentTool;
+	float toolTemperatures[DRIVES - AXES];			// last active temperatures set for the first few tools
+	float bedTemperature;
+	bool axesRelative, drivesRelative;
+	bool allowPartial;								// true if we keep the index of a file that we didn't see all of
+	GCodeLayerEntry zChangeState;					// machine state at the start of the line that last changed the Z position
+};
+
+#endif
+
+// vim: ts=4:sw=4
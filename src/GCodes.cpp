@@ -46,6 +46,9 @@ GCodes::GCodes(Platform* p) :
 #endif
 	fileGCode = new GCodeBuffer(platform, "file: ");
 	serialGCode = new GCodeBuffer(platform, "serial: ");
+	serialQueue = new SerialLineQueue(platform, SerialSource::USB);
+	profiler = new CommandProfiler(platform);
+	printIndexer = new GCodeIndexer(platform);
 	auxGCode = new GCodeBuffer(platform, "aux: ");
 	fileMacroGCode = new GCodeBuffer(platform, "macro: ");
 #if defined(LCD_UI)
@@ -66,7 +69,6 @@ void GCodes::Init()
 	rawExtruderTotal = 0.0;
 	for (size_t extruder = 0; extruder < DRIVES - AXES; extruder++)
 	{
-		lastRawExtruderPosition[extruder] = 0.0;
 		rawExtruderTotalByDrive[extruder] = 0.0;
 	}
 	eofString = EOF_STRING;
@@ -100,6 +102,7 @@ void GCodes::Reset()
 #endif
 	fileGCode->Init();
 	serialGCode->Init();
+	serialQueue->Reset();
 	auxGCode->Init();
 	auxGCode->SetCommsProperties(1);					// by default, we require a checksum on the aux port
 	fileMacroGCode->Init();
@@ -107,6 +110,7 @@ void GCodes::Reset()
 	lcdGCode->Init();
 #endif
 	moveAvailable = false;
+	printIndexer->Finish(true);
 	fileBeingPrinted.Close();
 	fileToPrint.Close();
 	fileBeingWritten = NULL;
@@ -114,8 +118,18 @@ void GCodes::Reset()
 	dwellWaiting = false;
 	stackPointer = 0;
 	state = GCodeState::normal;
-	drivesRelative = true;
-	axesRelative = false;
+	gbCurrent = nullptr;
+#if defined(WEBSERVER)
+	httpGCode->ResetModes();
+	telnetGCode->ResetModes();
+#endif
+	fileGCode->ResetModes();
+	serialGCode->ResetModes();
+	auxGCode->ResetModes();
+	fileMacroGCode->ResetModes();
+#if defined(LCD_UI)
+	lcdGCode->ResetModes();
+#endif
 	probeCount = 0;
 	cannedCycleMoveCount = 0;
 	cannedCycleMoveQueued = false;
@@ -157,23 +171,44 @@ float GCodes::FractionOfFilePrinted() const
 	return (stack[0].fileState.IsLive() && !stack[0].doingFileMacro) ? stack[0].fileState.FractionRead() : -1.0;
 }
 
+// Read G-codes from the file being printed. We scan whole file buffers for line endings instead of reading one byte at a time,
+// and we stop when we have a complete code or when we have used up our time allowance, so that long comments don't starve the move queue.
 void GCodes::DoFilePrint(GCodeBuffer* gb, StringRef& reply)
 {
-	for (int i = 0; i < 50 && fileBeingPrinted.IsLive(); ++i)
+	const uint32_t startTime = micros();
+	while (fileBeingPrinted.IsLive())
 	{
-		char b;
-		if (fileBeingPrinted.Read(b))
+		const char *data;
+		size_t len;
+		if (fileBeingPrinted.GetBufferedData(data, len))
 		{
 			if (gb->StartingNewCode() && gb == fileGCode)
 			{
-				filePos = fileBeingPrinted.GetPosition() - 1;
+				filePos = fileBeingPrinted.GetPosition();
 				//debugPrintf("Set file pos %u\n", filePos);
 			}
-			if (gb->Put(b))
+
+			// Hand over the data up to and including the next newline
+			const char *eol = static_cast<const char*>(memchr(data, '\n', len));
+			if (eol != nullptr)
+			{
+				len = eol - data + 1;
+			}
+			const bool codeComplete = gb->PutBlock(data, len);
+			if (gb == fileGCode)
+			{
+				printIndexer->Process(data, len);
+			}
+			fileBeingPrinted.SkipBufferedData(len);
+			if (codeComplete)
 			{
 				gb->SetFinished(ActOnCode(gb, reply));
 				break;
 			}
+			if (micros() - startTime >= FILE_PRINT_SPIN_TIME)
+			{
+				break;
+			}
 		}
 		else
 		{
@@ -196,6 +231,7 @@ void GCodes::DoFilePrint(GCodeBuffer* gb, StringRef& reply)
 				fileBeingPrinted.Close();
 				if (gb == fileGCode)
 				{
+					printIndexer->Finish(true);
 					reprap.GetPrintMonitor()->StoppedPrint();
 					if (platform->Emulating() == marlin)
 					{
@@ -218,34 +254,14 @@ void GCodes::Spin()
 	StringRef reply(replyBuffer, ARRAY_SIZE(replyBuffer));
 	reply.Clear();
 
-	// Check for M105 poll requests from Pronterface and PanelDue so that the status is kept up to date during execution of file macros etc.
-	// No need to read multiple characters at a time in this case because the polling rate is quite low.
-	if (!serialGCode->Active() && serialGCode->WritingFileDirectory() == nullptr && platform->GCodeAvailable(SerialSource::USB))
+	// In windowed mode we keep receiving from the USB interface even while we are busy, so that the host can keep several lines in flight
+	if (serialQueue->IsWindowed())
 	{
-		char b = platform->ReadFromSource(SerialSource::USB);
-		if (serialGCode->Put(b))	// add char to buffer and test whether the gcode is complete
-		{
-			if (serialGCode->IsPollRequest())
-			{
-				serialGCode->SetFinished(ActOnCode(serialGCode, reply));
-				return;
-			}
-		}
+		serialQueue->Spin();
 	}
 
-	if (!auxGCode->Active() && platform->GCodeAvailable(SerialSource::AUX))
-	{
-		char b = platform->ReadFromSource(SerialSource::AUX);
-		if (auxGCode->Put(b))		// add char to buffer and test whether the gcode is complete
-		{
-			auxDetected = true;
-			if (auxGCode->IsPollRequest())
-			{
-				auxGCode->SetFinished(ActOnCode(auxGCode, reply));
-				return;
-			}
-		}
-	}
+	// Run status requests and other codes that don't depend on the state machine, so that one source can't hold up the others
+	RunConcurrentGCodes(reply);
 
 	// Perform the next operation of the state machine
 	// Note: if we change the state to 'normal' from another state, we must call HandleReply to tell the host about the command we have just completed.
@@ -398,7 +414,7 @@ void GCodes::Spin()
 			fileBeingPrinted.MoveFrom(fileToPrint);
 			for (size_t drive = AXES; drive < DRIVES; ++drive)
 			{
-				lastRawExtruderPosition[drive - AXES] = pausedMoveBuffer[drive];	// reset the extruder position in case we are receiving absolute extruder moves
+				fileGCode->SetRawExtruderPosition(drive - AXES, pausedMoveBuffer[drive]);	// reset the extruder position in case we are receiving absolute extruder moves
 			}
 			feedRate = pausedMoveBuffer[DRIVES];
 			fileGCode->Resume();
@@ -413,6 +429,73 @@ void GCodes::Spin()
 	}
 }
 
+// Read from the sources that are idle and execute the codes that can run out of turn. This keeps PanelDue, Pronterface and the
+// web interface responsive, and lets them change temperatures and fan speeds, while a macro or a long wait such as M190 is in progress.
+// No need to read multiple characters at a time here because most of these codes are short and the polling rate is quite low.
+// Codes that can't be run here stay in their buffers until StartNextGCode gets to them.
+void GCodes::RunConcurrentGCodes(StringRef& reply)
+{
+	if (!serialGCode->Active() && serialGCode->WritingFileDirectory() == nullptr)
+	{
+		if (serialQueue->InUse())
+		{
+			serialQueue->GetLine(serialGCode);
+		}
+		else if (platform->GCodeAvailable(SerialSource::USB))
+		{
+			serialGCode->Put(platform->ReadFromSource(SerialSource::USB));
+		}
+	}
+	DoConcurrentGCode(serialGCode, reply);
+
+	if (!auxGCode->Active() && platform->GCodeAvailable(SerialSource::AUX))
+	{
+		if (auxGCode->Put(platform->ReadFromSource(SerialSource::AUX)))
+		{
+			auxDetected = true;
+		}
+	}
+	DoConcurrentGCode(auxGCode, reply);
+
+#if defined(WEBSERVER)
+	if (!httpGCode->Active() && httpGCode->WritingFileDirectory() == nullptr && webserver->GCodeAvailable(WebSource::HTTP))
+	{
+		httpGCode->Put(webserver->ReadGCode(WebSource::HTTP));
+	}
+	DoConcurrentGCode(httpGCode, reply);
+
+	if (!telnetGCode->Active() && webserver->GCodeAvailable(WebSource::Telnet))
+	{
+		telnetGCode->Put(webserver->ReadGCode(WebSource::Telnet));
+	}
+	DoConcurrentGCode(telnetGCode, reply);
+#endif
+
+#if defined(LCD_UI)
+	if (!lcdGCode->Active() && lcdUiInput->GCodeAvailable())
+	{
+		lcdGCode->Put(lcdUiInput->ReadGCode());
+	}
+	DoConcurrentGCode(lcdGCode, reply);
+#endif
+}
+
+// Execute the code in this buffer if it is complete and may be run out of turn.
+// The state machine may be working on behalf of another source, so we must leave gbCurrent alone.
+bool GCodes::DoConcurrentGCode(GCodeBuffer *gb, StringRef& reply)
+{
+	if (!gb->IsConcurrentRequest())
+	{
+		return false;
+	}
+
+	GCodeBuffer * const savedGb = gbCurrent;
+	gb->SetFinished(ActOnCode(gb, reply));
+	gbCurrent = savedGb;
+	reply.Clear();
+	return true;
+}
+
 void GCodes::StartNextGCode(StringRef& reply)
 {
 	// If a file macro is running, we don't allow anything to interrupt it
@@ -506,8 +589,38 @@ void GCodes::StartNextGCode(StringRef& reply)
 	}
 #endif
 
-	// Now the serial interfaces.
-	if (platform->GCodeAvailable(SerialSource::USB))
+	// Now the serial interfaces. In windowed mode the USB data has already been received into the queue.
+	if (serialQueue->InUse())
+	{
+#if defined(WEBSERVER)
+		if (serialGCode->WritingFileDirectory() == platform->GetWebDir())
+		{
+			char b;
+			while (serialGCode->WritingFileDirectory() == platform->GetWebDir() && serialQueue->GetChar(b))
+			{
+				WriteHTMLToFile(b, serialGCode);
+			}
+			platform->ClassReport(longWait);
+			return;
+		}
+		else
+#endif
+		/* else */ if (!serialGCode->Active() && serialQueue->GetLine(serialGCode))
+		{
+			if (serialGCode->WritingFileDirectory() != NULL)
+			{
+				WriteGCodeToFile(serialGCode);
+				serialGCode->SetFinished(true);
+			}
+			else
+			{
+				serialGCode->SetFinished(ActOnCode(serialGCode, reply));
+			}
+			platform->ClassReport(longWait);
+			return;
+		}
+	}
+	else if (platform->GCodeAvailable(SerialSource::USB))
 	{
 #if defined(WEBSERVER)
 		// First check the special case of uploading the reprap.htm file
@@ -572,6 +685,11 @@ void GCodes::StartNextGCode(StringRef& reply)
 		// Note: Direct web-printing has been dropped, so it's safe to execute web codes immediately
 		httpGCode->SetFinished(ActOnCode(httpGCode, reply));
 	}
+	else if (telnetGCode->Active())
+	{
+		// A line completed by RunConcurrentGCodes that couldn't be run out of turn
+		telnetGCode->SetFinished(ActOnCode(telnetGCode, reply));
+	}
 #endif
 	else if (serialGCode->Active())
 	{
@@ -591,7 +709,12 @@ void GCodes::StartNextGCode(StringRef& reply)
 #endif
 	else if (fileGCode->Active())
 	{
-		fileGCode->SetFinished(ActOnCode(fileGCode, reply));
+		const bool finished = ActOnCode(fileGCode, reply);
+		fileGCode->SetFinished(finished);
+		if (!finished && fileBeingPrinted.IsLive())
+		{
+			fileBeingPrinted.ReadAhead();				// use the time we spend waiting to read the next block of the file
+		}
 	}
 	else
 	{
@@ -606,6 +729,7 @@ void GCodes::Diagnostics()
 	platform->Message(GENERIC_MESSAGE, "GCodes Diagnostics:\n");
 	platform->MessageF(GENERIC_MESSAGE, "Move available? %s\n", moveAvailable ? "yes" : "no");
 	platform->MessageF(GENERIC_MESSAGE, "Stack pointer: %u of %u\n", stackPointer, StackSize);
+	serialQueue->Diagnostics();
 }
 
 // The wait till everything's done function.  If you need the machine to
@@ -641,8 +765,8 @@ void GCodes::Push()
 	stack[stackPointer].gb = gbCurrent;
 	stack[stackPointer].feedrate = feedRate;
 	stack[stackPointer].fileState.CopyFrom(fileBeingPrinted);
-	stack[stackPointer].drivesRelative = drivesRelative;
-	stack[stackPointer].axesRelative = axesRelative;
+	stack[stackPointer].drivesRelative = (gbCurrent == nullptr) || gbCurrent->DrivesRelative();
+	stack[stackPointer].axesRelative = (gbCurrent != nullptr) && gbCurrent->AxesRelative();
 	stack[stackPointer].doingFileMacro = doingFileMacro;
 	stackPointer++;
 }
@@ -659,10 +783,17 @@ void GCodes::Pop()
 	stackPointer--;
 	state = stack[stackPointer].state;
 	gbCurrent = stack[stackPointer].gb;
+	if (doingFileMacro && gbCurrent != nullptr && gbCurrent != fileMacroGCode)
+	{
+		gbCurrent->CopyRawExtruderPositionsFrom(fileMacroGCode);	// the macro extruded on behalf of the source that called it
+	}
 	feedRate = stack[stackPointer].feedrate;
 	fileBeingPrinted.MoveFrom(stack[stackPointer].fileState);
-	drivesRelative = stack[stackPointer].drivesRelative;
-	axesRelative = stack[stackPointer].axesRelative;
+	if (gbCurrent != nullptr)
+	{
+		gbCurrent->SetDrivesRelative(stack[stackPointer].drivesRelative);
+		gbCurrent->SetAxesRelative(stack[stackPointer].axesRelative);
+	}
 	doingFileMacro = stack[stackPointer].doingFileMacro;
 }
 
@@ -726,14 +857,14 @@ bool GCodes::LoadMoveBufferFromGCode(GCodeBuffer *gb, bool doingG92, bool applyL
 				if (doingG92)
 				{
 					moveBuffer.coords[drive + AXES] = 0.0;		// no move required
-					lastRawExtruderPosition[drive] = moveArg;
+					gb->SetRawExtruderPosition(drive, moveArg);
 				}
 				else
 				{
-					float extrusionAmount = (drivesRelative)
+					float extrusionAmount = (gb->DrivesRelative())
 												? moveArg
-												: moveArg - lastRawExtruderPosition[drive];
-					lastRawExtruderPosition[drive] += extrusionAmount;
+												: moveArg - gb->GetRawExtruderPosition(drive);
+					gb->SetRawExtruderPosition(drive, gb->GetRawExtruderPosition(drive) + extrusionAmount);
 					rawExtruderTotalByDrive[drive] += extrusionAmount;
 					rawExtruderTotal += extrusionAmount;
 					moveBuffer.coords[drive + AXES] = extrusionAmount * extrusionFactors[drive];
@@ -755,7 +886,7 @@ bool GCodes::LoadMoveBufferFromGCode(GCodeBuffer *gb, bool doingG92, bool applyL
 			}
 			else
 			{
-				if (axesRelative)
+				if (gb->AxesRelative())
 				{
 					moveArg += moveBuffer.coords[axis];
 				}
@@ -845,7 +976,7 @@ int GCodes::SetUpMove(GCodeBuffer *gb, StringRef& reply)
 	if (reprap.GetMove()->IsDeltaMode())
 	{
 		// Extra checks to avoid damaging delta printers
-		if (moveBuffer.moveType != 0 && !axesRelative)
+		if (moveBuffer.moveType != 0 && !gb->AxesRelative())
 		{
 			// We have been asked to do a move without delta mapping on a delta machine, but the move is not relative.
 			// This may be damaging and is almost certainly a user mistake, so ignore the move.
@@ -919,7 +1050,7 @@ void GCodes::ClearMove()
 // Return true if the file was found or it wasn't and we were asked to report that fact.
 bool GCodes::DoFileMacro(const char* fileName, bool reportMissing)
 {
-	FileStore *f = platform->GetFileStore(platform->GetSysDir(), fileName, false);
+	FileStore *f = platform->GetMacroFileStore(platform->GetSysDir(), fileName);
 	if (f == NULL)
 	{
 		if (reportMissing)
@@ -935,6 +1066,14 @@ bool GCodes::DoFileMacro(const char* fileName, bool reportMissing)
 	fileBeingPrinted.Set(f);
 	doingFileMacro = true;
 	fileMacroGCode->Init();
+	if (gbCurrent != nullptr)
+	{
+		fileMacroGCode->CopyModesFrom(gbCurrent);		// the macro starts with the modes of the source that called it
+	}
+	else
+	{
+		fileMacroGCode->ResetModes();
+	}
 	state = GCodeState::normal;
 	return true;
 }
@@ -1621,16 +1760,17 @@ void GCodes::QueueFileToPrint(const char* fileName)
 		}
 
 		fileGCode->SetToolNumberAdjust(0);	// clear tool number adjustment
+		fileGCode->ResetModes();			// a new print doesn't inherit G91 or M82 or the extruder positions from the last one
 
-		// Reset all extruder positions when starting a new print
+		// Reset the extrusion totals when starting a new print
 		for (size_t extruder = AXES; extruder < DRIVES; extruder++)
 		{
-			lastRawExtruderPosition[extruder - AXES] = 0.0;
 			rawExtruderTotalByDrive[extruder - AXES] = 0.0;
 		}
 		rawExtruderTotal = 0.0;
 
 		fileToPrint.Set(f);
+		fileToPrint.EnableReadAhead();
 	}
 	else
 	{
@@ -1975,7 +2115,7 @@ void GCodes::HandleReply(GCodeBuffer *gb, bool error, const char* reply)
 	}
 
 	// Second UART device, e.g. dc42's PanelDue. Do NOT use emulation for this one!
-	if (gb == auxGCode || (stackPointer != 0 && stack[0].gb == auxGCode))
+	if (gb == auxGCode || (gb == fileMacroGCode && stackPointer != 0 && stack[0].gb == auxGCode))
 	{
 		// Discard this response if either no aux device is attached or if the response is empty
 		if (reply[0] == 0 || !HaveAux())
@@ -2098,7 +2238,7 @@ void GCodes::HandleReply(GCodeBuffer *gb, bool error, OutputBuffer *reply)
 	}
 
 	// Second UART device, e.g. dc42's PanelDue. Do NOT use emulation for this one!
-	if (gb == auxGCode || (stackPointer != 0 && stack[0].gb == auxGCode))
+	if (gb == auxGCode || (gb == fileMacroGCode && stackPointer != 0 && stack[0].gb == auxGCode))
 	{
 		// Discard this response if either no aux device is attached or if the response is empty
 		if (reply->Length() == 0 || !HaveAux())
@@ -2107,8 +2247,8 @@ void GCodes::HandleReply(GCodeBuffer *gb, bool error, OutputBuffer *reply)
 			return;
 		}
 
-		// JSON responses are always sent directly to the AUX device
-		if ((*reply)[0] == '{')
+		// JSON responses and binary status frames are always sent directly to the AUX device
+		if ((*reply)[0] == '{' || (*reply)[0] == BinaryWriter::frameDelimiter)
 		{
 			platform->Message(AUX_MESSAGE, reply);
 			return;
@@ -2452,24 +2592,43 @@ bool GCodes::ActOnCode(GCodeBuffer *gb, StringRef& reply)
 	// M-code parameters might contain letters T and G, e.g. in filenames.
 	// dc42 assumes that G-and T-code parameters never contain the letter M.
 	// Therefore we must check for an M-code first.
-	if (gb->Seen('M'))
-	{
-		return HandleMcode(gb, reply);
-	}
 	// dc42 doesn't think a G-code parameter ever contains letter T, or a T-code ever contains letter G.
 	// So it doesn't matter in which order we look for them.
-	if (gb->Seen('G'))
+	const char letter = (gb->Seen('M')) ? 'M' : (gb->Seen('G')) ? 'G' : (gb->Seen('T')) ? 'T' : 0;
+	if (letter == 0)
 	{
-		return HandleGcode(gb, reply);
+		// An invalid or queued buffer gets discarded
+		HandleReply(gb, false, "");
+		return true;
 	}
-	if (gb->Seen('T'))
+
+	// Get the code number for the profiler. The handlers read it again, so we have to search for the letter a second time.
+	const int code = gb->GetIValue();
+	gb->Seen(letter);
+
+	const uint32_t startTime = micros();
+	bool done;
+	switch (letter)
 	{
-		return HandleTcode(gb, reply);
+	case 'M':
+		done = HandleMcode(gb, reply);
+		break;
+
+	case 'G':
+		done = HandleGcode(gb, reply);
+		break;
+
+	default:
+		done = HandleTcode(gb, reply);
+		break;
 	}
 
-	// An invalid or queued buffer gets discarded
-	HandleReply(gb, false, "");
-	return true;
+	gb->NoteExecutionCall(startTime, micros() - startTime);
+	if (done)
+	{
+		profiler->Record(letter, code, gb);
+	}
+	return done;
 }
 
 bool GCodes::HandleGcode(GCodeBuffer* gb, StringRef& reply)
@@ -2603,13 +2762,13 @@ bool GCodes::HandleGcode(GCodeBuffer* gb, StringRef& reply)
 	case 90: // Absolute coordinates
 		// DC 2014-07-21 we no longer change the extruder settings in response to G90/G91 commands
 		//drivesRelative = false;
-		axesRelative = false;
+		gb->SetAxesRelative(false);
 		break;
 
 	case 91: // Relative coordinates
 		// DC 2014-07-21 we no longer change the extruder settings in response to G90/G91 commands
 		//drivesRelative = true; // Non-axis movements (i.e. extruders)
-		axesRelative = true;   // Axis movements (i.e. X, Y and Z)
+		gb->SetAxesRelative(true);   // Axis movements (i.e. X, Y and Z)
 		break;
 
 	case 92: // Set position
@@ -2633,18 +2792,20 @@ bool GCodes::HandleMcode(GCodeBuffer* gb, StringRef& reply)
 	bool error = false;
 
 	int code = gb->GetIValue();
-	if (simulating && (code < 20 || code > 37) && code != 82 && code != 83 && code != 111 && code != 105 && code != 122 && code != 999)
+	const uint8_t flags = GCodeBuffer::GetMCodeFlags(code);
+	if (simulating && (flags & mcodeSimulated) == 0)
 	{
 		return true;			// we don't yet simulate most M codes
 	}
+	if ((flags & mcodeNeedsIdle) != 0 && !AllMovesAreFinishedAndMoveBufferIsLoaded())
+	{
+		return false;
+	}
 
 	switch (code)
 	{
 	case 0: // Stop
 	case 1: // Sleep
-		if (!AllMovesAreFinishedAndMoveBufferIsLoaded())
-			return false;
-
 		if (fileBeingPrinted.IsLive())
 		{
 			fileBeingPrinted.Close();
@@ -2695,8 +2856,6 @@ bool GCodes::HandleMcode(GCodeBuffer* gb, StringRef& reply)
 
 	case 18: // Motors off
 	case 84:
-		if (!AllMovesAreFinishedAndMoveBufferIsLoaded())
-			return false;
 		{
 			bool seen = false;
 			for (size_t axis = 0; axis < AXES; axis++)
@@ -2740,6 +2899,7 @@ bool GCodes::HandleMcode(GCodeBuffer* gb, StringRef& reply)
 				else
 				{
 					reprap.GetMove()->SetIdleTimeout(idleTimeout);
+					platform->ConfigChanged();
 				}
 			}
 
@@ -2849,6 +3009,7 @@ bool GCodes::HandleMcode(GCodeBuffer* gb, StringRef& reply)
 				{
 					fileBeingPrinted.MoveFrom(fileToPrint);
 					reprap.GetPrintMonitor()->StartedPrint();
+					StartPrintIndexer();
 				}
 			}
 			else
@@ -2859,11 +3020,6 @@ bool GCodes::HandleMcode(GCodeBuffer* gb, StringRef& reply)
 		break;
 
 	case 24: // Print/resume-printing the selected file
-		if (!AllMovesAreFinishedAndMoveBufferIsLoaded())
-		{
-			return false;
-		}
-
 		if (!fileToPrint.IsLive())
 		{
 			reply.copy("Cannot print, because no file is selected!");
@@ -2879,12 +3035,11 @@ bool GCodes::HandleMcode(GCodeBuffer* gb, StringRef& reply)
 		{
 			fileBeingPrinted.MoveFrom(fileToPrint);
 			reprap.GetPrintMonitor()->StartedPrint();
+			StartPrintIndexer();
 		}
 		break;
 
 	case 226: // Gcode Initiated Pause
-		if (!AllMovesAreFinishedAndMoveBufferIsLoaded())
-			return false;
 		// no break
 
 	case 25: // Pause the print
@@ -2912,6 +3067,7 @@ bool GCodes::HandleMcode(GCodeBuffer* gb, StringRef& reply)
 				FilePosition fPos = reprap.GetMove()->PausePrint(pausedMoveBuffer);	// tell Move we wish to pause the current print
 				if (fPos != noFilePosition && fileBeingPrinted.IsLive())
 				{
+					printIndexer->Finish(true);							// the indexer mustn't see the replayed instructions again
 					fileBeingPrinted.Seek(fPos);						// replay the abandoned instructions if/when we resume
 				}
 				fileGCode->Init();
@@ -2926,7 +3082,7 @@ bool GCodes::HandleMcode(GCodeBuffer* gb, StringRef& reply)
 
 				for (size_t drive = AXES; drive < DRIVES; ++drive)
 				{
-					pausedMoveBuffer[drive] = lastRawExtruderPosition[drive - AXES]  - pausedMoveBuffer[drive];
+					pausedMoveBuffer[drive] = fileGCode->GetRawExtruderPosition(drive - AXES) - pausedMoveBuffer[drive];
 				}
 
 				if (reprap.Debug(moduleGcodes))
@@ -2943,7 +3099,7 @@ bool GCodes::HandleMcode(GCodeBuffer* gb, StringRef& reply)
 				}
 				for (size_t drive = AXES; drive < DRIVES; ++drive)
 				{
-					pausedMoveBuffer[drive] = lastRawExtruderPosition[drive - AXES];	// get current extruder positions into pausedMoveBuffer
+					pausedMoveBuffer[drive] = fileGCode->GetRawExtruderPosition(drive - AXES);	// get current extruder positions into pausedMoveBuffer
 				}
 				pausedMoveBuffer[DRIVES] = feedRate;
 			}
@@ -2970,6 +3126,7 @@ bool GCodes::HandleMcode(GCodeBuffer* gb, StringRef& reply)
 			}
 			else if (fileBeingPrinted.IsLive())
 			{
+				printIndexer->Finish(true);				// the indexer only works if it sees the file from start to end
 				if (!fileBeingPrinted.Seek(value))
 				{
 					reply.copy("The specified SD position is invalid!");
@@ -2978,6 +3135,7 @@ bool GCodes::HandleMcode(GCodeBuffer* gb, StringRef& reply)
 			}
 			else if (fileToPrint.IsLive())
 			{
+				printIndexer->Finish(true);
 				if (!fileToPrint.Seek(value))
 				{
 					reply.copy("The specified SD position is invalid!");
@@ -2990,9 +3148,22 @@ bool GCodes::HandleMcode(GCodeBuffer* gb, StringRef& reply)
 				error = true;
 			}
 		}
+		else if (gb->Seen('L'))
+		{
+			// Resume a print from the start of a layer, using the index of the file
+			if (!fileToPrint.IsLive() || isPaused)
+			{
+				reply.copy("Cannot resume from a layer, because no file has been selected with M23!");
+				error = true;
+			}
+			else
+			{
+				error = !ResumeFromLayer(gb->GetIValue(), reply);
+			}
+		}
 		else
 		{
-			reply.copy("You must specify the SD position in bytes using the S parameter.");
+			reply.copy("You must specify the SD position in bytes using the S parameter or a layer number using the L parameter.");
 			error = true;
 		}
 		break;
@@ -3109,30 +3280,22 @@ bool GCodes::HandleMcode(GCodeBuffer* gb, StringRef& reply)
 		break;
 
 	case 81:	// ATX power off
-		if (!AllMovesAreFinishedAndMoveBufferIsLoaded())
-			return false;
 		platform->SetAtxPower(false);
 		break;
 
 	case 82:	// Use absolute extruder positioning
-		if (drivesRelative)		// don't reset the absolute extruder position if it was already absolute
+		if (gb->DrivesRelative())		// don't reset the absolute extruder position if it was already absolute
 		{
-			for (size_t extruder = AXES; extruder < DRIVES; extruder++)
-			{
-				lastRawExtruderPosition[extruder - AXES] = 0.0;
-			}
-			drivesRelative = false;
+			gb->ResetRawExtruderPositions();	// only this source's positions, the others keep theirs
+			gb->SetDrivesRelative(false);
 		}
 		break;
 
 	case 83:	// Use relative extruder positioning
-		if (!drivesRelative)	// don't reset the absolute extruder position if it was already relative
+		if (!gb->DrivesRelative())	// don't reset the absolute extruder position if it was already relative
 		{
-			for (size_t extruder = AXES; extruder < DRIVES; extruder++)
-			{
-				lastRawExtruderPosition[extruder - AXES] = 0.0;
-			}
-			drivesRelative = true;
+			gb->ResetRawExtruderPositions();
+			gb->SetDrivesRelative(true);
 		}
 		break;
 
@@ -3142,11 +3305,6 @@ bool GCodes::HandleMcode(GCodeBuffer* gb, StringRef& reply)
 		break;
 
 	case 92: // Set/report steps/mm for some axes
-		if (!AllMovesAreFinishedAndMoveBufferIsLoaded())
-		{
-			return false;
-		}
-
 		{
 			// Save the current positions as we may need them later
 			float positionNow[DRIVES];
@@ -3199,11 +3357,6 @@ bool GCodes::HandleMcode(GCodeBuffer* gb, StringRef& reply)
 		break;
 
 	case 98: // Call Macro/Subprogram
-		if (!AllMovesAreFinishedAndMoveBufferIsLoaded())
-		{
-			return false;
-		}
-
 		if (gb->Seen('P'))
 		{
 			DoFileMacro(gb->GetString());
@@ -3211,11 +3364,6 @@ bool GCodes::HandleMcode(GCodeBuffer* gb, StringRef& reply)
 		break;
 
 	case 99: // Return from Macro/Subprogram
-		if (!AllMovesAreFinishedAndMoveBufferIsLoaded())
-		{
-			return false;
-		}
-
 		FileMacroCyclesReturn();
 		break;
 
@@ -3377,9 +3525,6 @@ bool GCodes::HandleMcode(GCodeBuffer* gb, StringRef& reply)
 		break;
 
 	case 109: // Deprecated
-		if (!AllMovesAreFinishedAndMoveBufferIsLoaded())
-			return false;
-
 		if (gb->Seen('S'))
 		{
 			float temperature = gb->GetFValue();
@@ -3399,7 +3544,7 @@ bool GCodes::HandleMcode(GCodeBuffer* gb, StringRef& reply)
 		}
 		break;
 
-	case 110: // Set line numbers - line numbers are dealt with in the GCodeBuffer class
+	case 110: // Set line numbers - line numbers are dealt with in the GCodeBuffer and SerialLineQueue classes
 		break;
 
 	case 111: // Debug level
@@ -3443,11 +3588,6 @@ bool GCodes::HandleMcode(GCodeBuffer* gb, StringRef& reply)
 		break;
 
 	case 116: // Wait for everything, especially set temperatures
-		if (!AllMovesAreFinishedAndMoveBufferIsLoaded())
-		{
-			return false;
-		}
-
 		{
 			bool seen = false;
 			if (gb->Seen('P'))
@@ -3514,18 +3654,10 @@ bool GCodes::HandleMcode(GCodeBuffer* gb, StringRef& reply)
 		break;
 
 	case 120:
-		if (!AllMovesAreFinishedAndMoveBufferIsLoaded())
-		{
-			return false;
-		}
 		Push();
 		break;
 
 	case 121:
-		if (!AllMovesAreFinishedAndMoveBufferIsLoaded())
-		{
-			return false;
-		}
 		Pop();
 		break;
 
@@ -3543,6 +3675,14 @@ bool GCodes::HandleMcode(GCodeBuffer* gb, StringRef& reply)
 		}
 		break;
 
+	case 123: // Report command execution times
+		profiler->Report();
+		if (gb->Seen('S') && gb->GetIValue() > 0)
+		{
+			profiler->Init();
+		}
+		break;
+
 	case 126: // Valve open
 		reply.copy("M126 - valves not yet implemented");
 		break;
@@ -3721,11 +3861,6 @@ bool GCodes::HandleMcode(GCodeBuffer* gb, StringRef& reply)
 		break;
 
 	case 190: // Set bed temperature and wait
-		if (!AllMovesAreFinishedAndMoveBufferIsLoaded())	// tell Move not to wait for more moves
-		{
-			return false;
-		}
-
 		if (gb->Seen('S'))
 		{
 			if (BED_HEATER >= 0)
@@ -3981,10 +4116,6 @@ bool GCodes::HandleMcode(GCodeBuffer* gb, StringRef& reply)
 		break;
 
 	case 350: // Set/report microstepping
-		if (!AllMovesAreFinishedAndMoveBufferIsLoaded())
-		{
-			return false;
-		}
 		{
 			// interp is current an int not a bool, because we use special values of interp to set the chopper control register
 			int interp = 0;
@@ -4044,11 +4175,7 @@ bool GCodes::HandleMcode(GCodeBuffer* gb, StringRef& reply)
 		}
 		break;
 
-	case 400: // Wait for current moves to finish
-		if (!AllMovesAreFinishedAndMoveBufferIsLoaded())
-		{
-			return false;
-		}
+	case 400: // Wait for current moves to finish - this is done before we get here, see the M-code table in GCodeBuffer
 		break;
 
 	case 404: // Filament width and nozzle diameter
@@ -4079,6 +4206,7 @@ bool GCodes::HandleMcode(GCodeBuffer* gb, StringRef& reply)
 			int seq = gb->Seen('R') ? gb->GetIValue() : -1;
 
 			OutputBuffer *statusResponse = nullptr;
+			bool binary = false;
 			switch (type)
 			{
 				case 0:
@@ -4089,17 +4217,41 @@ bool GCodes::HandleMcode(GCodeBuffer* gb, StringRef& reply)
 				case 2:
 				case 3:
 				case 4:
-					statusResponse = reprap.GetStatusResponse(type - 1, (gb == auxGCode) ? ResponseSource::AUX : ResponseSource::Generic);
+					if (gb == auxGCode && (platform->GetCommsProperties(1) & 4) != 0)
+					{
+						// The AUX device has asked for binary status frames, D is the statusSeq of the last frame it received
+						statusResponse = reprap.GetBinaryStatusResponse(type - 1, (gb->Seen('D')) ? gb->GetIValue() : 0);
+						binary = true;
+					}
+					else
+					{
+						statusResponse = reprap.GetStatusResponse(type - 1, (gb == auxGCode) ? ResponseSource::AUX : ResponseSource::Generic);
+					}
 					break;
 
 				case 5:
 					statusResponse = reprap.GetConfigResponse();
 					break;
+
+				case 6:
+					statusResponse = profiler->GetJsonResponse();
+					break;
+
+				case 7:
+					statusResponse = platform->GetIoStatistics()->GetJsonResponse();
+					if (gb->Seen('P') && gb->GetIValue() == 1)
+					{
+						platform->GetIoStatistics()->Init();
+					}
+					break;
 			}
 
 			if (statusResponse != nullptr)
 			{
-				statusResponse->cat('\n');
+				if (!binary)
+				{
+					statusResponse->cat('\n');
+				}
 				HandleReply(gb, false, statusResponse);
 				return true;
 			}
@@ -4749,6 +4901,7 @@ bool GCodes::HandleMcode(GCodeBuffer* gb, StringRef& reply)
 					{
 					case 0:
 						serialGCode->SetCommsProperties(val);
+						serialQueue->SetCommsProperties(val);
 						break;
 					case 1:
 						auxGCode->SetCommsProperties(val);
@@ -4763,6 +4916,14 @@ bool GCodes::HandleMcode(GCodeBuffer* gb, StringRef& reply)
 					uint32_t cp = platform->GetCommsProperties(chan);
 					reply.printf("Channel %d: baud rate %d, %s checksum", chan, platform->GetBaudRate(chan),
 							(cp & 1) ? "requires" : "does not require");
+					if (chan == 1 && (cp & 4) != 0)
+					{
+						reply.catf(", binary status protocol version %u", binaryStatusVersion);
+					}
+					if (chan == 0 && serialQueue->IsWindowed())
+					{
+						reply.catf(", windowed with %u byte receive queue", serialQueue->Capacity());
+					}
 				}
 			}
 		}
@@ -4830,11 +4991,6 @@ bool GCodes::HandleMcode(GCodeBuffer* gb, StringRef& reply)
 
 #if SUPPORT_INKJET
 	case 578: // Fire Inkjet bits
-		if (!AllMovesAreFinishedAndMoveBufferIsLoaded())
-		{
-			return false;
-		}
-
 		if (gb->Seen('S')) // Need to handle the 'P' parameter too; see http://reprap.org/wiki/G-code#M578:_Fire_inkjet_bits
 		{
 			platform->Inkjet(gb->GetIValue());
@@ -4892,10 +5048,6 @@ bool GCodes::HandleMcode(GCodeBuffer* gb, StringRef& reply)
 #endif
 
 	case 665: // Set delta configuration
-		if (!AllMovesAreFinishedAndMoveBufferIsLoaded())
-		{
-			return false;
-		}
 		{
 			float positionNow[DRIVES];
 			Move *move = reprap.GetMove();
@@ -4976,10 +5128,6 @@ bool GCodes::HandleMcode(GCodeBuffer* gb, StringRef& reply)
 		break;
 
 	case 666: // Set delta endstop adjustments
-		if (!AllMovesAreFinishedAndMoveBufferIsLoaded())
-		{
-			return false;
-		}
 		{
 			DeltaParameters& params = reprap.GetMove()->AccessDeltaParams();
 			bool seen = false;
@@ -5012,10 +5160,6 @@ bool GCodes::HandleMcode(GCodeBuffer* gb, StringRef& reply)
 		break;
 
 	case 667: // Set CoreXY mode
-		if (!AllMovesAreFinishedAndMoveBufferIsLoaded())
-		{
-			return false;
-		}
 		{
 			Move* move = reprap.GetMove();
 			bool seen = false;
@@ -5053,10 +5197,6 @@ bool GCodes::HandleMcode(GCodeBuffer* gb, StringRef& reply)
 
 #if defined(DIGIPOTS)
 	case 906: // Set/report Motor currents
-		if (!AllMovesAreFinishedAndMoveBufferIsLoaded())
-		{
-			return false;
-		}
 		{
 			bool seen = false;
 			for (size_t axis = 0; axis < AXES; axis++)
@@ -5198,10 +5338,10 @@ bool GCodes::HandleTcode(GCodeBuffer* gb, StringRef& reply)
 	return true;
 }
 
-// Return the amount of filament extruded
+// Return the amount of filament extruded by the file being printed
 float GCodes::GetRawExtruderPosition(size_t extruder) const
 {
-	return (extruder < (DRIVES - AXES)) ? lastRawExtruderPosition[extruder] : 0.0;
+	return (extruder < (DRIVES - AXES)) ? fileGCode->GetRawExtruderPosition(extruder) : 0.0;
 }
 
 float GCodes::GetRawExtruderTotalByDrive(size_t extruder) const
@@ -5225,6 +5365,7 @@ void GCodes::CancelPrint()
 	moveAvailable = false;
 
 	fileGCode->Init();
+	printIndexer->Finish(true);				// keep the layers we have seen so far, so that the print can be resumed
 
 	if (fileBeingPrinted.IsLive())
 	{
@@ -5234,6 +5375,68 @@ void GCodes::CancelPrint()
 	reprap.GetPrintMonitor()->StoppedPrint();
 }
 
+// Start building a layer index for the file we have just started printing, unless it already has a complete one.
+// We can only do this if we are printing it from the start.
+void GCodes::StartPrintIndexer()
+{
+	const char *fileName = reprap.GetPrintMonitor()->GetPrintingFilename();
+	GCodeIndexHeader header;
+	if (fileBeingPrinted.GetPosition() == 0
+		&& (!GCodeIndex::GetHeader(platform->GetGCodeDir(), fileName, header) || header.indexedLength != header.fileSize))
+	{
+		printIndexer->Start(platform->GetGCodeDir(), fileName, true);
+	}
+}
+
+// Prepare to print the selected file from the start of the specified layer, counting from 1, using its index.
+// We restore the state of the machine as it was at the start of the line that moved to the layer height, so the first line we print restores the Z position.
+// The user still has to wait for the heaters and make sure that the head can move to the layer safely before starting the print with M24.
+bool GCodes::ResumeFromLayer(int layer, StringRef& reply)
+{
+	const char *fileName = reprap.GetPrintMonitor()->GetPrintingFilename();
+	GCodeLayerEntry entry;
+	if (layer < 1 || !GCodeIndex::FindLayer(platform->GetGCodeDir(), fileName, layer - 1, entry))
+	{
+		reply.printf("Layer %d of file %s is not in the index. Print the file or upload it again to index it.", layer, fileName);
+		return false;
+	}
+	if (!fileToPrint.Seek(entry.filePos))
+	{
+		reply.copy("The specified SD position is invalid!");
+		return false;
+	}
+
+	fileGCode->SetAxesRelative(entry.axesRelative);
+	fileGCode->SetDrivesRelative(entry.drivesRelative);
+	feedRate = entry.feedRate * distanceScale * speedFactor;
+
+	Tool * const tool = reprap.GetTool(entry.tool);
+	if (tool != nullptr)
+	{
+		reprap.SelectTool(tool->Number());
+		if (entry.toolTemperature > 0.0)
+		{
+			SetToolHeaters(tool, entry.toolTemperature);
+		}
+
+		// Set the extruder position as G92 would, in case the file uses absolute extrusion
+		for (size_t eDrive = 0; eDrive < tool->DriveCount(); eDrive++)
+		{
+			fileGCode->SetRawExtruderPosition(tool->Drive(eDrive), entry.extruderPosition * distanceScale);
+		}
+	}
+
+	const int bedHeater = reprap.GetHeat()->GetBedHeater();
+	if (bedHeater >= 0 && entry.bedTemperature > 0.0)
+	{
+		reprap.GetHeat()->SetActiveTemperature(bedHeater, entry.bedTemperature);
+		reprap.GetHeat()->Activate(bedHeater);
+	}
+
+	reply.printf("Print of %s will resume at layer %d (Z=%.2f, file position %lu)", fileName, layer, entry.z, entry.filePos);
+	return true;
+}
+
 // Return true if all the heaters for the specified tool are at their set temperatures
 bool GCodes::ToolHeatersAtSetTemperatures(const Tool *tool) const
 {
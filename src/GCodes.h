@@ -23,12 +23,15 @@ Licence: GPL
 #define GCODES_H
 
 #include "GCodeBuffer.h"
+#include "SerialLineQueue.h"
+#include "CommandProfiler.h"
 
 #if defined(LCD_UI)
 #include "UIBuffer.h"
 #endif
 
 const unsigned int StackSize = 5;
+const uint32_t FILE_PRINT_SPIN_TIME = 2000;				// Maximum time in microseconds we spend reading from a file being printed in one call to Spin
 
 const char feedrateLetter = 'F';						// GCode feedrate
 const char extrudeLetter = 'E'; 						// GCode extrude
@@ -67,7 +70,7 @@ public:
 	GCodeBuffer *gb;									// this may be null when executing config.g
 	float feedrate;
 	FileData fileState;
-	bool drivesRelative;
+	bool drivesRelative;								// modal state of gb
 	bool axesRelative;
 	bool doingFileMacro;
 };
@@ -144,6 +147,8 @@ public:
 private:
   
     void StartNextGCode(StringRef& reply);								// Fetch a new GCode and process it
+    void RunConcurrentGCodes(StringRef& reply);							// Run codes that needn't wait for other sources
+    bool DoConcurrentGCode(GCodeBuffer *gb, StringRef& reply);			// Run a code out of turn if it allows that
     void DoFilePrint(GCodeBuffer* gb, StringRef& reply);				// Get G Codes from a file and print them
     bool AllMovesAreFinishedAndMoveBufferIsLoaded();					// Wait for move queue to exhaust and the current position is loaded
     bool DoCannedCycleMove(EndstopChecks ce);							// Do a move from an internally programmed canned cycle
@@ -153,6 +158,8 @@ private:
     bool HandleMcode(GCodeBuffer* gb, StringRef& reply);				// Do an M code
     bool HandleTcode(GCodeBuffer* gb, StringRef& reply);				// Do a T code
     void CancelPrint();													// Cancel the current print
+    void StartPrintIndexer();											// Index the file being printed if it hasn't got an index yet
+    bool ResumeFromLayer(int layer, StringRef& reply);					// Set up the selected file to be printed from the start of a layer
     int SetUpMove(GCodeBuffer* gb, StringRef& reply);					// Pass a move on to the Move module
     bool DoDwell(GCodeBuffer *gb);										// Wait for a bit
     bool DoDwellTime(float dwell);										// Really wait for a bit
@@ -202,6 +209,9 @@ private:
 #endif
     GCodeBuffer* fileGCode;						// ...
     GCodeBuffer* serialGCode;					// ...
+    SerialLineQueue* serialQueue;				// receive queue for the windowed protocol on the USB interface
+    CommandProfiler* profiler;					// execution statistics for M123 and M408 S6
+    GCodeIndexer* printIndexer;					// builds the layer index of files that are printed before they have one
     GCodeBuffer* auxGCode;						// this one is for the LCD display on the async serial interface
     GCodeBuffer* fileMacroGCode;				// ...
     GCodeBuffer *gbCurrent;
@@ -215,13 +225,10 @@ private:
     float savedMoveBuffer[DRIVES + 1];			// The position and feedrate when we started the current simulation
     float pausedMoveBuffer[DRIVES + 1]; 		// Move coordinates; last is feed rate
     GCodeState state;							// The main state variable of the GCode state machine
-	bool drivesRelative;
-	bool axesRelative;
     GCodeMachineState stack[StackSize];			// State that we save when calling macro files
     unsigned int stackPointer;					// Push and Pop stack pointer
     static const char axisLetters[AXES]; 		// 'X', 'Y', 'Z'
 	float axisScaleFactors[AXES];				// Scale XYZ coordinates by this factor (for Delta configurations)
-    float lastRawExtruderPosition[DRIVES - AXES];	// Extruder position of the last move fed into the Move class
     float rawExtruderTotalByDrive[DRIVES - AXES];	// Total extrusion amount fed to Move class since starting print, before applying extrusion factor, per drive
     float rawExtruderTotal;						// Total extrusion amount fed to Move class since starting print, before applying extrusion factor, summed over all drives
 	float record[DRIVES+1];						// Temporary store for move positions
@@ -291,7 +298,7 @@ inline bool GCodes::HaveIncomingData() const
 #if defined(LCD_UI)
 inline bool GCodes::DrivesRelative() const
 {
-	return drivesRelative;
+	return lcdGCode->DrivesRelative();
 }
 #endif
 
@@ -0,0 +1,106 @@
+/*
+ * IoStatistics.cpp
+ *
+ * Latency histograms of the SD card operations, see IoStatistics.h
+ */
+
+//*************************************************************************************
+
+#include "RepRapFirmware.h"
+
+// Upper limits of the latency bands in microseconds
+const uint32_t IoStatistics::bandLimits[IO_HISTOGRAM_BANDS - 1] =
+	{ 100, 200, 500, 1000, 2000, 5000, 10000, 20000, 50000, 100000, 200000, 500000 };
+
+const char * const IoStatistics::operationNames[numIoOperations] = { "read", "write", "open", "sync", "directory" };
+
+IoStatistics::IoStatistics(Platform* p) : platform(p)
+{
+	Init();
+}
+
+void IoStatistics::Init()
+{
+	memset(stats, 0, sizeof(stats));
+	resetTime = millis();
+}
+
+void IoStatistics::Record(IoOperation op, uint32_t startTime, size_t bytes)
+{
+	const uint32_t elapsed = micros() - startTime;
+	size_t band = 0;
+	while (band < ARRAY_SIZE(bandLimits) && elapsed >= bandLimits[band])
+	{
+		++band;
+	}
+
+	OperationStats& s = stats[op];
+	++s.count;
+	s.bytes += bytes;
+	s.totalTime += elapsed;
+	s.maxTime = max<uint32_t>(s.maxTime, elapsed);
+	++s.bands[band];
+}
+
+void IoStatistics::Diagnostics()
+{
+	platform->MessageF(GENERIC_MESSAGE, "SD card latencies over the last %lu seconds:\n", (millis() - resetTime)/1000);
+	for (size_t op = 0; op < numIoOperations; op++)
+	{
+		const OperationStats& s = stats[op];
+		if (s.count == 0)
+		{
+			continue;
+		}
+
+		platform->MessageF(GENERIC_MESSAGE, "%s: %lu calls, %lu bytes, avg %.2fms, max %.2fms,", operationNames[op], s.count, (uint32_t)s.bytes,
+							(float)s.totalTime/(1000.0 * s.count), (float)s.maxTime/1000.0);
+		for (size_t band = 0; band < IO_HISTOGRAM_BANDS; band++)
+		{
+			if (s.bands[band] != 0)
+			{
+				if (band < ARRAY_SIZE(bandLimits))
+				{
+					platform->MessageF(GENERIC_MESSAGE, " <%.1fms %lu", (float)bandLimits[band]/1000.0, s.bands[band]);
+				}
+				else
+				{
+					platform->MessageF(GENERIC_MESSAGE, " >=%.1fms %lu", (float)bandLimits[ARRAY_UPB(bandLimits)]/1000.0, s.bands[band]);
+				}
+			}
+		}
+		platform->Message(GENERIC_MESSAGE, "\n");
+	}
+}
+
+OutputBuffer *IoStatistics::GetJsonResponse()
+{
+	OutputBuffer *response;
+	if (!OutputBuffer::Allocate(response))
+	{
+		return nullptr;
+	}
+
+	response->printf("{\"io\":{\"seconds\":%lu,\"limits\":[", (millis() - resetTime)/1000);
+	for (size_t band = 0; band < ARRAY_SIZE(bandLimits); band++)
+	{
+		response->catf((band == 0) ? "%lu" : ",%lu", bandLimits[band]);
+	}
+	response->cat("]");
+
+	for (size_t op = 0; op < numIoOperations; op++)
+	{
+		const OperationStats& s = stats[op];
+		response->catf(",\"%s\":{\"count\":%lu,\"bytes\":%lu,\"avg\":%lu,\"max\":%lu,\"hist\":[", operationNames[op], s.count, (uint32_t)s.bytes,
+						(s.count == 0) ? 0 : (uint32_t)(s.totalTime / s.count), s.maxTime);
+		for (size_t band = 0; band < IO_HISTOGRAM_BANDS; band++)
+		{
+			response->catf((band == 0) ? "%lu" : ",%lu", s.bands[band]);
+		}
+		response->cat("]}");
+	}
+	response->cat("}}");
+	return response;
+}
+
+// End
@@ -0,0 +1,52 @@
+/*
+ * IoStatistics.h
+ *
+ * Latency histograms of the SD card operations. For reads, writes, opens, syncs and directory listings we count
+ * the calls, the bytes transferred, the total and longest time, and how many calls fell into each latency band.
+ * They are reported by M122 and in JSON format by M408 S7, so that a slow or worn card can be shown to be the
+ * cause of stuttering prints.
+ */
+
+#ifndef IOSTATISTICS_H_
+#define IOSTATISTICS_H_
+
+enum IoOperation : uint8_t
+{
+	ioRead = 0,
+	ioWrite,
+	ioOpen,
+	ioSync,
+	ioDirectory,
+	numIoOperations
+};
+
+const size_t IO_HISTOGRAM_BANDS = 13;					// The last band collects everything above the highest limit
+
+class IoStatistics
+{
+  public:
+	IoStatistics(Platform* p);
+	void Init();										// Discard all the statistics
+	void Record(IoOperation op, uint32_t startTime, size_t bytes = 0);	// Record an operation that started at startTime (from micros())
+	void Diagnostics();									// Print the histograms for M122
+	OutputBuffer *GetJsonResponse();					// Get the histograms in JSON format for M408 S7
+
+  private:
+	struct OperationStats
+	{
+		uint32_t count;
+		uint64_t bytes;
+		uint64_t totalTime;								// Times are in microseconds
+		uint32_t maxTime;
+		uint32_t bands[IO_HISTOGRAM_BANDS];
+	};
+
+	static const uint32_t bandLimits[IO_HISTOGRAM_BANDS - 1];
+	static const char * const operationNames[numIoOperations];
+
+	Platform* platform;
+	OperationStats stats[numIoOperations];
+	uint32_t resetTime;									// millis() when the statistics were last cleared
+};
+
+#endif /* IOSTATISTICS_H_ */
@@ -0,0 +1,228 @@
+/*
+ * JsonWriter.cpp
+ *
+ * Fast JSON output into OutputBuffer chains, see JsonWriter.h
+ */
+
+#include "RepRapFirmware.h"
+
+static const double powersOfTen[JsonWriter::maxDecimals + 1] = { 1.0, 10.0, 100.0, 1000.0, 10000.0, 100000.0, 1000000.0 };
+
+/*static*/ size_t JsonWriter::FormatUInt(char *s, uint32_t value)
+{
+	char digits[10];
+	size_t numDigits = 0;
+	do
+	{
+		digits[numDigits++] = '0' + (value % 10);
+		value /= 10;
+	} while (value != 0);
+
+	for (size_t i = 0; i < numDigits; i++)
+	{
+		s[i] = digits[numDigits - 1 - i];
+	}
+	return numDigits;
+}
+
+/*static*/ size_t JsonWriter::FormatInt(char *s, int32_t value)
+{
+	if (value < 0)
+	{
+		*s = '-';
+		return 1 + FormatUInt(s + 1, -(uint32_t)value);
+	}
+	return FormatUInt(s, (uint32_t)value);
+}
+
+// Round to the requested number of decimal places and print the digits of the resulting integer with a decimal point
+// inserted. A float times a power of ten up to 10^6 is exact in double precision, so we can round exact ties to even
+// and get the same digits as %f. Values that don't fit in 32 bits once scaled, as well as NaN and infinity, are rare
+// enough to leave to snprintf.
+/*static*/ size_t JsonWriter::FormatFloat(char *s, float value, uint8_t decimals)
+{
+	decimals = min<uint8_t>(decimals, maxDecimals);
+	const double scaled = fabs((double)value) * powersOfTen[decimals];
+	if (!(scaled < 4294967295.0))
+	{
+		const int length = snprintf(s, maxNumberLength, "%.*f", decimals, (double)value);
+		return (length < 0) ? 0 : min<size_t>(length, maxNumberLength - 1);
+	}
+
+	uint32_t n = (uint32_t)scaled;
+	const double remainder = scaled - n;
+	if (remainder > 0.5 || (remainder == 0.5 && (n & 1) != 0))
+	{
+		++n;
+	}
+	size_t length = 0;
+	if (value < 0.0 && n != 0)
+	{
+		s[length++] = '-';
+	}
+
+	char digits[12];
+	size_t numDigits = 0;
+	do
+	{
+		digits[numDigits++] = '0' + (n % 10);
+		n /= 10;
+	} while (n != 0 || numDigits <= decimals);		// we need at least one digit before the decimal point
+
+	while (numDigits > decimals)
+	{
+		s[length++] = digits[--numDigits];
+	}
+	if (decimals != 0)
+	{
+		s[length++] = '.';
+		while (numDigits != 0)
+		{
+			s[length++] = digits[--numDigits];
+		}
+	}
+	return length;
+}
+
+// Write the separator and the key of a new member into 'item' and return its length
+size_t JsonWriter::Prefix(char *item, const char *key)
+{
+	size_t length = 0;
+	const uint32_t levelBit = 1u << depth;
+	if ((hasMembers & levelBit) != 0)
+	{
+		item[length++] = ',';
+	}
+	hasMembers |= levelBit;
+
+	if (key != nullptr)
+	{
+		item[length++] = '"';
+		const size_t keyLength = strlen(key);
+		if (keyLength > maxInlineKeyLength)
+		{
+			buf->cat(item, length);
+			buf->cat(key, keyLength);
+			length = 0;
+		}
+		else
+		{
+			memcpy(item + length, key, keyLength);
+			length += keyLength;
+		}
+		item[length++] = '"';
+		item[length++] = ':';
+	}
+	return length;
+}
+
+void JsonWriter::Start(const char *key, char bracket)
+{
+	char item[maxItemLength];
+	size_t length = Prefix(item, key);
+	item[length++] = bracket;
+	buf->cat(item, length);
+
+	if (depth < maxDepth)
+	{
+		++depth;
+		hasMembers &= ~(1u << depth);
+	}
+}
+
+void JsonWriter::End(char bracket)
+{
+	buf->cat(bracket);
+	if (depth != 0)
+	{
+		--depth;
+	}
+}
+
+void JsonWriter::StartObject(const char *key)
+{
+	Start(key, '{');
+}
+
+void JsonWriter::EndObject()
+{
+	End('}');
+}
+
+void JsonWriter::StartArray(const char *key)
+{
+	Start(key, '[');
+}
+
+void JsonWriter::EndArray()
+{
+	End(']');
+}
+
+void JsonWriter::Int(const char *key, int32_t value)
+{
+	char item[maxItemLength];
+	size_t length = Prefix(item, key);
+	length += FormatInt(item + length, value);
+	buf->cat(item, length);
+}
+
+void JsonWriter::UInt(const char *key, uint32_t value)
+{
+	char item[maxItemLength];
+	size_t length = Prefix(item, key);
+	length += FormatUInt(item + length, value);
+	buf->cat(item, length);
+}
+
+void JsonWriter::Float(const char *key, float value, uint8_t decimals)
+{
+	char item[maxItemLength];
+	size_t length = Prefix(item, key);
+	length += FormatFloat(item + length, value, decimals);
+	buf->cat(item, length);
+}
+
+void JsonWriter::String(const char *key, const char *value, size_t maxLength)
+{
+	char item[maxItemLength];
+	size_t length = Prefix(item, key);
+	item[length++] = '"';
+	buf->cat(item, length);
+	WriteEscaped(value, maxLength);
+	buf->cat('"');
+}
+
+void JsonWriter::Key(const char *key)
+{
+	char item[maxItemLength];
+	const size_t length = Prefix(item, key);
+	buf->cat(item, length);
+}
+
+// Append a string with quotes and backslashes escaped. Runs of characters that need no escaping are appended in one go.
+// Like OutputBuffer::EncodeString we stop at the first control character.
+void JsonWriter::WriteEscaped(const char *s, size_t maxLength)
+{
+	size_t runStart = 0;
+	for (size_t i = 0; ; i++)
+	{
+		const uint8_t c = (i < maxLength) ? (uint8_t)s[i] : 0;
+		if (c < ' ' || c == '"' || c == '\\')
+		{
+			if (i != runStart)
+			{
+				buf->cat(s + runStart, i - runStart);
+			}
+			if (c < ' ')
+			{
+				break;
+			}
+			buf->cat('\\');
+			buf->cat((char)c);
+			runStart = i + 1;
+		}
+	}
+}
+
+// End
@@ -0,0 +1,55 @@
+/*
+ * JsonWriter.h
+ *
+ * Writes JSON straight into a chain of OutputBuffers. Numbers are formatted with our own integer and fixed-precision
+ * float routines instead of going through vsnprintf, and the commas between members and elements are inserted
+ * automatically. Each member is assembled in a small buffer on the stack and appended with a single cat() call, so
+ * a response needs neither the FORMAT_STRING_LENGTH buffer of catf() nor the stack that the newlib float printf uses.
+ *
+ * Pass nullptr as the key when writing the elements of an array.
+ */
+
+#ifndef JSONWRITER_H_
+#define JSONWRITER_H_
+
+class JsonWriter
+{
+  public:
+	JsonWriter(OutputBuffer *buf) : buf(buf), depth(0), hasMembers(0) { }
+
+	void StartObject(const char *key = nullptr);
+	void EndObject();
+	void StartArray(const char *key = nullptr);
+	void EndArray();
+
+	void Int(const char *key, int32_t value);
+	void UInt(const char *key, uint32_t value);
+	void Float(const char *key, float value, uint8_t decimals);		// like %.<decimals>f
+	void String(const char *key, const char *value, size_t maxLength = 0xFFFF);	// escaped, stops at the first control character
+	void Key(const char *key);										// for values that the caller writes to the buffer itself
+
+	OutputBuffer *GetBuffer() const { return buf; }
+
+	static size_t FormatUInt(char *s, uint32_t value);
+	static size_t FormatInt(char *s, int32_t value);
+	static size_t FormatFloat(char *s, float value, uint8_t decimals);	// s must have room for maxNumberLength characters
+
+	static const size_t maxNumberLength = 48;						// long enough for %.4f of the largest float
+	static const uint8_t maxDecimals = 6;
+
+  private:
+	static const size_t maxItemLength = 80;
+	static const size_t maxInlineKeyLength = maxItemLength - maxNumberLength - 5;
+	static const uint8_t maxDepth = 31;
+
+	size_t Prefix(char *item, const char *key);
+	void Start(const char *key, char bracket);
+	void End(char bracket);
+	void WriteEscaped(const char *s, size_t maxLength);
+
+	OutputBuffer *buf;
+	uint8_t depth;
+	uint32_t hasMembers;											// bit N is set once the container at depth N has a member
+};
+
+#endif /* JSONWRITER_H_ */
@@ -0,0 +1,349 @@
+/*
+ * In-memory network interface for host builds
+ *
+ * This replaces ethernet_sam.c, ethernetif.c and ethernet_phy.c when the network code is built on a POSIX host
+ * with -DLWIP_HOST_NETIF. It implements the functions of ethernet_sam.h on top of an lwIP netif whose other end
+ * is a pair of frame queues instead of the EMAC, so that a test client on the same host can talk to Network.cpp,
+ * Webserver.cpp and the bundled lwIP with Ethernet frames, and their performance can be measured on Linux.
+ *
+ * The receive queue is sized like the SAM3X EMAC driver's receive buffers (16 buffers of 128 bytes), and frames
+ * are copied into pbufs from the pool just like ethernetif.c does, so the firmware drops frames under the same
+ * conditions as it does on a Duet. The registered RX callback is called for every frame the client sends, as the
+ * EMAC interrupt would do.
+ */
+
+#ifdef LWIP_HOST_NETIF
+
+#include <string.h>
+
+#include "ethernet_sam.h"
+#include "ethernet_host.h"
+
+#include "lwip/src/include/lwip/tcp.h"
+#include "lwip/src/include/lwip/dhcp.h"
+#include "lwip/src/include/lwip/stats.h"
+#include "lwip/src/include/lwip/init.h"
+#include "lwip/src/include/ipv4/lwip/ip_frag.h"
+#include "lwip/src/include/lwip/tcp_impl.h"
+#include "lwip/src/include/netif/etharp.h"
+
+extern uint32_t millis(void);
+
+#define NET_MTU					1500
+#define NET_RW_BUFF_SIZE		1536
+
+#define RX_UNIT_SIZE			128			// the EMAC stores received frames in units of this size
+#define RX_UNITS				16
+#define FRAME_QUEUE_LENGTH		64			// frames sent by the firmware that the client hasn't collected yet
+
+struct frame_queue {
+	uint8_t data[FRAME_QUEUE_LENGTH][NET_RW_BUFF_SIZE];
+	uint16_t length[FRAME_QUEUE_LENGTH];
+	size_t head, count;
+};
+
+static struct frame_queue rx_queue, tx_queue;
+static size_t rx_units_used;
+static bool link_up = true;
+static ethernet_rx_callback_t rx_callback;
+static EthernetHostStats stats;
+static uint8_t mac_address[6] = { 0xBE, 0xEF, 0xDE, 0xAD, 0xFE, 0xED };
+
+struct netif gs_net_if;
+
+/* Timer for calling lwIP tmr functions without system, as in ethernet_sam.c */
+typedef struct timers_info {
+	uint32_t timer;
+	uint32_t timer_interval;
+	void (*timer_func)(void);
+} timers_info_t;
+
+static timers_info_t gs_timers_table[] = {
+	{0, TCP_TMR_INTERVAL, tcp_tmr},
+	{0, IP_TMR_INTERVAL, ip_reass_tmr},
+	{0, ARP_TMR_INTERVAL, etharp_tmr},
+#if LWIP_DHCP
+	{0, DHCP_COARSE_TIMER_SECS, dhcp_coarse_tmr},
+	{0, DHCP_FINE_TIMER_MSECS, dhcp_fine_tmr},
+#endif
+};
+
+static size_t rx_units(size_t length)
+{
+	return (length + RX_UNIT_SIZE - 1) / RX_UNIT_SIZE;
+}
+
+static bool queue_put(struct frame_queue *q, const uint8_t *frame, size_t length)
+{
+	if (q->count == FRAME_QUEUE_LENGTH || length > NET_RW_BUFF_SIZE)
+	{
+		return false;
+	}
+	const size_t slot = (q->head + q->count) % FRAME_QUEUE_LENGTH;
+	memcpy(q->data[slot], frame, length);
+	q->length[slot] = length;
+	++q->count;
+	return true;
+}
+
+static err_t low_level_output(struct netif *netif, struct pbuf *p)
+{
+	uint8_t buf[NET_RW_BUFF_SIZE];
+
+#if ETH_PAD_SIZE
+	pbuf_header(p, -ETH_PAD_SIZE);		/* Drop the padding word */
+#endif
+
+	const size_t length = pbuf_copy_partial(p, buf, sizeof(buf), 0);
+	const bool ok = (p->tot_len <= sizeof(buf)) && queue_put(&tx_queue, buf, length);
+
+#if ETH_PAD_SIZE
+	pbuf_header(p, ETH_PAD_SIZE);		/* Reclaim the padding word */
+#endif
+
+	if (!ok)
+	{
+		++stats.txOverruns;
+		return ERR_BUF;
+	}
+	++stats.framesOut;
+	stats.bytesOut += length;
+	LINK_STATS_INC(link.xmit);
+	return ERR_OK;
+}
+
+// Move the oldest received frame into a pbuf and give it to lwIP. Returns false if there was none.
+static bool low_level_input(struct netif *netif)
+{
+	if (rx_queue.count == 0)
+	{
+		return false;
+	}
+
+	const uint8_t *frame = rx_queue.data[rx_queue.head];
+	const size_t length = rx_queue.length[rx_queue.head];
+	struct pbuf *p = pbuf_alloc(PBUF_RAW, length + ETH_PAD_SIZE, PBUF_POOL);
+	if (p != NULL)
+	{
+#if ETH_PAD_SIZE
+		pbuf_header(p, -ETH_PAD_SIZE);	/* drop the padding word */
+#endif
+		pbuf_take(p, frame, length);
+#if ETH_PAD_SIZE
+		pbuf_header(p, ETH_PAD_SIZE);	/* reclaim the padding word */
+#endif
+		LINK_STATS_INC(link.recv);
+		++stats.framesIn;
+		stats.bytesIn += length;
+	}
+	else
+	{
+		LINK_STATS_INC(link.memerr);
+		LINK_STATS_INC(link.drop);
+		++stats.rxNoPbuf;
+	}
+
+	rx_queue.head = (rx_queue.head + 1) % FRAME_QUEUE_LENGTH;
+	--rx_queue.count;
+	rx_units_used -= rx_units(length);
+
+	if (p != NULL && netif->input(p, netif) != ERR_OK)
+	{
+		pbuf_free(p);
+	}
+	return true;
+}
+
+static err_t ethernetif_init(struct netif *netif)
+{
+	netif->state = NULL;
+	netif->name[0] = 'h';
+	netif->name[1] = 'n';
+	netif->output = etharp_output;
+	netif->linkoutput = low_level_output;
+	netif->hwaddr_len = sizeof(mac_address);
+	memcpy(netif->hwaddr, mac_address, sizeof(mac_address));
+	netif->mtu = NET_MTU;
+	netif->flags |= NETIF_FLAG_BROADCAST | NETIF_FLAG_ETHARP
+#if LWIP_IGMP
+			| NETIF_FLAG_IGMP
+#endif
+	;
+	return ERR_OK;
+}
+
+int ethernet_host_send(const uint8_t *frame, size_t length)
+{
+	if (!link_up || rx_units_used + rx_units(length) > RX_UNITS || !queue_put(&rx_queue, frame, length))
+	{
+		++stats.rxOverruns;
+		return -1;
+	}
+	rx_units_used += rx_units(length);
+	if (rx_callback != NULL)
+	{
+		rx_callback(0);
+	}
+	return 0;
+}
+
+size_t ethernet_host_receive(uint8_t *frame, size_t size)
+{
+	if (tx_queue.count == 0)
+	{
+		return 0;
+	}
+	size_t length = tx_queue.length[tx_queue.head];
+	if (length > size)
+	{
+		length = size;
+	}
+	memcpy(frame, tx_queue.data[tx_queue.head], length);
+	tx_queue.head = (tx_queue.head + 1) % FRAME_QUEUE_LENGTH;
+	--tx_queue.count;
+	return length;
+}
+
+void ethernet_host_set_link(int up)
+{
+	link_up = (up != 0);
+}
+
+void ethernet_host_get_stats(EthernetHostStats *s, int clear)
+{
+	*s = stats;
+	if (clear)
+	{
+		memset(&stats, 0, sizeof(stats));
+	}
+}
+
+/* Functions of ethernet_sam.h */
+
+void ethernet_timers_update(void)
+{
+	static uint32_t ul_last_time;
+	const uint32_t ul_cur_time = millis();
+	const uint32_t ul_time_diff = ul_cur_time - ul_last_time;
+
+	if (ul_time_diff)
+	{
+		ul_last_time = ul_cur_time;
+		for (size_t i = 0; i < sizeof(gs_timers_table) / sizeof(timers_info_t); i++)
+		{
+			timers_info_t * const p_tmr_inf = &gs_timers_table[i];
+			p_tmr_inf->timer += ul_time_diff;
+			if (p_tmr_inf->timer > p_tmr_inf->timer_interval)
+			{
+				p_tmr_inf->timer_func();
+				p_tmr_inf->timer -= p_tmr_inf->timer_interval;
+			}
+		}
+	}
+}
+
+void start_ethernet(const uint8_t ipAddress[], const uint8_t netMask[], const uint8_t gateWay[], netif_status_callback_fn status_cb)
+{
+	struct ip_addr x_ip_addr, x_net_mask, x_gateway;
+
+	IP4_ADDR(&x_ip_addr, ipAddress[0], ipAddress[1], ipAddress[2], ipAddress[3]);
+	if (x_ip_addr.addr == 0)
+	{
+		x_net_mask.addr = 0;
+		x_gateway.addr = 0;
+	}
+	else
+	{
+		IP4_ADDR(&x_net_mask, netMask[0], netMask[1], netMask[2], netMask[3]);
+		IP4_ADDR(&x_gateway, gateWay[0], gateWay[1], gateWay[2], gateWay[3]);
+	}
+
+	netif_add(&gs_net_if, &x_ip_addr, &x_net_mask, &x_gateway, NULL, ethernetif_init, ethernet_input);
+	netif_set_default(&gs_net_if);
+	netif_set_status_callback(&gs_net_if, status_cb);
+	if (x_ip_addr.addr == 0)
+	{
+		dhcp_start(&gs_net_if);
+	}
+	else
+	{
+		netif_set_up(&gs_net_if);
+	}
+}
+
+void ethernet_set_configuration(const uint8_t ipAddress[], const uint8_t netMask[], const uint8_t gateWay[])
+{
+	if ((gs_net_if.flags & NETIF_FLAG_DHCP) != 0)
+	{
+		dhcp_stop(&gs_net_if);
+	}
+
+	struct ip_addr x_ip_addr, x_net_mask, x_gateway;
+	IP4_ADDR(&x_ip_addr, ipAddress[0], ipAddress[1], ipAddress[2], ipAddress[3]);
+	IP4_ADDR(&x_net_mask, netMask[0], netMask[1], netMask[2], netMask[3]);
+	IP4_ADDR(&x_gateway, gateWay[0], gateWay[1], gateWay[2], gateWay[3]);
+
+	if (x_ip_addr.addr == 0)
+	{
+		dhcp_start(&gs_net_if);
+	}
+	else
+	{
+		netif_set_ipaddr(&gs_net_if, &x_ip_addr);
+		netif_set_netmask(&gs_net_if, &x_net_mask);
+		netif_set_gw(&gs_net_if, &x_gateway);
+		netif_set_up(&gs_net_if);
+	}
+}
+
+void init_ethernet()
+{
+	memset(&rx_queue, 0, sizeof(rx_queue));
+	memset(&tx_queue, 0, sizeof(tx_queue));
+	rx_units_used = 0;
+	lwip_init();
+}
+
+void ethernet_configure_interface(const u8_t macAddress[], const char *hostname)
+{
+	memcpy(mac_address, macAddress, sizeof(mac_address));
+	netif_set_hostname(&gs_net_if, hostname);
+}
+
+bool ethernet_establish_link(void)
+{
+	return link_up;
+}
+
+bool ethernet_link_established(void)
+{
+	if (!link_up)
+	{
+		netif_set_down(&gs_net_if);
+		return false;
+	}
+	return true;
+}
+
+void ethernet_task(void)
+{
+	while (low_level_input(&gs_net_if)) { }
+	ethernet_timers_update();
+}
+
+void ethernet_set_rx_callback(ethernet_rx_callback_t callback)
+{
+	rx_callback = callback;
+}
+
+const uint8_t *ethernet_get_ipaddress()
+{
+	return (uint8_t*)&gs_net_if.ip_addr.addr;
+}
+
+u32_t sys_now(void)
+{
+	return millis();
+}
+
+#endif /* LWIP_HOST_NETIF */
@@ -0,0 +1,45 @@
+/*
+ * In-memory network interface for host builds, see ethernet_host.c
+ */
+
+#ifndef ETHERNET_HOST_H_INCLUDED
+#define ETHERNET_HOST_H_INCLUDED
+
+#ifdef LWIP_HOST_NETIF
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Frame counters for both directions of the in-memory link
+typedef struct {
+	uint32_t framesIn;				// frames from the test client that reached lwIP
+	uint32_t bytesIn;
+	uint32_t framesOut;				// frames sent by lwIP
+	uint32_t bytesOut;
+	uint32_t rxOverruns;			// frames dropped because the receive buffers were full
+	uint32_t rxNoPbuf;				// frames dropped because the pbuf pool was empty
+	uint32_t txOverruns;			// frames dropped because the test client didn't collect them
+} EthernetHostStats;
+
+// Hand a frame from the test client to the firmware. Returns 0 on success, -1 if it was dropped.
+int ethernet_host_send(const uint8_t *frame, size_t length);
+
+// Take the next frame that the firmware has sent. Returns its length, or 0 if there are none.
+size_t ethernet_host_receive(uint8_t *frame, size_t size);
+
+// Plug or unplug the cable
+void ethernet_host_set_link(int up);
+
+void ethernet_host_get_stats(EthernetHostStats *stats, int clear);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LWIP_HOST_NETIF */
+
+#endif /* ETHERNET_HOST_H_INCLUDED */
@@ -43,6 +43,8 @@
  *
  */
 
+#ifndef LWIP_HOST_NETIF		// host builds use ethernet_host.c instead
+
 #include "ethernet_phy.h"
 #include "rmii.h"
 
@@ -522,3 +524,5 @@ uint8_t ethernet_phy_reset(Emac *p_emac, uint8_t uc_phy_addr)
 /**
  * \}
  */
+
+#endif /* LWIP_HOST_NETIF */
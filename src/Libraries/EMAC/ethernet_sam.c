@@ -41,6 +41,8 @@
  *
  */
 
+#ifndef LWIP_HOST_NETIF		// host builds use ethernet_host.c instead
+
 #include <string.h>
 //#include "board.h"
 //#include "gpio.h"
@@ -265,7 +267,7 @@ void ethernet_task(void)
  *
  * \param callback The callback to be called when a new packet is ready
  */
-void ethernet_set_rx_callback(emac_dev_tx_cb_t callback)
+void ethernet_set_rx_callback(ethernet_rx_callback_t callback)
 {
 	ethernetif_set_rx_callback(callback);
 }
@@ -277,3 +279,5 @@ const uint8_t *ethernet_get_ipaddress()
 {
 	return (uint8_t*)&gs_net_if.ip_addr.addr;
 }
+
+#endif /* LWIP_HOST_NETIF */
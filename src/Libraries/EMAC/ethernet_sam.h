@@ -44,8 +44,16 @@
 #ifndef ETHERNET_SAM_H_INCLUDED
 #define ETHERNET_SAM_H_INCLUDED
 
+#include <stdbool.h>
+#include <stdint.h>
+
 #include "lwip/src/include/lwip/netif.h"
-#include "emac.h"							// for emac_dev_tx_cb_t
+
+// This is the only interface between the Network class and the network driver, so it must not depend on the SAM headers.
+// A different implementation of these functions (e.g. one with an in-memory netif) can be linked in instead of the EMAC driver.
+
+// Called when a new packet is ready, same as emac_dev_tx_cb_t
+typedef void (*ethernet_rx_callback_t)(uint32_t ul_status);
 
 /// @cond 0
 /**INDENT-OFF**/
@@ -81,7 +89,7 @@ void ethernet_timers_update(void);
 void ethernet_task(void);
 
 // Set the RX callback for incoming network packets
-void ethernet_set_rx_callback(emac_dev_tx_cb_t callback);
+void ethernet_set_rx_callback(ethernet_rx_callback_t callback);
 
 // Returns the network interface's current IPv4 address
 const uint8_t *ethernet_get_ipaddress();
@@ -45,6 +45,8 @@
  *
  */
 
+#ifndef LWIP_HOST_NETIF		// host builds use ethernet_host.c instead
+
 #include "lwip/src/include/lwip/opt.h"
 #include "lwip/src/include/lwip/def.h"
 #include "lwip/src/include/lwip/mem.h"
@@ -490,3 +492,5 @@ u32_t sys_now(void)
 {
 	return millis();
 }
+
+#endif /* LWIP_HOST_NETIF */
@@ -40,6 +40,8 @@
  * \asf_license_stop
  *
  */
+#ifndef FATFS_HOST_DISK		// host builds use diskio_host.c instead
+
 /// @cond 0
 /**INDENT-OFF**/
 #ifdef __cplusplus
@@ -334,3 +336,5 @@ DRESULT disk_ioctl(BYTE drv, BYTE ctrl, void *buff)
 #endif
 /**INDENT-ON**/
 /// @endcond
+
+#endif /* FATFS_HOST_DISK */
@@ -0,0 +1,198 @@
+/*-----------------------------------------------------------------------
+/  Host disk I/O module for FatFs
+/
+/  This replaces diskio.c when the firmware's storage code is built on a
+/  POSIX host with -DFATFS_HOST_DISK. Drive 0 is backed by a FAT image
+/  file, and an optional delay per command and per sector can be injected
+/  to approximate the timings of a real SD card, so that MassStorage,
+/  FileStore and the upload and file info code can be benchmarked and
+/  regression-tested on Linux.
+/
+/  The image can be selected with disk_host_open() or with the
+/  FATFS_HOST_IMAGE environment variable, which is read when FatFs first
+/  initialises the drive. The latencies can also be set with the
+/  FATFS_HOST_READ_LATENCY and FATFS_HOST_WRITE_LATENCY variables, each
+/  given as "<us per command>,<us per sector>".
+/-----------------------------------------------------------------------*/
+
+#ifdef FATFS_HOST_DISK
+
+#include "diskio.h"
+#include "diskio_host.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#define SECTOR_SIZE 512
+
+static int imageFd = -1;
+static DWORD imageSectors = 0;
+static uint32_t readCommandLatency = 0, readSectorLatency = 0;
+static uint32_t writeCommandLatency = 0, writeSectorLatency = 0;
+static DiskHostStats stats;
+
+static void parse_latency(const char *name, uint32_t *commandUs, uint32_t *sectorUs)
+{
+	const char *value = getenv(name);
+	if (value != NULL) {
+		char *end;
+		*commandUs = (uint32_t)strtoul(value, &end, 10);
+		*sectorUs = (*end == ',') ? (uint32_t)strtoul(end + 1, NULL, 10) : 0;
+	}
+}
+
+static void delay_us(uint32_t us)
+{
+	if (us != 0) {
+		struct timespec ts;
+		ts.tv_sec = us / 1000000;
+		ts.tv_nsec = (long)(us % 1000000) * 1000;
+		while (nanosleep(&ts, &ts) != 0) { }
+		stats.latencyUs += us;
+	}
+}
+
+int disk_host_open(const char *imageFile)
+{
+	struct stat st;
+
+	disk_host_close();
+	imageFd = open(imageFile, O_RDWR);
+	if (imageFd < 0) {
+		return -1;
+	}
+	if (fstat(imageFd, &st) != 0 || st.st_size < SECTOR_SIZE) {
+		disk_host_close();
+		return -1;
+	}
+	imageSectors = (DWORD)(st.st_size / SECTOR_SIZE);
+	return 0;
+}
+
+void disk_host_close(void)
+{
+	if (imageFd >= 0) {
+		close(imageFd);
+		imageFd = -1;
+	}
+	imageSectors = 0;
+}
+
+void disk_host_set_latency(uint32_t readCommandUs, uint32_t readSectorUs, uint32_t writeCommandUs, uint32_t writeSectorUs)
+{
+	readCommandLatency = readCommandUs;
+	readSectorLatency = readSectorUs;
+	writeCommandLatency = writeCommandUs;
+	writeSectorLatency = writeSectorUs;
+}
+
+void disk_host_get_stats(DiskHostStats *s, int clear)
+{
+	*s = stats;
+	if (clear) {
+		memset(&stats, 0, sizeof(stats));
+	}
+}
+
+DSTATUS disk_initialize(BYTE drv)
+{
+	if (drv != 0) {
+		return STA_NOINIT;
+	}
+	if (imageFd < 0) {
+		const char *imageFile = getenv("FATFS_HOST_IMAGE");
+		if (imageFile == NULL || disk_host_open(imageFile) != 0) {
+			return STA_NOINIT | STA_NODISK;
+		}
+		parse_latency("FATFS_HOST_READ_LATENCY", &readCommandLatency, &readSectorLatency);
+		parse_latency("FATFS_HOST_WRITE_LATENCY", &writeCommandLatency, &writeSectorLatency);
+	}
+	return 0;
+}
+
+DSTATUS disk_status(BYTE drv)
+{
+	return (drv == 0 && imageFd >= 0) ? 0 : STA_NOINIT | STA_NODISK;
+}
+
+DRESULT disk_read(BYTE drv, BYTE *buff, DWORD sector, BYTE count)
+{
+	const size_t len = (size_t)count * SECTOR_SIZE;
+
+	if (drv != 0 || imageFd < 0) {
+		return RES_NOTRDY;
+	}
+	if (sector + count > imageSectors) {
+		return RES_PARERR;
+	}
+	delay_us(readCommandLatency + count * readSectorLatency);
+	++stats.reads;
+	stats.sectorsRead += count;
+	return (pread(imageFd, buff, len, (off_t)sector * SECTOR_SIZE) == (ssize_t)len) ? RES_OK : RES_ERROR;
+}
+
+#if _READONLY == 0
+DRESULT disk_write(BYTE drv, const BYTE *buff, DWORD sector, BYTE count)
+{
+	const size_t len = (size_t)count * SECTOR_SIZE;
+
+	if (drv != 0 || imageFd < 0) {
+		return RES_NOTRDY;
+	}
+	if (sector + count > imageSectors) {
+		return RES_PARERR;
+	}
+	delay_us(writeCommandLatency + count * writeSectorLatency);
+	++stats.writes;
+	stats.sectorsWritten += count;
+	return (pwrite(imageFd, buff, len, (off_t)sector * SECTOR_SIZE) == (ssize_t)len) ? RES_OK : RES_ERROR;
+}
+#endif /* _READONLY */
+
+DRESULT disk_ioctl(BYTE drv, BYTE ctrl, void *buff)
+{
+	if (drv != 0 || imageFd < 0) {
+		return RES_NOTRDY;
+	}
+
+	switch (ctrl) {
+	case CTRL_SYNC:
+		return RES_OK;			/* pwrite has already handed the data to the host, an fsync would only distort the timings */
+
+	case GET_SECTOR_COUNT:
+		*(DWORD *)buff = imageSectors;
+		return RES_OK;
+
+	case GET_SECTOR_SIZE:
+		*(WORD *)buff = SECTOR_SIZE;
+		return RES_OK;
+
+	case GET_BLOCK_SIZE:
+		*(DWORD *)buff = 1;
+		return RES_OK;
+
+	default:
+		return RES_PARERR;
+	}
+}
+
+/* Replaces fattime_rtc.c, files get the host's local time */
+DWORD get_fattime(void)
+{
+	const time_t now = time(NULL);
+	const struct tm *t = localtime(&now);
+
+	return ((DWORD)(t->tm_year - 80) << 25)
+			| ((DWORD)(t->tm_mon + 1) << 21)
+			| ((DWORD)t->tm_mday << 16)
+			| ((DWORD)t->tm_hour << 11)
+			| ((DWORD)t->tm_min << 5)
+			| ((DWORD)t->tm_sec >> 1);
+}
+
+#endif /* FATFS_HOST_DISK */
@@ -0,0 +1,36 @@
+/*-----------------------------------------------------------------------
+/  Host disk I/O module for FatFs, see diskio_host.c
+/-----------------------------------------------------------------------*/
+
+#ifndef _DISKIO_HOST
+
+#ifdef FATFS_HOST_DISK
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Access counters, so that benchmarks can see how many commands a test sent to the card */
+typedef struct {
+	uint32_t reads;				/* Number of disk_read calls */
+	uint32_t sectorsRead;
+	uint32_t writes;			/* Number of disk_write calls */
+	uint32_t sectorsWritten;
+	uint64_t latencyUs;			/* Total latency injected */
+} DiskHostStats;
+
+int disk_host_open(const char *imageFile);		/* Use a FAT image file as drive 0, returns 0 on success */
+void disk_host_close(void);
+void disk_host_set_latency(uint32_t readCommandUs, uint32_t readSectorUs, uint32_t writeCommandUs, uint32_t writeSectorUs);
+void disk_host_get_stats(DiskHostStats *stats, int clear);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FATFS_HOST_DISK */
+
+#define _DISKIO_HOST
+#endif
@@ -40,6 +40,8 @@
  * \asf_license_stop
  *
  */
+#ifndef FATFS_HOST_DISK		// host builds use the get_fattime in diskio_host.c
+
 #include "compiler.h"
 #include "rtc.h"
 
@@ -89,3 +91,4 @@ uint32_t get_fattime(void)
 	return 0x210001; //set datetime
 }
 
+#endif /* FATFS_HOST_DISK */
@@ -529,9 +529,9 @@ static WCHAR LfnBuf[_MAX_LFN+1];
 
 // Function to check whether a buffer pointer is 32-bit aligned.
 // If it isn't then we must not do direct sector reads/writes, because the DMA controller used for HSMCI transfers doesn't do unaligned memory accesses.
-inline _Bool isAligned(const BYTE *p)
+static inline _Bool isAligned(const BYTE *p)
 {
-	return ((unsigned int)p & 3) == 0;
+	return ((unsigned long)p & 3) == 0;
 }
 
 /*-----------------------------------------------------------------------*/
@@ -28,9 +28,15 @@ typedef unsigned short	WORD;
 typedef unsigned short	WCHAR;
 
 /* These types must be 32-bit integer */
+#if defined(FATFS_HOST_DISK) && defined(__LP64__)
+typedef int				LONG;		/* long is 64 bits on 64-bit hosts */
+typedef unsigned int	ULONG;
+typedef unsigned int	DWORD;
+#else
 typedef long			LONG;
 typedef unsigned long	ULONG;
 typedef unsigned long	DWORD;
+#endif
 
 #endif
 
@@ -1098,43 +1098,38 @@ const char *UIDisplay::my_cwd(void)
 	return cwd;
 }
 
+// The directory listing is sorted with the subdirectories first, so when we are at the maximum
+// folder depth we skip them by starting that many entries in
+size_t UIDisplay::sdFirstListed()
+{
+	size_t numDirectories, numFiles;
+	if (folderLevel >= SD_MAX_FOLDER_DEPTH && platform->GetMassStorage()->CountEntries(my_cwd(), numDirectories, numFiles))
+		return numDirectories;
+	return 0;
+}
+
 void UIDisplay::sdUpdateFileCount()
 {
-	FileInfo file_info;
-	MassStorage *ms = platform->GetMassStorage();
+	size_t numDirectories, numFiles;
 
 	nFilesOnCard = 0;
-	if (ms->FindFirst(my_cwd(), file_info))
+	if (platform->GetMassStorage()->CountEntries(my_cwd(), numDirectories, numFiles))
 	{
-		do
-		{
-			if ((folderLevel >= SD_MAX_FOLDER_DEPTH) && file_info.isDirectory)
-				continue;
-			++nFilesOnCard;
-		} while (ms->FindNext(file_info));
+		if (folderLevel < SD_MAX_FOLDER_DEPTH)
+			numFiles += numDirectories;
+		nFilesOnCard = MIN(numFiles, 255);
 	}
 }
 
 void UIDisplay::sdGetFilenameAt(uint8_t filePos, char *filename)
 {
 	FileInfo file_info;
-	MassStorage *ms = platform->GetMassStorage();
 
-	if (ms->FindFirst(my_cwd(), file_info))
-    {
-		do
-		{
-			if (file_info.isDirectory &&
-				(folderLevel >= SD_MAX_FOLDER_DEPTH) &&
-				!(StringEquals(file_info.fileName, "..")))
-				continue;
-			if (filePos--)
-				continue;
-			strcpy(filename, file_info.fileName);
-			if (file_info.isDirectory)
-				strcat(filename, "/");
-			break;
-		} while (ms->FindNext(file_info));
+	if (platform->GetMassStorage()->GetSortedEntry(my_cwd(), sdFirstListed() + filePos, file_info))
+	{
+		strcpy(filename, file_info.fileName);
+		if (file_info.isDirectory)
+			strcat(filename, "/");
 	}
 }
 
@@ -1220,34 +1215,17 @@ bool UIDisplay::sdDeleteFile(const char *fname)
 
 void UIDisplay::sdRefresh(uint8_t &r, char cache[UI_ROWS][MAX_COLS+1])
 {
-	byte length, offset, skip;
+	byte length, offset;
 	FileInfo file_info;
 	MassStorage *ms = platform->GetMassStorage();
 
-	if (!ms->FindFirst(my_cwd(), file_info))
-		return;
-
 	offset = menuTop[menuLevel];
-	skip = (offset > 0) ? offset - 1 : 0;
+	size_t index = sdFirstListed() + ((offset > 0) ? offset - 1 : 0);
 
     while ((r + offset) < (nFilesOnCard + 1) && (r < UI_ROWS))
     {
-        // done if past last used entry
-        // skip deleted entry and entries for . and  ..
-        // only list subdirectories and files
-
-		// Do not list folders if we are at maximum folder depth
-		if ((folderLevel >= SD_MAX_FOLDER_DEPTH) &&
-			file_info.isDirectory &&
-			!(StringEquals(file_info.fileName, "..")))
-			goto next;
-
-		// Skip this file or folder if we are not interested in it
-		if (skip > 0)
-		{
-			skip--;
-			goto next;
-		}
+		if (!ms->GetSortedEntry(my_cwd(), index++, file_info))
+			break;
 
 		col = 0;
 		if ((r + offset) == menuPos[menuLevel])
@@ -1263,10 +1241,6 @@ void UIDisplay::sdRefresh(uint8_t &r, char cache[UI_ROWS][MAX_COLS+1])
 		col += length;
 		printCols[col] = 0;
 		strcpy(cache[r++], printCols);
-
-	next:
-		if (!(ms->FindNext(file_info)))
-			break;
     }
 }
 
@@ -88,6 +88,7 @@ private:
 
 	// SD card navigation and actions
 	const char *my_cwd();
+    size_t sdFirstListed();
     void sdUpdateFileCount();
     void sdGoDir(const char *name);
     bool sdIsDirname(const char *name);
@@ -0,0 +1,258 @@
+/****************************************************************************************************
+
+RepRapFirmware - MacroCache
+
+This class keeps the contents of recently used macro files in RAM. See MacroCache.h for details.
+
+-----------------------------------------------------------------------------------------------------
+
+Licence: GPL
+
+****************************************************************************************************/
+
+#include "RepRapFirmware.h"
+
+MacroCache::MacroCache(Platform *p) : platform(p)
+{
+	Init();
+}
+
+void MacroCache::Init()
+{
+	for (size_t i = 0; i < MACRO_CACHE_ENTRIES; i++)
+	{
+		entries[i].length = 0;
+		entries[i].lastUsed = 0;
+		entries[i].useCount = 0;
+		entries[i].valid = false;
+	}
+	useClock = 0;
+	hits = misses = 0;
+	numTooLarge = nextTooLarge = 0;
+}
+
+int MacroCache::Find(const char *location)
+{
+	location = MassStorage::SkipVolume(location);
+	for (size_t i = 0; i < MACRO_CACHE_ENTRIES; i++)
+	{
+		MacroCacheEntry& entry = entries[i];
+		if (entry.valid && StringEquals(entry.location, location))
+		{
+			entry.lastUsed = ++useClock;
+			++entry.useCount;
+			++hits;
+			return (int)i;
+		}
+	}
+	++misses;
+	return -1;
+}
+
+// Remove comments, blank lines and surrounding white space from a file. If 'dest' is null we only count the characters we would keep.
+// Returns the number of characters, or MACRO_CACHE_ENTRY_SIZE + 1 if they don't fit in an entry.
+/*static*/ size_t MacroCache::Strip(FileStore *f, char *dest)
+{
+	size_t len = 0, lineStart = 0, trailingSpaces = 0;
+	bool inComment = false, endOfFile = false;
+	while (!endOfFile)
+	{
+		const char *data;
+		size_t dataLength;
+		if (!f->GetBufferedData(data, dataLength))
+		{
+			// Terminate the last line in case the file didn't end with a newline
+			data = "\n";
+			dataLength = 1;
+			endOfFile = true;
+		}
+
+		for (size_t i = 0; i < dataLength; i++)
+		{
+			const char c = data[i];
+			if (c == '\n')
+			{
+				len -= trailingSpaces;
+				trailingSpaces = 0;
+				if (len > lineStart)
+				{
+					if (len >= MACRO_CACHE_ENTRY_SIZE)
+					{
+						return MACRO_CACHE_ENTRY_SIZE + 1;
+					}
+					if (dest != nullptr)
+					{
+						dest[len] = '\n';
+					}
+					lineStart = ++len;
+				}
+				inComment = false;
+			}
+			else if (c == ';')
+			{
+				inComment = true;
+			}
+			else if (!inComment && c != '\r' && (len != lineStart || (c != ' ' && c != '\t')))
+			{
+				if (len >= MACRO_CACHE_ENTRY_SIZE - 1)
+				{
+					return MACRO_CACHE_ENTRY_SIZE + 1;		// leave room for the newline
+				}
+				if (dest != nullptr)
+				{
+					dest[len] = c;
+				}
+				++len;
+				trailingSpaces = (c == ' ' || c == '\t') ? trailingSpaces + 1 : 0;
+			}
+		}
+		if (!endOfFile)
+		{
+			f->SkipBufferedData(dataLength);
+		}
+	}
+	return len;
+}
+
+bool MacroCache::IsTooLarge(uint32_t hash) const
+{
+	for (size_t i = 0; i < numTooLarge; i++)
+	{
+		if (tooLargeHashes[i] == hash)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+// Read a file into the least recently used entry that isn't in use.
+// We give up if the file doesn't fit, in which case the caller has to read it from the SD card instead. If the file is longer than an
+// entry, we find out whether it fits before we discard an entry for it, and remember the files that don't fit so that we don't read them twice again.
+int MacroCache::Load(FileStore *f, const char *location)
+{
+	location = MassStorage::SkipVolume(location);
+	const uint32_t hash = DirectoryCache::Hash(location, strlen(location));
+	if (IsTooLarge(hash))
+	{
+		return -1;
+	}
+
+	if (f->Length() >= MACRO_CACHE_ENTRY_SIZE)
+	{
+		const bool fits = (Strip(f, nullptr) <= MACRO_CACHE_ENTRY_SIZE);
+		if (!f->Seek(0))
+		{
+			return -1;
+		}
+		if (!fits)
+		{
+			tooLargeHashes[nextTooLarge] = hash;
+			nextTooLarge = (nextTooLarge + 1) % MACRO_CACHE_TOO_LARGE;
+			numTooLarge = max<size_t>(numTooLarge, nextTooLarge);
+			return -1;
+		}
+	}
+
+	int victim = -1;
+	for (size_t i = 0; i < MACRO_CACHE_ENTRIES; i++)
+	{
+		const MacroCacheEntry& entry = entries[i];
+		if (entry.useCount == 0
+			&& (victim < 0 || (!entry.valid && entries[victim].valid) || (entry.valid == entries[victim].valid && entry.lastUsed < entries[victim].lastUsed)))
+		{
+			victim = (int)i;
+		}
+	}
+	if (victim < 0)
+	{
+		return -1;
+	}
+
+	MacroCacheEntry& entry = entries[victim];
+	entry.valid = false;
+	const size_t len = Strip(f, entry.data);
+	if (len > MACRO_CACHE_ENTRY_SIZE)
+	{
+		return -1;
+	}
+
+	strncpy(entry.location, location, ARRAY_SIZE(entry.location));
+	entry.location[ARRAY_UPB(entry.location)] = 0;
+	entry.length = len;
+	entry.lastUsed = ++useClock;
+	entry.useCount = 1;
+	entry.valid = true;
+	return victim;
+}
+
+void MacroCache::Release(int entry)
+{
+	if (entries[entry].useCount != 0)
+	{
+		--entries[entry].useCount;
+	}
+}
+
+// Discard the entry for a file that has been changed. If the location is a directory, discard all the files in it.
+void MacroCache::Invalidate(const char *location)
+{
+	location = MassStorage::SkipVolume(location);
+	size_t locationLength = strlen(location);
+	if (locationLength != 0 && location[locationLength - 1] == '/')
+	{
+		--locationLength;
+	}
+
+	for (size_t i = 0; i < MACRO_CACHE_ENTRIES; i++)
+	{
+		MacroCacheEntry& entry = entries[i];
+		if (entry.valid && strlen(entry.location) >= locationLength && strncasecmp(entry.location, location, locationLength) == 0
+			&& (entry.location[locationLength] == 0 || entry.location[locationLength] == '/'))
+		{
+			entry.valid = false;
+		}
+	}
+	numTooLarge = nextTooLarge = 0;				// the file may fit now
+}
+
+// Discard a file that has just been written. Its entry was invalidated when the file was opened for writing, but a macro
+// may have run while the file was being written and cached the part of it that was there.
+void MacroCache::InvalidateFile(uint32_t hash)
+{
+	for (size_t i = 0; i < MACRO_CACHE_ENTRIES; i++)
+	{
+		MacroCacheEntry& entry = entries[i];
+		if (entry.valid && DirectoryCache::Hash(entry.location, strlen(entry.location)) == hash)
+		{
+			entry.valid = false;
+		}
+	}
+	numTooLarge = nextTooLarge = 0;				// the file may fit now
+}
+
+// Discard all entries, called when the SD card has been removed. The files that were reading them have been reset too.
+void MacroCache::InvalidateAll()
+{
+	for (size_t i = 0; i < MACRO_CACHE_ENTRIES; i++)
+	{
+		entries[i].valid = false;
+		entries[i].useCount = 0;
+	}
+	numTooLarge = nextTooLarge = 0;
+}
+
+void MacroCache::Diagnostics()
+{
+	unsigned int numCached = 0;
+	for (size_t i = 0; i < MACRO_CACHE_ENTRIES; i++)
+	{
+		if (entries[i].valid)
+		{
+			++numCached;
+		}
+	}
+	platform->MessageF(GENERIC_MESSAGE, "Macro cache: %u of %u entries used, %lu hits, %lu misses\n", numCached, MACRO_CACHE_ENTRIES, hits, misses);
+}
+
+// End
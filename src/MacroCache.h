@@ -0,0 +1,61 @@
+/****************************************************************************************************
+
+RepRapFirmware - MacroCache
+
+This class keeps the contents of recently used macro files in RAM, so that homing, tool changes and
+pausing don't have to wait for the SD card. The files are stored without comments and blank lines.
+Entries are replaced on a least-recently-used basis and are discarded when their file is changed.
+
+-----------------------------------------------------------------------------------------------------
+
+Licence: GPL
+
+****************************************************************************************************/
+
+#ifndef MACROCACHE_H
+#define MACROCACHE_H
+
+const size_t MACRO_CACHE_ENTRIES = 4;				// Number of macro files we keep in RAM, each entry takes 624 bytes
+const size_t MACRO_CACHE_ENTRY_SIZE = 512;			// Maximum size of a macro file after comments have been removed
+const size_t MACRO_CACHE_TOO_LARGE = 4;			// Number of files we remember that don't fit
+
+class MacroCache
+{
+public:
+	MacroCache(Platform *p);
+	void Init();
+	int Find(const char *location);					// Look up a file and lock its entry, returns -1 if it isn't cached
+	int Load(FileStore *f, const char *location);	// Copy an open file into the cache and lock its entry, returns -1 if we can't
+	const char *GetData(int entry) const { return entries[entry].data; }
+	size_t GetLength(int entry) const { return entries[entry].length; }
+	void Release(int entry);						// Unlock an entry, called when the file is closed
+	void Invalidate(const char *location);			// Discard a file or all the files in a directory
+	void InvalidateFile(uint32_t hash);				// Discard a file identified by the DirectoryCache hash of its path, called when a written file is closed
+	void InvalidateAll();
+	void Diagnostics();
+
+private:
+	struct MacroCacheEntry
+	{
+		char location[FILENAME_LENGTH];				// path of the file without the volume prefix
+		char data[MACRO_CACHE_ENTRY_SIZE];
+		size_t length;
+		uint32_t lastUsed;
+		uint16_t useCount;							// number of open files reading this entry, it can't be replaced while this is nonzero
+		bool valid;
+	};
+
+	static size_t Strip(FileStore *f, char *dest);
+	bool IsTooLarge(uint32_t hash) const;
+
+	Platform *platform;
+	MacroCacheEntry entries[MACRO_CACHE_ENTRIES];
+	uint32_t tooLargeHashes[MACRO_CACHE_TOO_LARGE];	// hashes of the paths of files that didn't fit
+	size_t numTooLarge, nextTooLarge;
+	uint32_t useClock;
+	uint32_t hits, misses;
+};
+
+#endif
+
+// vim: ts=4:sw=4
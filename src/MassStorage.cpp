@@ -16,6 +16,7 @@ void SdCardDetectInterrupt()
 
 MassStorage::MassStorage(Platform* p) : platform(p)
 {
+	directoryCache = new DirectoryCache(p);
 	Reset();
 #if defined(SD_DETECT_PIN) && defined(SD_DETECT_VAL)
 	pinMode(SD_DETECT_PIN, INPUT_PULLUP);
@@ -28,6 +29,8 @@ void MassStorage::Reset()
 	memset(&fileSystem, 0, sizeof(fileSystem));
 	memset(&findDir, 0, sizeof(findDir));
 	sdCardState = REMOVED;
+	platform->GetMacroCache()->InvalidateAll();
+	directoryCache->InvalidateAll();
 }
 
 #if defined(SD_DETECT_PIN) && defined(SD_DETECT_VAL)
@@ -215,6 +218,12 @@ const char* MassStorage::CombineName(const char* directory, const char* fileName
 	return combinedName;
 }
 
+// Skip the volume prefix of a path, so that "0:/sys/config.g" and "/sys/config.g" can be compared
+/*static*/ const char* MassStorage::SkipVolume(const char* location)
+{
+	return (isdigit(location[0]) && location[1] == ':') ? location + 2 : location;
+}
+
 // Open a directory to read a file list. Returns true if it contains any files, false otherwise.
 bool MassStorage::FindFirst(const char *directory, FileInfo &file_info)
 {
@@ -239,6 +248,7 @@ bool MassStorage::FindFirst(const char *directory, FileInfo &file_info)
 		loc[len] = 0;
 	}
 
+	const uint32_t startTime = micros();
 	findDir.lfn = nullptr;
 	FRESULT res = f_opendir(&findDir, loc);
 	if (res == FR_OK)
@@ -269,8 +279,10 @@ bool MassStorage::FindFirst(const char *directory, FileInfo &file_info)
 				strncpy(file_info.fileName, entry.fname, ARRAY_SIZE(file_info.fileName));
 			}
 
+			platform->GetIoStatistics()->Record(ioDirectory, startTime);
 			return true;
 		}
+		platform->GetIoStatistics()->Record(ioDirectory, startTime);
 	}
 
 	return false;
@@ -286,7 +298,10 @@ bool MassStorage::FindNext(FileInfo &file_info)
 	entry.lfsize = ARRAY_SIZE(file_info.fileName);
 
 	findDir.lfn = nullptr;
-	if (f_readdir(&findDir, &entry) != FR_OK || entry.fname[0] == 0)
+	const uint32_t startTime = micros();
+	const FRESULT res = f_readdir(&findDir, &entry);
+	platform->GetIoStatistics()->Record(ioDirectory, startTime);
+	if (res != FR_OK || entry.fname[0] == 0)
 	{
 		//f_closedir(findDir);
 		return false;
@@ -311,6 +326,18 @@ bool MassStorage::FindNext(FileInfo &file_info)
 	return true;
 }
 
+// Get an entry of the sorted listing of a directory, directories first. Used by the LCD, which fetches entries by their position.
+bool MassStorage::GetSortedEntry(const char *directory, size_t index, FileInfo &file_info)
+{
+	return FileSystemAvailable() && directoryCache->GetEntry(directory, index, file_info);
+}
+
+// Count the subdirectories and files in a directory
+bool MassStorage::CountEntries(const char *directory, size_t& numDirectories, size_t& numFiles)
+{
+	return FileSystemAvailable() && directoryCache->Count(directory, numDirectories, numFiles);
+}
+
 // Month names. The first entry is used for invalid month numbers.
 static const char *monthNames[13] = { "???", "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec" };
 
@@ -331,6 +358,7 @@ bool MassStorage::Delete(const char* directory, const char* fileName)
 		platform->MessageF(GENERIC_MESSAGE, "Can't delete file %s\n", location);
 		return false;
 	}
+	FileChanged(location);
 	return true;
 }
 
@@ -345,6 +373,7 @@ bool MassStorage::MakeDirectory(const char *parentDir, const char *dirName)
 		platform->MessageF(GENERIC_MESSAGE, "Can't create directory %s\n", location);
 		return false;
 	}
+	directoryCache->Invalidate(location);
 	return true;
 }
 
@@ -357,6 +386,7 @@ bool MassStorage::MakeDirectory(const char *directory)
 		platform->MessageF(GENERIC_MESSAGE, "Can't create directory %s\n", directory);
 		return false;
 	}
+	directoryCache->Invalidate(directory);
 	return true;
 }
 
@@ -370,6 +400,8 @@ bool MassStorage::Rename(const char *oldFilename, const char *newFilename)
 		platform->MessageF(GENERIC_MESSAGE, "Can't rename file or directory %s to %s\n", oldFilename, newFilename);
 		return false;
 	}
+	FileChanged(oldFilename);
+	FileChanged(newFilename);
 	return true;
 }
 
@@ -406,4 +438,29 @@ bool MassStorage::DirectoryExists(const char* directory, const char* subDirector
 	return DirectoryExists(CombineName(directory, subDirectory));
 }
 
+// Get the size and the FAT date and time of a file
+bool MassStorage::GetFileStatus(const char *location, uint32_t& size, uint32_t& timestamp) const
+{
+	if (!platform->GetMassStorage()->FileSystemAvailable()) return false;
+
+	FILINFO fil;
+	fil.lfname = nullptr;
+	if (f_stat(location, &fil) != FR_OK)
+	{
+		return false;
+	}
+	size = fil.fsize;
+	timestamp = ((uint32_t)fil.fdate << 16) | fil.ftime;
+	return true;
+}
+
+// This is called whenever a file is created, overwritten, renamed or deleted, so that we can discard any information derived from it.
+// Don't use CombineName in here, because 'location' may point to its buffer.
+void MassStorage::FileChanged(const char *location)
+{
+	GCodeIndex::Invalidate(location);
+	platform->GetMacroCache()->Invalidate(location);
+	directoryCache->Invalidate(location);
+}
+
 // End
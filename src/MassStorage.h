@@ -13,6 +13,7 @@ enum SDCardState
 
 class Platform;
 class FileInfo;
+class DirectoryCache;
 
 class MassStorage
 {
@@ -20,8 +21,11 @@ public:
 
 	bool FindFirst(const char *directory, FileInfo &file_info);
 	bool FindNext(FileInfo &file_info);
+	bool GetSortedEntry(const char *directory, size_t index, FileInfo &file_info);
+	bool CountEntries(const char *directory, size_t& numDirectories, size_t& numFiles);
 	const char* GetMonthName(const uint8_t month);
 	const char* CombineName(const char* directory, const char* fileName);
+	static const char* SkipVolume(const char* location);
 	bool Delete(const char* directory, const char* fileName);
 	bool MakeDirectory(const char *parentDir, const char *dirName);
 	bool MakeDirectory(const char *directory);
@@ -30,6 +34,9 @@ public:
 	bool FileExists(const char* directory, const char *fileName) const;
 	bool DirectoryExists(const char *path) const;
 	bool DirectoryExists(const char* directory, const char* subDirectory);
+	bool GetFileStatus(const char *location, uint32_t& size, uint32_t& timestamp) const;
+	void FileChanged(const char *location);
+	DirectoryCache* GetDirectoryCache() const { return directoryCache; }
 	bool FileSystemAvailable();
 
 friend class Platform;
@@ -49,6 +56,7 @@ private:
 	Platform* platform;
 	FATFS fileSystem;
 	DIR findDir;
+	DirectoryCache* directoryCache;
 	char combinedName[FILENAME_LENGTH + 1];
 };
 
@@ -614,14 +614,18 @@ void Network::ConnectionClosed(ConnectionState* cs, bool closeConnection)
 	}
 
 	// Remove all callbacks and close the PCB if requested
+	// The PCB is already gone if the connection was reset
 	tcp_pcb *pcb = cs->pcb;
-	tcp_sent(pcb, nullptr);
-	tcp_recv(pcb, nullptr);
-	tcp_poll(pcb, nullptr, TCP_WRITE_TIMEOUT / TCP_SLOW_INTERVAL / TCP_MAX_SEND_RETRIES);
-	if (pcb != nullptr && closeConnection)
+	if (pcb != nullptr)
 	{
-		tcp_err(pcb, nullptr);
-		tcp_close(pcb);
+		tcp_sent(pcb, nullptr);
+		tcp_recv(pcb, nullptr);
+		tcp_poll(pcb, nullptr, TCP_WRITE_TIMEOUT / TCP_SLOW_INTERVAL / TCP_MAX_SEND_RETRIES);
+		if (closeConnection)
+		{
+			tcp_err(pcb, nullptr);
+			tcp_close(pcb);
+		}
 	}
 	cs->pcb = nullptr;
 
@@ -1072,7 +1076,7 @@ bool NetworkTransaction::Read(char& b)
 	}
 
 	b = ((const char*)readingPb->payload)[inputPointer++];
-	if (inputPointer > readingPb->len)
+	if (inputPointer >= readingPb->len)
 	{
 		readingPb = readingPb->next;
 		inputPointer = 0;
@@ -1105,6 +1109,35 @@ bool NetworkTransaction::ReadBuffer(const char *&buffer, size_t &len)
 	return true;
 }
 
+// Get the data from the current pbuf that hasn't been read yet, without reading it
+bool NetworkTransaction::PeekBuffer(const char *&buffer, size_t &len)
+{
+	while (readingPb != nullptr && inputPointer >= readingPb->len)
+	{
+		readingPb = readingPb->next;
+		inputPointer = 0;
+	}
+	if (readingPb == nullptr)
+	{
+		return false;
+	}
+
+	buffer = (const char*)readingPb->payload + inputPointer;
+	len = readingPb->len - inputPointer;
+	return true;
+}
+
+// Mark 'len' bytes returned by PeekBuffer as read
+void NetworkTransaction::Skip(size_t len)
+{
+	inputPointer += len;
+	if (inputPointer >= readingPb->len)
+	{
+		readingPb = readingPb->next;
+		inputPointer = 0;
+	}
+}
+
 void NetworkTransaction::Write(char b)
 {
 	if (CanWrite())
@@ -1217,6 +1250,11 @@ bool NetworkTransaction::Send()
 	while (sendBuffer != nullptr && bytesLeftToSend > 0)
 	{
 		size_t copyLength = min<size_t>(bytesLeftToSend, sendBuffer->BytesLeft());
+		if (copyLength < sendBuffer->BytesLeft() && sendBuffer->IsShared())
+		{
+			// Other transactions send this buffer too and they share its read pointer, so send it all in the next window
+			break;
+		}
 		memcpy(sendingWindow + bytesBeingSent, sendBuffer->Read(copyLength), copyLength);
 		bytesBeingSent += copyLength;
 		bytesLeftToSend -= copyLength;
@@ -1236,6 +1274,7 @@ bool NetworkTransaction::Send()
 	{
 		// For HSMCI efficiency, read from the file in multiples of 4 bytes except at the end.
 		// This ensures that the second and subsequent chunks can be DMA'd directly into sendingWindow.
+		// Don't stop at a sector boundary instead: the smaller window costs more in ACK round trips than FatFs saves in card reads.
 		size_t bytesToRead = bytesLeftToSend & (~3);
 		if (bytesToRead != 0)
 		{
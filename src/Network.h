@@ -96,6 +96,8 @@ class NetworkTransaction
 		bool HasMoreDataToRead() const { return readingPb != nullptr; }
 		bool Read(char& b);
 		bool ReadBuffer(const char *&buffer, size_t &len);
+		bool PeekBuffer(const char *&buffer, size_t &len);
+		void Skip(size_t len);
 		void Write(char b);
 		void Write(const char* s);
 		void Write(StringRef ref);
@@ -187,6 +189,7 @@ class Network
 		bool AcquireFTPTransaction();
 		bool AcquireDataTransaction();
 		bool AcquireTelnetTransaction();
+		bool AcquireTransaction(ConnectionState *cs);
 
 	private:
 
@@ -195,7 +198,6 @@ class Network
 
 		void AppendTransaction(NetworkTransaction* volatile * list, NetworkTransaction *r);
 		void PrependTransaction(NetworkTransaction* volatile * list, NetworkTransaction *r);
-		bool AcquireTransaction(ConnectionState *cs);
 
 		NetworkTransaction * volatile freeTransactions;
 		NetworkTransaction * volatile readyTransactions;
@@ -27,6 +27,7 @@ class OutputBuffer
 		void Append(OutputBuffer *other);
 		OutputBuffer *Next() const { return next; }
 		bool IsReferenced() const { return isReferenced; }
+		bool IsShared() const { return references > 1; }	// Is this instance going to be sent to more than one destination?
 		void IncreaseReferences(size_t refs);
 
 		const char *Data() const { return data; }
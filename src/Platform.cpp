@@ -139,6 +139,8 @@ Platform::Platform() :
 
 	// Files
 
+	ioStatistics = new IoStatistics(this);
+	macroCache = new MacroCache(this);
 	massStorage = new MassStorage(this);
 
 	for (size_t i = 0; i < MAX_FILES; i++)
@@ -186,6 +188,15 @@ void Platform::Init()
 	lastTime = Time();
 	longWait = lastTime;
 
+	// Start the configuration generation count and the status sequence numbers at random values,
+	// so that an rr_config ETag or a statusSeq from before a reset isn't mistaken for a current one
+	pmc_enable_periph_clk(ID_TRNG);
+	TRNG->TRNG_CR = TRNG_CR_KEY(0x524e47) | TRNG_CR_ENABLE;
+	while ((TRNG->TRNG_ISR & TRNG_ISR_DATRDY) == 0) { }
+	configGeneration = TRNG->TRNG_ODATA;
+	while ((TRNG->TRNG_ISR & TRNG_ISR_DATRDY) == 0) { }
+	bootId = TRNG->TRNG_ODATA;
+
 	// File management
 	massStorage->Init();
 
@@ -1224,9 +1235,13 @@ void Platform::Diagnostics()
 		}
 	}
 	MessageF(GENERIC_MESSAGE, "Free file entries: %u\n", numFreeFiles);
+	macroCache->Diagnostics();
+	massStorage->GetDirectoryCache()->Diagnostics();
 
 	// Show the longest write time
 	MessageF(GENERIC_MESSAGE, "Longest block write time: %.1fms\n", FileStore::GetAndClearLongestWriteTime());
+	FileStore::ReadDiagnostics();
+	ioStatistics->Diagnostics();
 
 // Debug
 //MessageF(GENERIC_MESSAGE, "Shortest/longest times read %.1f/%.1f write %.1f/%.1f ms, %u/%u\n",
@@ -1627,6 +1642,7 @@ void Platform::SetMotorCurrent(size_t drive, float current)
 	{
 		motorCurrents[drive] = current;
 		UpdateMotorCurrent(drive);
+		ConfigChanged();
 	}
 }
 
@@ -1697,6 +1713,7 @@ float Platform::MotorCurrent(size_t drive) const
 void Platform::SetIdleCurrentFactor(float f)
 {
 	idleCurrentFactor = f;
+	ConfigChanged();
 	for (size_t drive = 0; drive < DRIVES; ++drive)
 	{
 		if (driveState[drive] == DriveStatus::idle)
@@ -1992,6 +2009,56 @@ FileStore* Platform::GetFileStore(const char* directory, const char* fileName, b
 	return NULL;
 }
 
+// Open a macro file for reading. Small macro files are kept in RAM after they have been read for the first time.
+FileStore* Platform::GetMacroFileStore(const char* directory, const char* fileName)
+{
+	if (!fileStructureInitialised)
+	{
+		return nullptr;
+	}
+
+	FileStore *cachedFile = nullptr;
+	for (size_t i = 0; i < MAX_FILES; i++)
+	{
+		if (!files[i]->inUse)
+		{
+			cachedFile = files[i];
+			break;
+		}
+	}
+	if (cachedFile == nullptr)
+	{
+		Message(HOST_MESSAGE, "Max open file count exceeded.\n");
+		return nullptr;
+	}
+
+	char location[FILENAME_LENGTH + 1];
+	strncpy(location, massStorage->CombineName(directory, fileName), ARRAY_SIZE(location));
+	location[ARRAY_UPB(location)] = 0;
+
+	int entry = macroCache->Find(location);
+	if (entry < 0)
+	{
+		FileStore * const f = GetFileStore(directory, fileName, false);
+		if (f == nullptr)
+		{
+			return nullptr;
+		}
+
+		entry = macroCache->Load(f, location);
+		if (entry < 0)
+		{
+			// Too big, or all entries are in use. Read it from the SD card instead.
+			f->Seek(0);
+			return f;
+		}
+		f->Close();
+	}
+
+	cachedFile->OpenCached(entry, macroCache->GetData(entry), macroCache->GetLength(entry));
+	return cachedFile;
+}
+
 void Platform::Message(MessageType type, const char *message)
 {
 	switch (type)
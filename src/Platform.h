@@ -56,6 +56,9 @@ Licence: GPL
 #include "MAX31855.h"
 #include "MassStorage.h"
 #include "FileStore.h"
+#include "MacroCache.h"
+#include "DirectoryCache.h"
+#include "IoStatistics.h"
 
 #if defined(DIGIPOTS)
 #include "MCP4461.h"
@@ -472,6 +475,9 @@ public:
 
 	MassStorage* GetMassStorage() const;
 	FileStore* GetFileStore(const char* directory, const char* fileName, bool write);
+	FileStore* GetMacroFileStore(const char* directory, const char* fileName);
+	MacroCache* GetMacroCache() const;
+	IoStatistics* GetIoStatistics() const;
 #if defined(WEBSERVER)
 	const char* GetWebDir() const; 	// Where the htm etc files are
 #endif
@@ -481,6 +487,9 @@ public:
 	const char* GetConfigFile() const; // Where the configuration is stored (in the system dir).
 	const char* GetDefaultFile() const;	// Where the default configuration is stored (in the system dir).
 	void InvalidateFiles();					// Called to invalidate files when the SD card is removed
+	void ConfigChanged();					// Called when a value reported by rr_config has been changed
+	uint32_t GetConfigGeneration() const;	// Changes whenever ConfigChanged is called, used to build ETags for rr_config
+	uint32_t GetBootId() const;				// Random number chosen at startup, to tell tokens from before a reset apart
 
 	// Message output (see MessageType for further details)
 
@@ -791,6 +800,8 @@ private:
 
 	MassStorage* massStorage;
 	FileStore* files[MAX_FILES];
+	MacroCache* macroCache;
+	IoStatistics* ioStatistics;
 	bool fileStructureInitialised;
 #if defined(WEBSERVER)
 	const char* webDir;
@@ -800,6 +811,8 @@ private:
 	const char* macroDir;
 	const char* configFile;
 	const char* defaultFile;
+	uint32_t configGeneration;
+	uint32_t bootId;
 
 	// Data used by the tick interrupt handler
 
@@ -886,6 +899,16 @@ public:
 		return f->Read(b);
 	}
 
+	bool GetBufferedData(const char*& data, size_t& len)
+	{
+		return f->GetBufferedData(data, len);
+	}
+
+	void SkipBufferedData(size_t len)
+	{
+		f->SkipBufferedData(len);
+	}
+
 	bool Write(char b)
 	{
 		return f->Write(b);
@@ -911,6 +934,26 @@ public:
 		return f->Seek(position);
 	}
 
+	bool EnableReadAhead()
+	{
+		return f->EnableReadAhead();
+	}
+
+	void ReadAhead()
+	{
+		f->ReadAhead();
+	}
+
+	bool EnableWriteBehind()
+	{
+		return f->EnableWriteBehind();
+	}
+
+	bool Preallocate(FilePosition length)
+	{
+		return f->Preallocate(length);
+	}
+
 	float FractionRead() const
 	{
 		return (f == NULL ? -1.0 : f->FractionRead());
@@ -988,6 +1031,21 @@ inline const char* Platform::GetConfigFile() const
   return configFile;
 }
 
+inline void Platform::ConfigChanged()
+{
+	++configGeneration;
+}
+
+inline uint32_t Platform::GetConfigGeneration() const
+{
+	return configGeneration;
+}
+
+inline uint32_t Platform::GetBootId() const
+{
+	return bootId;
+}
+
 inline const char* Platform::GetDefaultFile() const
 {
   return defaultFile;
@@ -1021,6 +1079,7 @@ inline const float* Platform::Accelerations() const
 inline void Platform::SetAcceleration(size_t drive, float value)
 {
 	accelerations[drive] = value;
+	ConfigChanged();
 }
 
 inline float Platform::MaxFeedrate(size_t drive) const
@@ -1036,6 +1095,7 @@ inline const float* Platform::MaxFeedrates() const
 inline void Platform::SetMaxFeedrate(size_t drive, float value)
 {
 	maxFeedrates[drive] = value;
+	ConfigChanged();
 }
 
 inline float Platform::ConfiguredInstantDv(size_t drive) const
@@ -1047,6 +1107,7 @@ inline void Platform::SetInstantDv(size_t drive, float value)
 {
 	instantDvs[drive] = value;
 	SetSlowestDrive();
+	ConfigChanged();
 }
 
 inline size_t Platform::SlowestDrive() const
@@ -1089,6 +1150,7 @@ inline float Platform::AxisMaximum(size_t axis) const
 inline void Platform::SetAxisMaximum(size_t axis, float value)
 {
 	axisMaxima[axis] = value;
+	ConfigChanged();
 }
 
 inline float Platform::AxisMinimum(size_t axis) const
@@ -1099,6 +1161,7 @@ inline float Platform::AxisMinimum(size_t axis) const
 inline void Platform::SetAxisMinimum(size_t axis, float value)
 {
 	axisMinima[axis] = value;
+	ConfigChanged();
 }
 
 inline float Platform::AxisTotalLength(size_t axis) const
@@ -1284,6 +1347,16 @@ inline MassStorage* Platform::GetMassStorage() const
 	return massStorage;
 }
 
+inline MacroCache* Platform::GetMacroCache() const
+{
+	return macroCache;
+}
+
+inline IoStatistics* Platform::GetIoStatistics() const
+{
+	return ioStatistics;
+}
+
 /*static*/ inline void Platform::EnableWatchdog()
 {
 	watchdogEnable(1000);
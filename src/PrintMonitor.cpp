@@ -289,7 +289,13 @@ bool PrintMonitor::GetFileInfo(const char *directory, const char *fileName, GCod
 	}
 	else if (parseState == notParsing)
 	{
-		// No - see if we can access the file
+		// No - if the file was indexed when it was uploaded, we needn't parse it at all
+		if (GCodeIndex::GetFileInfo(directory, fileName, info))
+		{
+			return true;
+		}
+
+		// See if we can access the file
 		fileBeingParsed = platform->GetFileStore(directory, fileName, false);
 		if (fileBeingParsed == nullptr)
 		{
@@ -342,8 +348,6 @@ bool PrintMonitor::GetFileInfo(const char *directory, const char *fileName, GCod
 
 	if (parseState == parsingHeader)
 	{
-		bool headerInfoComplete = true;
-
 		// Read a chunk from the header. On the first run only process 1024 bytes, but use overlap (total 1124 bytes) next times.
 		sizeToRead = (size_t)min<FilePosition>(fileBeingParsed->Length() - fileBeingParsed->Position(), GCODE_READ_SIZE);
 		if (fileOverlapLength > 0)
@@ -375,94 +379,10 @@ bool PrintMonitor::GetFileInfo(const char *directory, const char *fileName, GCod
 			startTime = now;
 		}
 
-		// Search for filament usage (Cura puts it at the beginning of a G-code file)
-		if (parsedFileInfo.numFilaments == 0)
-		{
-			parsedFileInfo.numFilaments = FindFilamentUsed(buf, sizeToScan, parsedFileInfo.filamentNeeded, DRIVES - AXES);
-			headerInfoComplete &= (parsedFileInfo.numFilaments != 0);
-		}
-
-		// Look for first layer height
-		if (parsedFileInfo.firstLayerHeight == 0.0)
-		{
-			headerInfoComplete &= FindFirstLayerHeight(buf, sizeToScan, parsedFileInfo.firstLayerHeight);
-		}
-
-		// Look for layer height
-		if (parsedFileInfo.layerHeight == 0.0)
-		{
-			headerInfoComplete &= FindLayerHeight(buf, sizeToScan, parsedFileInfo.layerHeight);
-		}
-
-		// Look for slicer program
-		if (parsedFileInfo.generatedBy[0] == 0)
-		{
-			// Slic3r and S3D
-			const char* generatedByString = "generated by ";
-			char* pos = strstr(buf, generatedByString);
-			if (pos != nullptr)
-			{
-				pos += strlen(generatedByString);
-				size_t i = 0;
-				while (i < ARRAY_SIZE(parsedFileInfo.generatedBy) - 1 && *pos >= ' ')
-				{
-					char c = *pos++;
-					if (c == '"' || c == '\\')
-					{
-						// Need to escape the quote-mark for JSON
-						if (i > ARRAY_SIZE(parsedFileInfo.generatedBy) - 3)
-						{
-							break;
-						}
-						parsedFileInfo.generatedBy[i++] = '\\';
-					}
-					parsedFileInfo.generatedBy[i++] = c;
-				}
-				parsedFileInfo.generatedBy[i] = 0;
-			}
-
-			// Cura
-			const char* slicedAtString = ";Sliced at: ";
-			pos = strstr(buf, slicedAtString);
-			if (pos != nullptr)
-			{
-				pos += strlen(slicedAtString);
-				strcpy(parsedFileInfo.generatedBy, "Cura at ");
-				size_t i = 8;
-				while (i < ARRAY_SIZE(parsedFileInfo.generatedBy) - 1 && *pos >= ' ')
-				{
-					char c = *pos++;
-					if (c == '"' || c == '\\')
-					{
-						if (i > ARRAY_SIZE(parsedFileInfo.generatedBy) - 3)
-						{
-							break;
-						}
-						parsedFileInfo.generatedBy[i++] = '\\';
-					}
-					parsedFileInfo.generatedBy[i++] = c;
-				}
-				parsedFileInfo.generatedBy[i] = 0;
-			}
-
-			// KISSlicer
-			const char* kisslicerStart = "; KISSlicer";
-			if (StringStartsWith(buf, kisslicerStart))
-			{
-				size_t stringLength = 0;
-				for(size_t i = 2; i < ARRAY_UPB(parsedFileInfo.generatedBy); i++)
-				{
-					if (buf[i] == '\r' || buf[i] == '\n')
-					{
-						break;
-					}
-
-					parsedFileInfo.generatedBy[stringLength++] = buf[i];
-				}
-				parsedFileInfo.generatedBy[stringLength] = 0;
-			}
-		}
-		headerInfoComplete &= (parsedFileInfo.generatedBy[0] != 0);
+		// Look for everything we still need in a single pass. Cura puts the filament usage at the beginning of the file.
+		ScanMetadata(buf, sizeToScan, false);
+		const bool headerInfoComplete = parsedFileInfo.numFilaments != 0 && parsedFileInfo.firstLayerHeight != 0.0
+										&& parsedFileInfo.layerHeight != 0.0 && parsedFileInfo.generatedBy[0] != 0;
 
 		// Keep track of the time stats
 		if (reprap.Debug(modulePrintMonitor))
@@ -498,7 +418,6 @@ bool PrintMonitor::GetFileInfo(const char *directory, const char *fileName, GCod
 	}
 
 	// Processing the footer. See how many bytes we need to read and if we can reuse the overlap
-	bool footerInfoComplete = true;
 	FilePosition pos = fileBeingParsed->Position();
 	sizeToRead = (size_t)min<FilePosition>(fileBeingParsed->Length() - pos, GCODE_READ_SIZE);
 	if (fileOverlapLength > 0)
@@ -531,24 +450,9 @@ bool PrintMonitor::GetFileInfo(const char *directory, const char *fileName, GCod
 		startTime = now;
 	}
 
-	// Search for filament used
-	if (parsedFileInfo.numFilaments == 0)
-	{
-		parsedFileInfo.numFilaments = FindFilamentUsed(buf, sizeToScan, parsedFileInfo.filamentNeeded, DRIVES - AXES);
-		footerInfoComplete &= (parsedFileInfo.numFilaments != 0);
-	}
-
-	// Search for layer height
-	if (parsedFileInfo.layerHeight == 0.0)
-	{
-		footerInfoComplete &= FindLayerHeight(buf, sizeToScan, parsedFileInfo.layerHeight);
-	}
-
-	// Search for object height
-	if (parsedFileInfo.objectHeight == 0.0)
-	{
-		footerInfoComplete &= FindHeight(buf, sizeToScan, parsedFileInfo.objectHeight);
-	}
+	// Look for everything we still need in a single pass
+	ScanMetadata(buf, sizeToScan, true);
+	const bool footerInfoComplete = parsedFileInfo.numFilaments != 0 && parsedFileInfo.layerHeight != 0.0 && parsedFileInfo.objectHeight != 0.0;
 
 	// Keep track of the time stats
 	if (reprap.Debug(modulePrintMonitor))
@@ -567,6 +471,9 @@ bool PrintMonitor::GetFileInfo(const char *directory, const char *fileName, GCod
 		parseState = notParsing;
 		fileBeingParsed->Close();
 		info = parsedFileInfo;
+
+		// Save what we found in the index, so that we needn't parse this file again
+		GCodeIndex::StoreFileInfo(directory, filenameBeingParsed, parsedFileInfo);
 		return true;
 	}
 
@@ -586,6 +493,23 @@ bool PrintMonitor::GetFileInfo(const char *directory, const char *fileName, GCod
 	return false;
 }
 
+// Write the members of the file info response that describe the file itself
+void PrintMonitor::AppendFileInfo(JsonWriter& json, const GCodeFileInfo& info) const
+{
+	json.Int("err", 0);
+	json.UInt("size", info.fileSize);
+	json.Float("height", info.objectHeight, 2);
+	json.Float("firstLayerHeight", info.firstLayerHeight, 2);
+	json.Float("layerHeight", info.layerHeight, 2);
+	json.StartArray("filament");
+	for (size_t i = 0; i < info.numFilaments; ++i)
+	{
+		json.Float(nullptr, info.filamentNeeded[i], 1);
+	}
+	json.EndArray();
+	json.String("generatedBy", info.generatedBy, ARRAY_SIZE(info.generatedBy));
+}
+
 // Get information for the specified file, or the currently printing file, in JSON format
 bool PrintMonitor::GetFileInfoResponse(const char *filename, OutputBuffer *&response)
 {
@@ -607,22 +531,10 @@ bool PrintMonitor::GetFileInfoResponse(const char *filename, OutputBuffer *&resp
 				return false;
 			}
 
-			response->printf("{\"err\":0,\"size\":%lu,\"height\":%.2f,\"firstLayerHeight\":%.2f,\"layerHeight\":%.2f,\"filament\":",
-							info.fileSize, info.objectHeight, info.firstLayerHeight, info.layerHeight);
-			char ch = '[';
-			if (info.numFilaments == 0)
-			{
-				response->cat(ch);
-			}
-			else
-			{
-				for(size_t i = 0; i < info.numFilaments; ++i)
-				{
-					response->catf("%c%.1f", ch, info.filamentNeeded[i]);
-					ch = ',';
-				}
-			}
-			response->catf("],\"generatedBy\":\"%s\"}", info.generatedBy);
+			JsonWriter json(response);
+			json.StartObject();
+			AppendFileInfo(json, info);
+			json.EndObject();
 		}
 		else
 		{
@@ -645,23 +557,12 @@ bool PrintMonitor::GetFileInfoResponse(const char *filename, OutputBuffer *&resp
 		}
 
 		// Poll file info about a file currently being printed
-		response->printf("{\"err\":0,\"size\":%lu,\"height\":%.2f,\"firstLayerHeight\":%.2f,\"layerHeight\":%.2f,\"filament\":",
-						printingFileInfo.fileSize, printingFileInfo.objectHeight, printingFileInfo.firstLayerHeight, printingFileInfo.layerHeight);
-		char ch = '[';
-		if (printingFileInfo.numFilaments == 0)
-		{
-			response->cat(ch);
-		}
-		else
-		{
-			for (size_t i = 0; i < printingFileInfo.numFilaments; ++i)
-			{
-				response->catf("%c%.1f", ch, printingFileInfo.filamentNeeded[i]);
-				ch = ',';
-			}
-		}
-		response->catf("],\"generatedBy\":\"%s\",\"printDuration\":%d,\"fileName\":\"%s\"}",
-				printingFileInfo.generatedBy, (int)GetPrintDuration(), filenameBeingPrinted);
+		JsonWriter json(response);
+		json.StartObject();
+		AppendFileInfo(json, printingFileInfo);
+		json.Int("printDuration", (int)GetPrintDuration());
+		json.String("fileName", filenameBeingPrinted, ARRAY_SIZE(filenameBeingPrinted));
+		json.EndObject();
 	}
 	else
 	{
@@ -824,302 +725,304 @@ float PrintMonitor::EstimateTimeLeft(PrintEstimationMethod method) const
 	return 0.0;
 }
 
-// Scan the buffer for a G1 Zxxx command. The buffer is null-terminated.
-bool PrintMonitor::FindFirstLayerHeight(const char* buf, size_t len, float& height) const
+// Metadata comments we look for. The first byte of each pattern must be accepted by IsMetadataPatternStart below.
+enum MetadataItem : uint8_t
 {
-	if (len < 4)
+	layerHeightSlic3r, layerHeightCura, layerHeightS3D, layerHeightKISSlicer,		// in order of precedence
+	filamentUsed, filamentLength, filamentVolume,
+	generatedBySlic3r, generatedByCura, objectHeightKISSlicer,
+	numMetadataItems
+};
+
+struct MetadataPattern
+{
+	const char *text;
+	size_t length;
+	MetadataItem item;
+};
+
+#define PATTERN(_s, _item)	{ _s, sizeof(_s) - 1, _item }
+
+static const MetadataPattern metadataPatterns[] =
+{
+	PATTERN("; layer_height ", layerHeightSlic3r),
+	PATTERN("Layer height: ", layerHeightCura),
+	PATTERN("layerHeight,", layerHeightS3D),
+	PATTERN("layer_thickness_mm = ", layerHeightKISSlicer),
+	PATTERN("ilament used", filamentUsed),				// Slic3r and Cura, followed by the filament used in mm (Slic3r) or m (Cura)
+	PATTERN("ilament length:", filamentLength),			// S3D, in mm
+	PATTERN("; Estimated Build Volume: ", filamentVolume),	// KISSlicer only gives the volume in cm3
+	PATTERN("generated by ", generatedBySlic3r),		// Slic3r and S3D
+	PATTERN(";Sliced at: ", generatedByCura),
+	PATTERN("; END_LAYER_OBJECT z=", objectHeightKISSlicer)
+};
+
+#undef PATTERN
+
+static inline bool IsMetadataPatternStart(char c)
+{
+	return c == ';' || c == 'L' || c == 'l' || c == 'i' || c == 'g';
+}
+
+// Copy a slicer name into the file info. It is stored as it is and escaped when the JSON response is written.
+static void CopyGeneratedBy(GCodeFileInfo& info, size_t i, const char *pos, const char *end)
+{
+	while (i < ARRAY_UPB(info.generatedBy) && pos < end && *pos >= ' ')
 	{
-		// Don't start if the buffer is not big enough
-		return false;
+		info.generatedBy[i++] = *pos++;
 	}
-	height = 0.0;
+	info.generatedBy[i] = 0;
+}
+
+// Scan the buffer for all the metadata we still need in a single pass. The buffer is null-terminated.
+// This used to be done by a separate search of the whole buffer for each item, but it is quicker to look at each line once:
+// we use memchr to find the ends of lines and the start of comments, then compare the bytes of the comments
+// with the patterns above only where the first byte matches, and look at the G-code part of the line for moves.
+// When the header is scanned we look for the first layer height and the slicer, when the footer is scanned we look for the object height.
+void PrintMonitor::ScanMetadata(const char *buf, size_t len, bool isFooter)
+{
+	const unsigned int maxFilaments = DRIVES - AXES;
+	const char * const bufEnd = buf + len;
+	const float maxFirstLayerHeight = platform->GetNozzleDiameter() * 3.0;
 
-//debugPrintf("Scanning %u bytes starting %.100s\n", len, buf);
-	bool inComment = false, inRelativeMode = false, foundHeight = false;
-	for(size_t i = 0; i < len - 4; i++)
+	// Where each item was first found, or null
+	const char *itemFound[numMetadataItems];
+	for (size_t i = 0; i < numMetadataItems; i++)
 	{
-		if (buf[i] == ';')
+		itemFound[i] = nullptr;
+	}
+	float filamentsUsed[DRIVES - AXES], filamentLengths[DRIVES - AXES];
+	unsigned int numFilamentsUsed = 0, numFilamentLengths = 0;
+
+	// Most of the metadata comments are in the header or in the footer, so we can stop looking at comments once we have all of it
+	const bool scanComments = parsedFileInfo.numFilaments == 0 || parsedFileInfo.layerHeight == 0.0
+								|| (isFooter ? parsedFileInfo.objectHeight == 0.0 : parsedFileInfo.generatedBy[0] == 0);
+	bool inRelativeMode = false;
+	float firstLayerHeight = 0.0;
+	float objectHeight = 0.0, objectHeightBeforeRelative = 0.0;
+
+	for (const char *line = buf; line < bufEnd; )
+	{
+		const char *eol = (const char *)memchr(line, '\n', bufEnd - line);
+		const bool complete = (eol != nullptr);
+		if (!complete)
 		{
-			inComment = true;
+			eol = bufEnd;
 		}
-		else if (inComment)
+		const char *comment = (const char *)memchr(line, ';', eol - line);
+		if (comment == nullptr)
 		{
-			if (buf[i] == '\n')
-			{
-				inComment = false;
-			}
+			comment = eol;
 		}
-		else if (buf[i] == 'G')
+
+		// Look at the command, unless it may have been cut off by the end of the buffer
+		if (complete && comment != line)
 		{
-			// See if we can switch back to absolute mode
-			if (inRelativeMode)
+			const char *p = line;
+			while (p < comment && (*p == ' ' || *p == '\t'))
 			{
-				inRelativeMode = !(buf[i + 1] == '9' && buf[i + 2] == '0' && buf[i + 3] <= ' ');
+				++p;
 			}
-			// Ignore G0/G1 codes if in relative mode
-			else if (buf[i + 1] == '9' && buf[i + 2] == '1' && buf[i + 3] <= ' ')
+			if (p < comment && *p == 'N')
 			{
-				inRelativeMode = true;
+				do
+				{
+					++p;
+				} while (p < comment && (isDigit(*p) || *p == ' '));
 			}
-			// Look for "G0/G1 ... Z#HEIGHT#" command
-			else if ((buf[i + 1] == '0' || buf[i + 1] == '1') && buf[i + 2] == ' ')
+
+			if (p + 3 <= comment && p[0] == 'G')
 			{
-				for(i += 3; i < len - 4; i++)
+				if (p[1] == '9' && (p[2] == '0' || p[2] == '1') && (p + 3 == comment || p[3] <= ' '))
 				{
-					if (buf[i] == 'Z')
+					if (p[2] == '1')
 					{
-						//debugPrintf("Found at offset %u text: %.100s\n", i, &buf[i + 1]);
-						float flHeight = strtod(&buf[i + 1], nullptr);
-						if ((height == 0.0 || flHeight < height) && (flHeight <= platform->GetNozzleDiameter() * 3.0))
+						// G91, relative moves don't tell us the height
+						if (!inRelativeMode)
 						{
-							height = flHeight;				// Only report first Z height if it's somewhat reasonable
-							foundHeight = true;
-							// NB: Don't stop here, because some slicers generate two Z moves at the beginning
+							objectHeightBeforeRelative = objectHeight;
+							inRelativeMode = true;
 						}
-						break;
 					}
-					else if (buf[i] == ';')
+					else
+					{
+						// G90. If we haven't seen the G91 before it, the moves so far may have been relative, so forget them (typical for Cura files)
+						objectHeight = objectHeightBeforeRelative;
+						inRelativeMode = false;
+					}
+				}
+				else if ((p[1] == '0' || p[1] == '1') && (p[2] == ' ' || p[2] == '\t') && !inRelativeMode)
+				{
+					// Look for "G0/G1 ... Z#HEIGHT#" command
+					const char * const zPos = (const char *)memchr(p + 3, 'Z', comment - (p + 3));
+					if (zPos != nullptr)
 					{
-						// Ignore comments
-						break;
+						const float height = strtod(zPos + 1, nullptr);
+						if (isFooter)
+						{
+							// Special case: ignore moves ending with ";E" or "; E"
+							if (comment == eol || (comment[1] != 'E' && comment[2] != 'E'))
+							{
+								objectHeight = height;
+							}
+						}
+						else if ((firstLayerHeight == 0.0 || height < firstLayerHeight) && height <= maxFirstLayerHeight)
+						{
+							firstLayerHeight = height;				// Only report first Z height if it's somewhat reasonable
+							// NB: Don't stop here, because some slicers generate two Z moves at the beginning
+						}
 					}
 				}
 			}
 		}
-	}
-	return foundHeight;
-}
 
-// Get the sum of extruded filament (in mm)
-float PrintMonitor::RawFilamentExtruded() const
-{
-	return reprap.GetGCodes()->GetTotalRawExtrusion();
-}
-
-// Scan the buffer in reverse for a G1 Zxxx command. The buffer is null-terminated.
-bool PrintMonitor::FindHeight(const char* buf, size_t len, float& height) const
-{
-	if (len < 5)
-	{
-		// Don't start if the buffer is not big enough
-		return false;
-	}
-
-	//debugPrintf("Scanning %u bytes starting %.100s\n", len, buf);
-	bool inComment, inRelativeMode = false;
-	unsigned int zPos;
-	for(size_t i = len - 5; i > 0; i--)
-	{
-		if (inRelativeMode)
-		{
-			inRelativeMode = !(buf[i] == 'G' && buf[i + 1] == '9' && buf[i + 2] == '1' && buf[i + 3] <= ' ');
-		}
-		else if (buf[i] == 'G')
+		// Look for the metadata patterns in the comment
+		for (const char *p = comment; scanComments && p < eol; ++p)
 		{
-			// Ignore G0/G1 codes if absolute mode was switched back using G90 (typical for Cura files)
-			if (buf[i + 1] == '9' && buf[i + 2] == '0' && buf[i + 3] <= ' ')
+			if (!IsMetadataPatternStart(*p))
 			{
-				inRelativeMode = true;
+				continue;
 			}
-			// Look for last "G0/G1 ... Z#HEIGHT#" command as generated by common slicers
-			else if ((buf[i + 1] == '0' || buf[i + 1] == '1') && buf[i + 2] == ' ')
+			for (size_t i = 0; i < ARRAY_SIZE(metadataPatterns); i++)
 			{
-				// Looks like we found a controlled move, however it could be in a comment, especially when using slic3r 1.1.1
-				inComment = false;
-				size_t j = i;
-				while (j != 0)
+				const MetadataPattern& pattern = metadataPatterns[i];
+				if (*p != pattern.text[0] || p + pattern.length > bufEnd || memcmp(p, pattern.text, pattern.length) != 0)
 				{
-					--j;
-					char c = buf[j];
-					if (c == '\n' || c == '\r')
-					{
-						// It's not in a comment
-						break;
-					}
-					if (c == ';')
-					{
-						// It is in a comment, so give up on this one
-						inComment = true;
-						break;
-					}
-				}
-				if (inComment)
 					continue;
+				}
 
-				// Find 'Z' position and grab that value
-				zPos = 0;
-				for(size_t j = i + 3; j < len - 2; j++)
+				const char *value = p + pattern.length;
+				switch (pattern.item)
 				{
-					char c = buf[j];
-					if (c == ';')
+				case filamentUsed:
+				case filamentLength:
+					while (strchr(" :=\t", *value) != nullptr)
 					{
-						inComment = true;
+						++value;	// this allows for " = " from default slic3r comment and ": " from default Cura comment
 					}
-					else if (c == 'Z' && !inComment)
+					if (isDigit(*value))
 					{
-						zPos = j;
-					}
-					else if (c == '\n')
-					{
-						if (zPos != 0)
+						char *q;
+						const float filament = strtod(value, &q);
+						if (pattern.item == filamentLength)
 						{
-							// Check special case of this code ending with ";E" or "; E" - ignore such codes
-							for(j = zPos + 1; j < len - 3; j++)
-							{
-								c = buf[j];
-								if (c == ';' && (buf[j + 1] == 'E' || buf[j + 2] == 'E'))
-								{
-									zPos = 0;
-									break;
-								}
-								if (c == '\n')
-								{
-									break;
-								}
-							}
-
-							if (zPos != 0)
+							// S3D reports filament usage in mm, no conversion needed
+							if (numFilamentLengths < maxFilaments)
 							{
-								// Z position is valid - read it
-								height = strtod(&buf[zPos + 1], nullptr);
-								return true;
+								filamentLengths[numFilamentLengths++] = filament;
 							}
 						}
-						break;
+						else if (numFilamentsUsed < maxFilaments)
+						{
+							// Cura outputs filament used in metres not mm
+							filamentsUsed[numFilamentsUsed++] = (*q == 'm' && *(q + 1) != 'm') ? filament * 1000.0 : filament;
+						}
 					}
+					break;
+
+				case objectHeightKISSlicer:
+					if (complete && !inRelativeMode)
+					{
+						objectHeight = strtod(value, nullptr);
+					}
+					break;
+
+				default:
+					if (itemFound[pattern.item] == nullptr)
+					{
+						itemFound[pattern.item] = value;
+					}
+					break;
 				}
+				p = value - 1;
+				break;
 			}
 		}
-		// Special case: KISSlicer generates object height as a comment
-		else
-		{
-			const char *kisslicerHeightString = "; END_LAYER_OBJECT z=";
-			if (i + 32 < len && StringStartsWith(buf + i, kisslicerHeightString))
-			{
-				height = strtod(buf + i + strlen(kisslicerHeightString), nullptr);
-				return true;
-			}
-		}
+
+		line = eol + 1;
 	}
-	return false;
-}
 
-// Scan the buffer for the layer height. The buffer is null-terminated.
-bool PrintMonitor::FindLayerHeight(const char *buf, size_t len, float& layerHeight) const
-{
-	// Look for layer_height as generated by Slic3r
-	const char* layerHeightStringSlic3r = "; layer_height ";
-	const char *pos = strstr(buf, layerHeightStringSlic3r);
-	if (pos != nullptr)
+	// Now fill in what we found, where it wasn't known already
+	if (parsedFileInfo.numFilaments == 0)
 	{
-		pos += strlen(layerHeightStringSlic3r);
-		while (strchr(" \t=:", *pos))
+		if (numFilamentsUsed != 0)
 		{
-			++pos;
+			memcpy(parsedFileInfo.filamentNeeded, filamentsUsed, numFilamentsUsed * sizeof(float));
+			parsedFileInfo.numFilaments = numFilamentsUsed;
 		}
-		layerHeight = strtod(pos, nullptr);
-		return true;
-	}
-
-	// Look for layer height as generated by Cura
-	const char* layerHeightStringCura = "Layer height: ";
-	pos = strstr(buf, layerHeightStringCura);
-	if (pos != nullptr)
-	{
-		pos += strlen(layerHeightStringCura);
-		while (strchr(" \t=:", *pos))
+		else if (numFilamentLengths != 0)
 		{
-			++pos;
+			memcpy(parsedFileInfo.filamentNeeded, filamentLengths, numFilamentLengths * sizeof(float));
+			parsedFileInfo.numFilaments = numFilamentLengths;
+		}
+		else if (itemFound[filamentVolume] != nullptr)
+		{
+			// Special case: KISSlicer only generates the filament volume, so we need to calculate the length from it
+			const float filamentCMM = strtod(itemFound[filamentVolume], nullptr) * 1000.0;
+			parsedFileInfo.filamentNeeded[0] = filamentCMM / (PI * (platform->GetFilamentWidth() / 2.0) * (platform->GetFilamentWidth() / 2.0));
+			parsedFileInfo.numFilaments = 1;
 		}
-		layerHeight = strtod(pos, nullptr);
-		return true;
 	}
 
-	// Look for layer height as generated by S3D
-	const char* layerHeightStringS3D = "layerHeight,";
-	pos = strstr(buf, layerHeightStringS3D);
-	if (pos != nullptr)
+	if (parsedFileInfo.layerHeight == 0.0)
 	{
-		pos += strlen(layerHeightStringS3D);
-		layerHeight = strtod(pos, nullptr);
-		return true;
+		for (size_t item = layerHeightSlic3r; item <= layerHeightKISSlicer; item++)
+		{
+			const char *value = itemFound[item];
+			if (value != nullptr)
+			{
+				if (item == layerHeightSlic3r || item == layerHeightCura)
+				{
+					while (strchr(" \t=:", *value))
+					{
+						++value;
+					}
+				}
+				parsedFileInfo.layerHeight = strtod(value, nullptr);
+				break;
+			}
+		}
 	}
 
-	// Look for layer height as generated by KISSlicer
-	const char* layerHeightStringKisslicer = "layer_thickness_mm = ";
-	pos = strstr(buf, layerHeightStringKisslicer);
-	if (pos != nullptr)
+	if (isFooter)
 	{
-		pos += strlen(layerHeightStringKisslicer);
-		layerHeight = strtod(pos, nullptr);
-		return true;
+		if (parsedFileInfo.objectHeight == 0.0)
+		{
+			parsedFileInfo.objectHeight = objectHeight;
+		}
 	}
-
-	return false;
-}
-
-// Scan the buffer for the filament used. The buffer is null-terminated.
-// Returns the number of filaments found.
-unsigned int PrintMonitor::FindFilamentUsed(const char* buf, size_t len, float *filamentUsed, unsigned int maxFilaments) const
-{
-	unsigned int filamentsFound = 0;
-
-	// Look for filament usage as generated by Slic3r and Cura
-	const char* filamentUsedStr = "ilament used";		// comment string used by slic3r and Cura, followed by filament used and "mm"
-	const char* p = buf;
-	while (filamentsFound < maxFilaments &&	(p = strstr(p, filamentUsedStr)) != nullptr)
+	else
 	{
-		p += strlen(filamentUsedStr);
-		while(strchr(" :=\t", *p) != nullptr)
+		if (parsedFileInfo.firstLayerHeight == 0.0)
 		{
-			++p;	// this allows for " = " from default slic3r comment and ": " from default Cura comment
+			parsedFileInfo.firstLayerHeight = firstLayerHeight;
 		}
-		if (isDigit(*p))
+
+		if (parsedFileInfo.generatedBy[0] == 0)
 		{
-			char* q;
-			filamentUsed[filamentsFound] = strtod(p, &q);
-			if (*q == 'm' && *(q + 1) != 'm')
+			const char *kisslicerStart = "; KISSlicer";
+			if (len >= strlen(kisslicerStart) && memcmp(buf, kisslicerStart, strlen(kisslicerStart)) == 0)
 			{
-				filamentUsed[filamentsFound] *= 1000.0;		// Cura outputs filament used in metres not mm
+				// KISSlicer puts its name and version on the first line
+				CopyGeneratedBy(parsedFileInfo, 0, buf + 2, bufEnd);
 			}
-			++filamentsFound;
-		}
-	}
-
-	// Look for filament usage as generated by S3D
-	if (!filamentsFound)
-	{
-		const char *filamentLengthStr = "ilament length:";	// comment string used by S3D
-		p = buf;
-		while (filamentsFound < maxFilaments &&	(p = strstr(p, filamentLengthStr)) != nullptr)
-		{
-			p += strlen(filamentLengthStr);
-			while(strchr(" :=\t", *p) != nullptr)
+			else if (itemFound[generatedByCura] != nullptr)
 			{
-				++p;	// this allows for " = " from default slic3r comment and ": " from default Cura comment
+				strcpy(parsedFileInfo.generatedBy, "Cura at ");
+				CopyGeneratedBy(parsedFileInfo, strlen(parsedFileInfo.generatedBy), itemFound[generatedByCura], bufEnd);
 			}
-			if (isDigit(*p))
+			else if (itemFound[generatedBySlic3r] != nullptr)
 			{
-				char* q;
-				filamentUsed[filamentsFound] = strtod(p, &q); // S3D reports filament usage in mm, no conversion needed
-				++filamentsFound;
+				CopyGeneratedBy(parsedFileInfo, 0, itemFound[generatedBySlic3r], bufEnd);
 			}
 		}
 	}
+}
 
-	// Special case: KISSlicer only generates the filament volume, so we need to calculate the length from it
-	if (!filamentsFound)
-	{
-		const char *filamentVolumeStr = "; Estimated Build Volume: ";
-		p = strstr(buf, filamentVolumeStr);
-		if (p != nullptr)
-		{
-			float filamentCMM = strtod(p + strlen(filamentVolumeStr), nullptr) * 1000.0;
-			filamentUsed[filamentsFound++] = filamentCMM / (PI * (platform->GetFilamentWidth() / 2.0) * (platform->GetFilamentWidth() / 2.0));
-		}
-	}
-
-	return filamentsFound;
+// Get the sum of extruded filament (in mm)
+float PrintMonitor::RawFilamentExtruded() const
+{
+	return reprap.GetGCodes()->GetTotalRawExtrusion();
 }
 
 // This returns the amount of time the machine has printed without interruptions (i.e. pauses)
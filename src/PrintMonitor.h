@@ -72,6 +72,7 @@ class PrintMonitor
 		void StartingPrint(const char *filename);		// Called to indicate a file will be printed (see M23)
 		void StartedPrint();							// Called whenever a new live print starts (see M24)
 		void StoppedPrint();							// Called whenever a file print has stopped
+		const char *GetPrintingFilename() const { return filenameBeingPrinted; }	// Name of the file set for printing by M23
 
 		// The following two methods need to be called until they return true - this may take a few runs
 		bool GetFileInfo(const char *directory, const char *fileName, GCodeFileInfo& info);
@@ -132,10 +133,9 @@ class PrintMonitor
 		char filenameBeingPrinted[FILENAME_LENGTH];
 
 		// G-Code parser methods
-		bool FindHeight(const char* buf, size_t len, float& height) const;
-		bool FindFirstLayerHeight(const char* buf, size_t len, float& layerHeight) const;
-		bool FindLayerHeight(const char* buf, size_t len, float& layerHeight) const;
-		unsigned int FindFilamentUsed(const char* buf, size_t len, float *filamentUsed, unsigned int maxFilaments) const;
+		void ScanMetadata(const char *buf, size_t len, bool isFooter);
+
+		void AppendFileInfo(JsonWriter& json, const GCodeFileInfo& info) const;
 
 		float accumulatedParseTime, accumulatedReadTime;
 };
@@ -66,6 +66,7 @@ class Tool;
 class Roland;
 #endif
 class PrintMonitor;
+class GCodeIndexer;
 class RepRap;
 class FileStore;
 #if defined(LCD_UI)
@@ -95,6 +96,8 @@ int StringContains(const char* string, const char* match);
 extern StringRef scratchString;
 
 #include "OutputMemory.h"
+#include "JsonWriter.h"
+#include "CRC32.h"
 #if defined(WEBSERVER)
 #include "Network.h"
 #endif
@@ -110,6 +113,9 @@ extern StringRef scratchString;
 #include "Roland.h"
 #endif
 #include "PrintMonitor.h"
+#include "GCodeIndex.h"
+#include "StatusTracker.h"
+#include "BinaryWriter.h"
 #if defined(LCD_UI)
 #include "UIDisplay.h"
 #endif
@@ -25,6 +25,8 @@ RepRap::RepRap() : toolList(nullptr), currentTool(nullptr), lastToolWarningTime(
 #endif
 
 	printMonitor = new PrintMonitor(platform, gCodes);
+	statusTracker = new StatusTracker();
+	auxStatusTracker = new StatusTracker();
 
 #if defined(LCD_UI)
 	// gCodes needed in order to pass UIDisplay's gcode input buffer to GCodes::
@@ -40,6 +42,8 @@ void RepRap::Init()
 {
 	// All of the following init functions must execute reasonably quickly before the watchdog times us out
 	platform->Init();
+	statusTracker->Init(platform->GetBootId());
+	auxStatusTracker->Init(platform->GetBootId());
 	gCodes->Init();
 #if defined(WEBSERVER)
 	network->Init();
@@ -210,6 +214,8 @@ void RepRap::Diagnostics()
 	move->Diagnostics();
 	heat->Diagnostics();
 	gCodes->Diagnostics();
+	statusTracker->Diagnostics(platform, "JSON");
+	auxStatusTracker->Diagnostics(platform, "Binary");
 #if defined(WEBSERVER)
 	network->Diagnostics();
 	webserver->Diagnostics();
@@ -502,7 +508,9 @@ void RepRap::Tick()
 // Type 1 is the ordinary JSON status response.
 // Type 2 is the same except that static parameters are also included.
 // Type 3 is the same but instead of static parameters we report print estimation values.
-OutputBuffer *RepRap::GetStatusResponse(uint8_t type, ResponseSource source)
+// If 'since' is the statusSeq from an earlier response, the coords, params, sensors, temps and type-specific sections
+// are only included if they have changed since then. The status, currentTool, output, seq and time fields are always sent.
+OutputBuffer *RepRap::GetStatusResponse(uint8_t type, ResponseSource source, uint32_t since)
 {
 	// Need something to write to...
 	OutputBuffer *response;
@@ -512,74 +520,68 @@ OutputBuffer *RepRap::GetStatusResponse(uint8_t type, ResponseSource source)
 		return nullptr;
 	}
 
+	statusTracker->Begin(since);
+	JsonWriter json(response);
+	json.StartObject();
+
 	// Machine status
-	char ch = GetStatusCharacter();
-	response->printf("{\"status\":\"%c\",\"coords\":{", ch);
+	const char status[2] = { GetStatusCharacter(), 0 };
+	json.String("status", status);
 
 	/* Coordinates */
 	{
 		float liveCoordinates[DRIVES + 1];
-#if SUPPORT_ROLAND
-		if (roland->Active())
+		GetUserCoordinates(liveCoordinates);
+
+		// If in Delta mode, skip the XYZ coordinates if some axes are not homed
+		const bool xyzValid = gCodes->AllAxesAreHomed() || !move->IsDeltaMode();
+
+		StatusFingerprint fingerprint;
+		for (size_t axis = 0; axis < AXES; axis++)
 		{
-			roland->GetCurrentRolandPosition(liveCoordinates);
+			fingerprint.Add((int32_t)gCodes->GetAxisIsHomed(axis));
+			fingerprint.Add((xyzValid) ? liveCoordinates[axis] : 0.0, 0.01);
 		}
-		else
-#endif
+		fingerprint.Add((int32_t)GetExtrudersInUse());
+		for (size_t extruder = 0; extruder < GetExtrudersInUse(); extruder++)
 		{
-			move->LiveCoordinates(liveCoordinates);
+			fingerprint.Add(liveCoordinates[AXES + extruder], 0.1);
 		}
 
-		if (currentTool != nullptr)
+		if (statusTracker->NeedSection(statusCoords, fingerprint))
 		{
-			const float *offset = currentTool->GetOffset();
-			for (size_t i = 0; i < AXES; ++i)
+			json.StartObject("coords");
+
+			// Homed axes
+			json.StartArray("axesHomed");
+			for (size_t axis = 0; axis < AXES; axis++)
 			{
-				liveCoordinates[i] += offset[i];
+				json.Int(nullptr, (gCodes->GetAxisIsHomed(axis)) ? 1 : 0);
 			}
-		}
+			json.EndArray();
 
-		// Homed axes
-		response->catf("\"axesHomed\":[%d,%d,%d]",
-				(gCodes->GetAxisIsHomed(0)) ? 1 : 0,
-				(gCodes->GetAxisIsHomed(1)) ? 1 : 0,
-				(gCodes->GetAxisIsHomed(2)) ? 1 : 0);
-
-		// Actual and theoretical extruder positions since power up, last G92 or last M23
-		response->catf(",\"extr\":");		// announce actual extruder positions
-		ch = '[';
-		for (size_t extruder = 0; extruder < GetExtrudersInUse(); extruder++)
-		{
-			response->catf("%c%.1f", ch, liveCoordinates[AXES + extruder]);
-			ch = ',';
-		}
-		if (ch == '[')
-		{
-			response->cat("[");
-		}
+			// Actual and theoretical extruder positions since power up, last G92 or last M23
+			json.StartArray("extr");
+			for (size_t extruder = 0; extruder < GetExtrudersInUse(); extruder++)
+			{
+				json.Float(nullptr, liveCoordinates[AXES + extruder], 1);
+			}
+			json.EndArray();
 
-		// XYZ positions
-		response->cat("],\"xyz\":");
-		if (!gCodes->AllAxesAreHomed() && move->IsDeltaMode())
-		{
-			// If in Delta mode, skip these coordinates if some axes are not homed
-			response->cat("[0.00,0.00,0.00");
-		}
-		else
-		{
-			// On Cartesian printers, the live coordinates are (usually) valid
-			ch = '[';
+			// XYZ positions. On Cartesian printers, the live coordinates are (usually) valid
+			json.StartArray("xyz");
 			for (size_t axis = 0; axis < AXES; axis++)
 			{
-				response->catf("%c%.2f", ch, liveCoordinates[axis]);
-				ch = ',';
+				json.Float(nullptr, (xyzValid) ? liveCoordinates[axis] : 0.0, 2);
 			}
+			json.EndArray();
+
+			json.EndObject();
 		}
 	}
 
 	// Current tool number
-	int toolNumber = (currentTool == nullptr) ? -1 : currentTool->Number();
-	response->catf("]},\"currentTool\":%d", toolNumber);
+	json.Int("currentTool", (currentTool == nullptr) ? -1 : currentTool->Number());
 
 	/* Output - only reported once */
 	{
@@ -588,175 +590,215 @@ OutputBuffer *RepRap::GetStatusResponse(uint8_t type, ResponseSource source)
 		bool sourceRight = (gCodes->HaveAux() && source == ResponseSource::AUX) || (!gCodes->HaveAux() && source == ResponseSource::HTTP);
 		if ((sendBeep || message[0] != 0) && sourceRight)
 		{
-			response->cat(",\"output\":{");
+			json.StartObject("output");
 
 			// Report beep values
 			if (sendBeep)
 			{
-				response->catf("\"beepDuration\":%d,\"beepFrequency\":%d", beepDuration, beepFrequency);
-				if (sendMessage)
-				{
-					response->cat(",");
-				}
-
+				json.Int("beepDuration", beepDuration);
+				json.Int("beepFrequency", beepFrequency);
 				beepFrequency = beepDuration = 0;
 			}
 
 			// Report message
 			if (sendMessage)
 			{
-				response->cat("\"message\":");
-				response->EncodeString(message, ARRAY_SIZE(message), false);
+				json.String("message", message, ARRAY_SIZE(message));
 				message[0] = 0;
 			}
-			response->cat("}");
+			json.EndObject();
 		}
 	}
 
 	/* Parameters */
 	{
-		// ATX power
-		response->catf(",\"params\":{\"atxPower\":%d", platform->AtxPower() ? 1 : 0);
+		StatusFingerprint fingerprint;
+		fingerprint.Add((int32_t)platform->AtxPower());
+		for (size_t i = 0; i < NUM_FANS; i++)
+		{
+			fingerprint.Add(platform->GetFanValue(i), 0.0001);
+		}
+		fingerprint.Add(gCodes->GetSpeedFactor(), 0.0001);
+		fingerprint.Add((int32_t)GetExtrudersInUse());
+		for (size_t extruder = 0; extruder < GetExtrudersInUse(); extruder++)
+		{
+			fingerprint.Add(gCodes->GetExtrusionFactor(extruder), 0.0001);
+		}
 
-		// Cooling fan value
-		response->cat(",\"fanPercent\":[");
-		for(size_t i = 0; i < NUM_FANS; i++)
+		if (statusTracker->NeedSection(statusParams, fingerprint))
 		{
-			if (i == NUM_FANS - 1)
+			json.StartObject("params");
+
+			// ATX power
+			json.Int("atxPower", platform->AtxPower() ? 1 : 0);
+
+			// Cooling fan value
+			json.StartArray("fanPercent");
+			for (size_t i = 0; i < NUM_FANS; i++)
 			{
-				response->catf("%.2f", platform->GetFanValue(i) * 100.0);
+				json.Float(nullptr, platform->GetFanValue(i) * 100.0, 2);
 			}
-			else
+			json.EndArray();
+
+			// Speed and Extrusion factors
+			json.Float("speedFactor", gCodes->GetSpeedFactor() * 100.0, 2);
+			json.StartArray("extrFactors");
+			for (size_t extruder = 0; extruder < GetExtrudersInUse(); extruder++)
 			{
-				response->catf("%.2f,", platform->GetFanValue(i) * 100.0);
+				json.Float(nullptr, gCodes->GetExtrusionFactor(extruder) * 100.0, 2);
 			}
-		}
+			json.EndArray();
 
-		// Speed and Extrusion factors
-		response->catf("],\"speedFactor\":%.2f,\"extrFactors\":", gCodes->GetSpeedFactor() * 100.0);
-		ch = '[';
-		for (size_t extruder = 0; extruder < GetExtrudersInUse(); extruder++)
-		{
-			response->catf("%c%.2f", ch, gCodes->GetExtrusionFactor(extruder) * 100.0);
-			ch = ',';
+			json.EndObject();
 		}
-		response->cat((ch == '[') ? "[]}" : "]}");
 	}
 
 #if defined(WEBSERVER)
 	// G-code reply sequence for webserver (seqence number for AUX is handled later)
 	if (source == ResponseSource::HTTP)
 	{
-		response->catf(",\"seq\":%d", webserver->GetReplySeq());
+		json.Int("seq", webserver->GetReplySeq());
 
 		// There currently appears to be no need for this one, so skip it
-		//response->catf(",\"buff\":%u", webserver->GetGCodeBufferSpace(WebSource::HTTP));
+		//json.UInt("buff", webserver->GetGCodeBufferSpace(WebSource::HTTP));
 	}
 #endif
 
 	/* Sensors */
 	{
-		response->cat(",\"sensors\":{");
-
 		// Probe
-		int v0 = platform->ZProbe();
+		const int v0 = platform->ZProbe();
 		int v1, v2;
-		switch (platform->GetZProbeSecondaryValues(v1, v2))
+		const int numSecondary = platform->GetZProbeSecondaryValues(v1, v2);
+		const unsigned int fanRPM = static_cast<unsigned int>(platform->GetFanRPM());
+
+		StatusFingerprint fingerprint;
+		fingerprint.Add((int32_t)v0);
+		fingerprint.Add((int32_t)numSecondary);
+		fingerprint.Add((int32_t)((numSecondary >= 1) ? v1 : 0));
+		fingerprint.Add((int32_t)((numSecondary >= 2) ? v2 : 0));
+		fingerprint.Add((int32_t)fanRPM);
+
+		if (statusTracker->NeedSection(statusSensors, fingerprint))
 		{
-			case 1:
-				response->catf("\"probeValue\":%d,\"probeSecondary\":[%d]", v0, v1);
-				break;
-			case 2:
-				response->catf("\"probeValue\":%d,\"probeSecondary\":[%d,%d]", v0, v1, v2);
-				break;
-			default:
-				response->catf("\"probeValue\":%d", v0);
-				break;
-		}
+			json.StartObject("sensors");
+			json.Int("probeValue", v0);
+			if (numSecondary >= 1)
+			{
+				json.StartArray("probeSecondary");
+				json.Int(nullptr, v1);
+				if (numSecondary >= 2)
+				{
+					json.Int(nullptr, v2);
+				}
+				json.EndArray();
+			}
 
-		// Fan RPM
-		response->catf(",\"fanRPM\":%d}", static_cast<unsigned int>(platform->GetFanRPM()));
+			// Fan RPM
+			json.UInt("fanRPM", fanRPM);
+			json.EndObject();
+		}
 	}
 
 	/* Temperatures */
 	{
-		response->cat(",\"temps\":{");
-
-		/* Bed */
 		const int8_t bedHeater = heat->GetBedHeater();
-		if (bedHeater != -1)
+		const int8_t chamberHeater = heat->GetChamberHeater();
+
+		StatusFingerprint fingerprint;
+		const int8_t bedAndChamber[2] = { bedHeater, chamberHeater };
+		for (size_t i = 0; i < ARRAY_SIZE(bedAndChamber); i++)
 		{
-			response->catf("\"bed\":{\"current\":%.1f,\"active\":%.1f,\"state\":%d},",
-					heat->GetTemperature(bedHeater), heat->GetActiveTemperature(bedHeater),
-					heat->GetStatus(bedHeater));
+			const int8_t heater = bedAndChamber[i];
+			fingerprint.Add((int32_t)heater);
+			if (heater != -1)
+			{
+				fingerprint.Add(heat->GetTemperature(heater), 0.1);
+				fingerprint.Add(heat->GetActiveTemperature(heater), 0.1);
+				fingerprint.Add((int32_t)heat->GetStatus(heater));
+			}
 		}
-
-		/* Chamber */
-		const int8_t chamberHeater = heat->GetChamberHeater();
-		if (chamberHeater != -1)
+		fingerprint.Add((int32_t)GetToolHeatersInUse());
+		for (size_t heater = E0_HEATER; heater < GetToolHeatersInUse(); heater++)
 		{
-			response->catf("\"chamber\":{\"current\":%.1f,", heat->GetTemperature(chamberHeater));
-			response->catf("\"active\":%.1f,", heat->GetActiveTemperature(chamberHeater));
-			response->catf("\"state\":%d},", static_cast<int>(heat->GetStatus(chamberHeater)));
+			fingerprint.Add(heat->GetTemperature(heater), 0.1);
+			fingerprint.Add(heat->GetActiveTemperature(heater), 0.1);
+			fingerprint.Add(heat->GetStandbyTemperature(heater), 0.1);
+			fingerprint.Add((int32_t)heat->GetStatus(heater));
 		}
 
-		/* Heads */
+		if (statusTracker->NeedSection(statusTemps, fingerprint))
 		{
-			response->cat("\"heads\":{\"current\":");
+			json.StartObject("temps");
 
-			// Current temperatures
-			ch = '[';
-			for (size_t heater = E0_HEATER; heater < GetToolHeatersInUse(); heater++)
+			/* Bed */
+			if (bedHeater != -1)
 			{
-				response->catf("%c%.1f", ch, heat->GetTemperature(heater));
-				ch = ',';
+				json.StartObject("bed");
+				json.Float("current", heat->GetTemperature(bedHeater), 1);
+				json.Float("active", heat->GetActiveTemperature(bedHeater), 1);
+				json.Int("state", static_cast<int>(heat->GetStatus(bedHeater)));
+				json.EndObject();
 			}
-			response->cat((ch == '[') ? "[]" : "]");
 
-			// Active temperatures
-			response->catf(",\"active\":");
-			ch = '[';
-			for (size_t heater = E0_HEATER; heater < GetToolHeatersInUse(); heater++)
+			/* Chamber */
+			if (chamberHeater != -1)
 			{
-				response->catf("%c%.1f", ch, heat->GetActiveTemperature(heater));
-				ch = ',';
+				json.StartObject("chamber");
+				json.Float("current", heat->GetTemperature(chamberHeater), 1);
+				json.Float("active", heat->GetActiveTemperature(chamberHeater), 1);
+				json.Int("state", static_cast<int>(heat->GetStatus(chamberHeater)));
+				json.EndObject();
 			}
-			response->cat((ch == '[') ? "[]" : "]");
 
-			// Standby temperatures
-			response->catf(",\"standby\":");
-			ch = '[';
-			for (size_t heater = E0_HEATER; heater < GetToolHeatersInUse(); heater++)
+			/* Heads */
 			{
-				response->catf("%c%.1f", ch, heat->GetStandbyTemperature(heater));
-				ch = ',';
-			}
-			response->cat((ch == '[') ? "[]" : "]");
+				json.StartObject("heads");
 
-			// Heater statuses (0=off, 1=standby, 2=active, 3=fault)
-			response->cat(",\"state\":");
-			ch = '[';
-			for (size_t heater = E0_HEATER; heater < GetToolHeatersInUse(); heater++)
-			{
-				response->catf("%c%d", ch, static_cast<int>(heat->GetStatus(heater)));
-				ch = ',';
+				// Current temperatures
+				json.StartArray("current");
+				for (size_t heater = E0_HEATER; heater < GetToolHeatersInUse(); heater++)
+				{
+					json.Float(nullptr, heat->GetTemperature(heater), 1);
+				}
+				json.EndArray();
+
+				// Active temperatures
+				json.StartArray("active");
+				for (size_t heater = E0_HEATER; heater < GetToolHeatersInUse(); heater++)
+				{
+					json.Float(nullptr, heat->GetActiveTemperature(heater), 1);
+				}
+				json.EndArray();
+
+				// Standby temperatures
+				json.StartArray("standby");
+				for (size_t heater = E0_HEATER; heater < GetToolHeatersInUse(); heater++)
+				{
+					json.Float(nullptr, heat->GetStandbyTemperature(heater), 1);
+				}
+				json.EndArray();
+
+				// Heater statuses (0=off, 1=standby, 2=active, 3=fault)
+				json.StartArray("state");
+				for (size_t heater = E0_HEATER; heater < GetToolHeatersInUse(); heater++)
+				{
+					json.Int(nullptr, static_cast<int>(heat->GetStatus(heater)));
+				}
+				json.EndArray();
+
+				json.EndObject();
 			}
-			response->cat((ch == '[') ? "[]" : "]");
+			json.EndObject();
 		}
-		response->cat("}}");
 	}
 
 	// Time since last reset
-	response->catf(",\"time\":%.1f", platform->Time());
+	json.Float("time", platform->Time(), 1);
 
 	/* Extended Status Response */
 	if (type == 2)
 	{
-		// Cold Extrude/Retract
-		response->catf(",\"coldExtrudeTemp\":%1.f", heat->ColdExtrude() ? 0 : HOT_ENOUGH_TO_EXTRUDE);
-		response->catf(",\"coldRetractTemp\":%1.f", heat->ColdExtrude() ? 0 : HOT_ENOUGH_TO_RETRACT);
-
-		// Endstops
 		uint16_t endstops = 0;
 		for(size_t drive = 0; drive < DRIVES; drive++)
 		{
@@ -766,136 +808,466 @@ OutputBuffer *RepRap::GetStatusResponse(uint8_t type, ResponseSource source)
 				endstops |= (1 << drive);
 			}
 		}
-		response->catf(",\"endstops\":%d", endstops);
+		const ZProbeParameters probeParams = platform->GetZProbeParameters();
+
+		StatusFingerprint fingerprint;
+		fingerprint.Add((int32_t)heat->ColdExtrude());
+		fingerprint.Add((int32_t)endstops);
+		fingerprint.Add(move->GetGeometryString());
+		fingerprint.Add(myName);
+		fingerprint.Add((int32_t)probeParams.adcValue);
+		fingerprint.Add(probeParams.height, 0.01);
+		fingerprint.Add((int32_t)platform->GetZProbeType());
+		for(Tool *tool = toolList; tool != nullptr; tool = tool->Next())
+		{
+			fingerprint.Add((int32_t)tool->Number());
+			fingerprint.Add((int32_t)tool->HeaterCount());
+			for(size_t heater=0; heater<tool->HeaterCount(); heater++)
+			{
+				fingerprint.Add((int32_t)tool->Heater(heater));
+			}
+			fingerprint.Add((int32_t)tool->DriveCount());
+			for(size_t drive=0; drive<tool->DriveCount(); drive++)
+			{
+				fingerprint.Add((int32_t)tool->Drive(drive));
+			}
+		}
 
-		// Delta configuration
-		response->catf(",\"geometry\":\"%s\"", move->GetGeometryString());
+		if (statusTracker->NeedSection(statusExtended, fingerprint))
+		{
+			// Cold Extrude/Retract
+			json.Float("coldExtrudeTemp", heat->ColdExtrude() ? 0 : HOT_ENOUGH_TO_EXTRUDE, 0);
+			json.Float("coldRetractTemp", heat->ColdExtrude() ? 0 : HOT_ENOUGH_TO_RETRACT, 0);
 
-		// Machine name
-		response->cat(",\"name\":");
-		response->EncodeString(myName, ARRAY_SIZE(myName), false);
+			// Endstops
+			json.UInt("endstops", endstops);
 
-		/* Probe */
-		{
-			const ZProbeParameters probeParams = platform->GetZProbeParameters();
+			// Delta configuration
+			json.String("geometry", move->GetGeometryString());
 
-			// Trigger threshold
-			response->catf(",\"probe\":{\"threshold\":%d", probeParams.adcValue);
+			// Machine name
+			json.String("name", myName, ARRAY_SIZE(myName));
 
-			// Trigger height
-			response->catf(",\"height\":%.2f", probeParams.height);
+			/* Probe */
+			{
+				json.StartObject("probe");
 
-			// Type
-			response->catf(",\"type\":%d}", platform->GetZProbeType());
-		}
+				// Trigger threshold
+				json.Int("threshold", probeParams.adcValue);
 
-		/* Tool Mapping */
-		{
-			response->cat(",\"tools\":[");
-			for(Tool *tool = toolList; tool != nullptr; tool = tool->Next())
+				// Trigger height
+				json.Float("height", probeParams.height, 2);
+
+				// Type
+				json.Int("type", platform->GetZProbeType());
+
+				json.EndObject();
+			}
+
+			/* Tool Mapping */
 			{
-				// Heaters
-				response->catf("{\"number\":%d,\"heaters\":[", tool->Number());
-				for(size_t heater=0; heater<tool->HeaterCount(); heater++)
+				json.StartArray("tools");
+				for(Tool *tool = toolList; tool != nullptr; tool = tool->Next())
 				{
-					response->catf("%d", tool->Heater(heater));
-					if (heater + 1 < tool->HeaterCount())
+					json.StartObject();
+					json.Int("number", tool->Number());
+
+					// Heaters
+					json.StartArray("heaters");
+					for(size_t heater=0; heater<tool->HeaterCount(); heater++)
 					{
-						response->cat(",");
+						json.Int(nullptr, tool->Heater(heater));
 					}
-				}
+					json.EndArray();
 
-				// Extruder drives
-				response->cat("],\"drives\":[");
-				for(size_t drive=0; drive<tool->DriveCount(); drive++)
-				{
-					response->catf("%d", tool->Drive(drive));
-					if (drive + 1 < tool->DriveCount())
+					// Extruder drives
+					json.StartArray("drives");
+					for(size_t drive=0; drive<tool->DriveCount(); drive++)
 					{
-						response->cat(",");
+						json.Int(nullptr, tool->Drive(drive));
 					}
-				}
+					json.EndArray();
 
-				// Do we have any more tools?
-				if (tool->Next() != nullptr)
-				{
-					response->cat("]},");
-				}
-				else
-				{
-					response->cat("]}");
+					json.EndObject();
 				}
+				json.EndArray();
 			}
-			response->cat("]");
 		}
 	}
 	else if (type == 3)
 	{
-		// Current Layer
-		response->catf(",\"currentLayer\":%d", printMonitor->GetCurrentLayer());
-
-		// Current Layer Time
-		response->catf(",\"currentLayerTime\":%.1f", printMonitor->GetCurrentLayerTime());
+		const float fractionPrinted = (printMonitor->IsPrinting()) ? (gCodes->FractionOfFilePrinted() * 100.0) : 0.0;
 
-		// Raw Extruder Positions
-		response->cat(",\"extrRaw\":");
-		ch = '[';
-		for (size_t extruder = 0; extruder < GetExtrudersInUse(); extruder++)		// loop through extruders
+		StatusFingerprint fingerprint;
+		fingerprint.Add((int32_t)printMonitor->GetCurrentLayer());
+		fingerprint.Add(printMonitor->GetCurrentLayerTime(), 0.1);
+		fingerprint.Add((int32_t)GetExtrudersInUse());
+		for (size_t extruder = 0; extruder < GetExtrudersInUse(); extruder++)
 		{
-			response->catf("%c%.1f", ch, gCodes->GetRawExtruderTotalByDrive(extruder));
-			ch = ',';
+			fingerprint.Add(gCodes->GetRawExtruderTotalByDrive(extruder), 0.1);
 		}
-		if (ch == '[')
+		fingerprint.Add(fractionPrinted, 0.1);
+		fingerprint.Add(printMonitor->GetFirstLayerDuration(), 0.1);
+		fingerprint.Add(printMonitor->GetFirstLayerHeight(), 0.01);
+		fingerprint.Add(printMonitor->GetPrintDuration(), 0.1);
+		fingerprint.Add(printMonitor->GetWarmUpDuration(), 0.1);
+		fingerprint.Add(printMonitor->EstimateTimeLeft(fileBased), 0.1);
+		fingerprint.Add(printMonitor->EstimateTimeLeft(filamentBased), 0.1);
+		fingerprint.Add(printMonitor->EstimateTimeLeft(layerBased), 0.1);
+
+		if (statusTracker->NeedSection(statusPrint, fingerprint))
 		{
-			response->cat("]");
-		}
+			// Current Layer
+			json.Int("currentLayer", printMonitor->GetCurrentLayer());
+
+			// Current Layer Time
+			json.Float("currentLayerTime", printMonitor->GetCurrentLayerTime(), 1);
+
+			// Raw Extruder Positions
+			json.StartArray("extrRaw");
+			for (size_t extruder = 0; extruder < GetExtrudersInUse(); extruder++)		// loop through extruders
+			{
+				json.Float(nullptr, gCodes->GetRawExtruderTotalByDrive(extruder), 1);
+			}
+			json.EndArray();
 
-		// Fraction of file printed
-		response->catf("],\"fractionPrinted\":%.1f", (printMonitor->IsPrinting()) ? (gCodes->FractionOfFilePrinted() * 100.0) : 0.0);
+			// Fraction of file printed
+			json.Float("fractionPrinted", fractionPrinted, 1);
 
-		// First Layer Duration
-		response->catf(",\"firstLayerDuration\":%.1f", printMonitor->GetFirstLayerDuration());
+			// First Layer Duration
+			json.Float("firstLayerDuration", printMonitor->GetFirstLayerDuration(), 1);
 
-		// First Layer Height
-		// NB: This shouldn't be needed any more, but leave it here for the case that the file-based first-layer detection fails
-		response->catf(",\"firstLayerHeight\":%.2f", printMonitor->GetFirstLayerHeight());
+			// First Layer Height
+			// NB: This shouldn't be needed any more, but leave it here for the case that the file-based first-layer detection fails
+			json.Float("firstLayerHeight", printMonitor->GetFirstLayerHeight(), 2);
 
-		// Print Duration
-		response->catf(",\"printDuration\":%.1f", printMonitor->GetPrintDuration());
+			// Print Duration
+			json.Float("printDuration", printMonitor->GetPrintDuration(), 1);
 
-		// Warm-Up Time
-		response->catf(",\"warmUpDuration\":%.1f", printMonitor->GetWarmUpDuration());
+			// Warm-Up Time
+			json.Float("warmUpDuration", printMonitor->GetWarmUpDuration(), 1);
 
-		/* Print Time Estimations */
-		{
-			// Based on file progress
-			response->catf(",\"timesLeft\":{\"file\":%.1f", printMonitor->EstimateTimeLeft(fileBased));
+			/* Print Time Estimations */
+			{
+				json.StartObject("timesLeft");
 
-			// Based on filament usage
-			response->catf(",\"filament\":%.1f", printMonitor->EstimateTimeLeft(filamentBased));
+				// Based on file progress
+				json.Float("file", printMonitor->EstimateTimeLeft(fileBased), 1);
 
-			// Based on layers
-			response->catf(",\"layer\":%.1f}", printMonitor->EstimateTimeLeft(layerBased));
+				// Based on filament usage
+				json.Float("filament", printMonitor->EstimateTimeLeft(filamentBased), 1);
+
+				// Based on layers
+				json.Float("layer", printMonitor->EstimateTimeLeft(layerBased), 1);
+
+				json.EndObject();
+			}
 		}
 	}
 
+	// Sequence number to pass back as 'since' to get only the sections that have changed
+	json.UInt("statusSeq", statusTracker->End());
+
 	if (source == ResponseSource::AUX)
 	{
-		OutputBuffer *response = gCodes->GetAuxGCodeReply();
-		if (response != nullptr)
+		OutputBuffer *reply = gCodes->GetAuxGCodeReply();
+		if (reply != nullptr)
 		{
 			// Send the response to the last command. Do this last
-			response->catf(",\"seq\":%u,\"resp\":", gCodes->GetAuxSeq());			// send the response sequence number
+			json.UInt("seq", gCodes->GetAuxSeq());			// send the response sequence number
 
 			// Send the JSON response
-			response->EncodeReply(response, true);									// also releases the OutputBuffer chain
+			json.Key("resp");
+			response->EncodeReply(reply, true);				// also releases the OutputBuffer chain
 		}
 	}
-	response->cat("}");
+	json.EndObject();
 
 	return response;
 }
 
+// Get the live coordinates including the offset of the current tool
+void RepRap::GetUserCoordinates(float liveCoordinates[DRIVES + 1]) const
+{
+#if SUPPORT_ROLAND
+	if (roland->Active())
+	{
+		roland->GetCurrentRolandPosition(liveCoordinates);
+	}
+	else
+#endif
+	{
+		move->LiveCoordinates(liveCoordinates);
+	}
+
+	if (currentTool != nullptr)
+	{
+		const float *offset = currentTool->GetOffset();
+		for (size_t i = 0; i < AXES; ++i)
+		{
+			liveCoordinates[i] += offset[i];
+		}
+	}
+}
+
+// Get the status of the machine as a binary frame for AUX devices that have asked for it with bit 2 of M575 S.
+// The types are the same as for GetStatusResponse, and if 'since' is the statusSeq of an earlier frame then only
+// the sections that have changed since then are sent. The payload of protocol version 1 is:
+//  Byte version, Byte type, Byte status character, UInt statusSeq, Byte bitmap of the sections that follow,
+//  Int current tool, Fixed(1) time since reset, Byte flags (bit 0 beep, bit 1 message, bit 2 G-code reply),
+//  [UInt beep duration, UInt beep frequency], [String message], [UInt reply sequence number, String reply],
+//  then the sections in StatusSection order, see EncodeStatusSection.
+OutputBuffer *RepRap::GetBinaryStatusResponse(uint8_t type, uint32_t since)
+{
+	OutputBuffer *response, *sectionData;
+	if (!OutputBuffer::Allocate(response))
+	{
+		return nullptr;
+	}
+	if (!OutputBuffer::Allocate(sectionData))
+	{
+		OutputBuffer::Release(response);
+		return nullptr;
+	}
+
+	// Encode each section once and fingerprint its bytes to find out which sections have to be sent
+	BinaryWriter encoder(sectionData, false);
+	size_t sectionStart[numStatusSections], sectionLength[numStatusSections];
+	uint8_t sections = 0;
+	auxStatusTracker->Begin(since);
+	for (size_t section = 0; section < numStatusSections; section++)
+	{
+		sectionStart[section] = sectionData->Length();
+		sectionLength[section] = 0;
+		if ((section == statusExtended && type != 2) || (section == statusPrint && type != 3))
+		{
+			continue;
+		}
+
+		EncodeStatusSection((StatusSection)section, encoder);
+		sectionLength[section] = sectionData->Length() - sectionStart[section];
+		StatusFingerprint fingerprint;
+		BinaryWriter::Fingerprint(sectionData, sectionStart[section], sectionLength[section], fingerprint);
+		if (auxStatusTracker->NeedSection((StatusSection)section, fingerprint))
+		{
+			sections |= (1 << section);
+		}
+	}
+
+	BinaryWriter bin(response);
+	bin.Byte(binaryStatusVersion);
+	bin.Byte(type);
+	bin.Byte(GetStatusCharacter());
+	bin.UInt(auxStatusTracker->End());
+	bin.Byte(sections);
+	bin.Int((currentTool == nullptr) ? -1 : currentTool->Number());
+	bin.Fixed(platform->Time(), 1);
+
+	// Beep, message and G-code reply - only reported once
+	const bool sendBeep = (beepDuration != 0 && beepFrequency != 0);
+	const bool sendMessage = (message[0] != 0);
+	OutputBuffer * const reply = gCodes->GetAuxGCodeReply();
+	bin.Byte(((sendBeep) ? 1 : 0) | ((sendMessage) ? 2 : 0) | ((reply != nullptr) ? 4 : 0));
+	if (sendBeep)
+	{
+		bin.UInt(beepDuration);
+		bin.UInt(beepFrequency);
+		beepFrequency = beepDuration = 0;
+	}
+	if (sendMessage)
+	{
+		bin.String(message, ARRAY_SIZE(message));
+		message[0] = 0;
+	}
+	if (reply != nullptr)
+	{
+		bin.UInt(gCodes->GetAuxSeq());
+		bin.Reply(reply);								// also releases the OutputBuffer chain
+	}
+
+	for (size_t section = 0; section < numStatusSections; section++)
+	{
+		if ((sections & (1 << section)) != 0)
+		{
+			bin.Bytes(sectionData, sectionStart[section], sectionLength[section]);
+		}
+	}
+	OutputBuffer::ReleaseAll(sectionData);
+	bin.Finish();
+
+	return response;
+}
+
+// Encode one section of the binary status frame. Each one has the same values as the JSON section of the same name.
+void RepRap::EncodeStatusSection(StatusSection section, BinaryWriter& bin) const
+{
+	switch (section)
+	{
+	case statusCoords:
+		// Byte homed axes (bit 7 set if the XYZ coordinates are valid), UInt n, n * Fixed(2) XYZ, UInt m, m * Fixed(1) extruders
+		{
+			float liveCoordinates[DRIVES + 1];
+			GetUserCoordinates(liveCoordinates);
+			const bool xyzValid = gCodes->AllAxesAreHomed() || !move->IsDeltaMode();
+			uint8_t homed = (xyzValid) ? 0x80 : 0;
+			for (size_t axis = 0; axis < AXES; axis++)
+			{
+				if (gCodes->GetAxisIsHomed(axis))
+				{
+					homed |= (1 << axis);
+				}
+			}
+			bin.Byte(homed);
+			bin.UInt(AXES);
+			for (size_t axis = 0; axis < AXES; axis++)
+			{
+				bin.Fixed((xyzValid) ? liveCoordinates[axis] : 0.0, 2);
+			}
+			bin.UInt(GetExtrudersInUse());
+			for (size_t extruder = 0; extruder < GetExtrudersInUse(); extruder++)
+			{
+				bin.Fixed(liveCoordinates[AXES + extruder], 1);
+			}
+		}
+		break;
+
+	case statusParams:
+		// Byte ATX power, UInt n, n * Fixed(2) fan percent, Fixed(2) speed factor percent, UInt m, m * Fixed(2) extrusion factor percent
+		bin.Byte(platform->AtxPower() ? 1 : 0);
+		bin.UInt(NUM_FANS);
+		for (size_t i = 0; i < NUM_FANS; i++)
+		{
+			bin.Fixed(platform->GetFanValue(i) * 100.0, 2);
+		}
+		bin.Fixed(gCodes->GetSpeedFactor() * 100.0, 2);
+		bin.UInt(GetExtrudersInUse());
+		for (size_t extruder = 0; extruder < GetExtrudersInUse(); extruder++)
+		{
+			bin.Fixed(gCodes->GetExtrusionFactor(extruder) * 100.0, 2);
+		}
+		break;
+
+	case statusSensors:
+		// Int probe value, UInt n, n * Int secondary probe values, UInt fan RPM
+		{
+			int v1, v2;
+			const int numSecondary = platform->GetZProbeSecondaryValues(v1, v2);
+			bin.Int(platform->ZProbe());
+			bin.UInt(numSecondary);
+			if (numSecondary >= 1)
+			{
+				bin.Int(v1);
+			}
+			if (numSecondary >= 2)
+			{
+				bin.Int(v2);
+			}
+			bin.UInt(static_cast<unsigned int>(platform->GetFanRPM()));
+		}
+		break;
+
+	case statusTemps:
+		// Twice (bed, chamber): Int heater number or -1, [Fixed(1) current, Fixed(1) active, Byte state]
+		// then UInt n, n * (Fixed(1) current, Fixed(1) active, Fixed(1) standby, Byte state) for the tool heaters
+		{
+			const int8_t bedAndChamber[2] = { heat->GetBedHeater(), heat->GetChamberHeater() };
+			for (size_t i = 0; i < ARRAY_SIZE(bedAndChamber); i++)
+			{
+				const int8_t heater = bedAndChamber[i];
+				bin.Int(heater);
+				if (heater != -1)
+				{
+					bin.Fixed(heat->GetTemperature(heater), 1);
+					bin.Fixed(heat->GetActiveTemperature(heater), 1);
+					bin.Byte(heat->GetStatus(heater));
+				}
+			}
+			bin.UInt((GetToolHeatersInUse() > E0_HEATER) ? GetToolHeatersInUse() - E0_HEATER : 0);
+			for (size_t heater = E0_HEATER; heater < GetToolHeatersInUse(); heater++)
+			{
+				bin.Fixed(heat->GetTemperature(heater), 1);
+				bin.Fixed(heat->GetActiveTemperature(heater), 1);
+				bin.Fixed(heat->GetStandbyTemperature(heater), 1);
+				bin.Byte(heat->GetStatus(heater));
+			}
+		}
+		break;
+
+	case statusExtended:
+		// Fixed(0) cold extrude temperature, Fixed(0) cold retract temperature, UInt endstops, String geometry, String name,
+		// Int probe threshold, Fixed(2) probe height, Int probe type,
+		// UInt n, n * (Int tool number, UInt h, h * Int heater, UInt d, d * UInt drive)
+		{
+			bin.Fixed(heat->ColdExtrude() ? 0 : HOT_ENOUGH_TO_EXTRUDE, 0);
+			bin.Fixed(heat->ColdExtrude() ? 0 : HOT_ENOUGH_TO_RETRACT, 0);
+
+			uint32_t endstops = 0;
+			for (size_t drive = 0; drive < DRIVES; drive++)
+			{
+				const EndStopHit stopped = platform->Stopped(drive);
+				if (stopped == EndStopHit::highHit || stopped == EndStopHit::lowHit)
+				{
+					endstops |= (1 << drive);
+				}
+			}
+			bin.UInt(endstops);
+			bin.String(move->GetGeometryString());
+			bin.String(myName, ARRAY_SIZE(myName));
+
+			const ZProbeParameters probeParams = platform->GetZProbeParameters();
+			bin.Int(probeParams.adcValue);
+			bin.Fixed(probeParams.height, 2);
+			bin.Int(platform->GetZProbeType());
+
+			size_t numTools = 0;
+			for (const Tool *tool = toolList; tool != nullptr; tool = tool->Next())
+			{
+				++numTools;
+			}
+			bin.UInt(numTools);
+			for (const Tool *tool = toolList; tool != nullptr; tool = tool->Next())
+			{
+				bin.Int(tool->Number());
+				bin.UInt(tool->HeaterCount());
+				for (size_t heater = 0; heater < tool->HeaterCount(); heater++)
+				{
+					bin.Int(tool->Heater(heater));
+				}
+				bin.UInt(tool->DriveCount());
+				for (size_t drive = 0; drive < tool->DriveCount(); drive++)
+				{
+					bin.UInt(tool->Drive(drive));
+				}
+			}
+		}
+		break;
+
+	case statusPrint:
+		// UInt current layer, Fixed(1) current layer time, UInt n, n * Fixed(1) raw extruder positions, Fixed(1) percentage printed,
+		// Fixed(1) first layer duration, Fixed(2) first layer height, Fixed(1) print duration, Fixed(1) warm-up duration,
+		// Fixed(1) time left based on file progress, on filament usage and on layers
+		bin.UInt(printMonitor->GetCurrentLayer());
+		bin.Fixed(printMonitor->GetCurrentLayerTime(), 1);
+		bin.UInt(GetExtrudersInUse());
+		for (size_t extruder = 0; extruder < GetExtrudersInUse(); extruder++)
+		{
+			bin.Fixed(gCodes->GetRawExtruderTotalByDrive(extruder), 1);
+		}
+		bin.Fixed((printMonitor->IsPrinting()) ? (gCodes->FractionOfFilePrinted() * 100.0) : 0.0, 1);
+		bin.Fixed(printMonitor->GetFirstLayerDuration(), 1);
+		bin.Fixed(printMonitor->GetFirstLayerHeight(), 2);
+		bin.Fixed(printMonitor->GetPrintDuration(), 1);
+		bin.Fixed(printMonitor->GetWarmUpDuration(), 1);
+		bin.Fixed(printMonitor->EstimateTimeLeft(fileBased), 1);
+		bin.Fixed(printMonitor->EstimateTimeLeft(filamentBased), 1);
+		bin.Fixed(printMonitor->EstimateTimeLeft(layerBased), 1);
+		break;
+
+	default:
+		break;
+	}
+}
+
 OutputBuffer *RepRap::GetConfigResponse()
 {
 	// We need some resources to return a valid config response...
@@ -905,72 +1277,70 @@ OutputBuffer *RepRap::GetConfigResponse()
 		return nullptr;
 	}
 
+	JsonWriter json(response);
+	json.StartObject();
+
 	// Axis minima
-	response->copy("{\"axisMins\":");
-	char ch = '[';
+	json.StartArray("axisMins");
 	for (size_t axis = 0; axis < AXES; axis++)
 	{
-		response->catf("%c%.2f", ch, platform->AxisMinimum(axis));
-		ch = ',';
+		json.Float(nullptr, platform->AxisMinimum(axis), 2);
 	}
+	json.EndArray();
 
 	// Axis maxima
-	response->cat("],\"axisMaxes\":");
-	ch = '[';
+	json.StartArray("axisMaxes");
 	for (size_t axis = 0; axis < AXES; axis++)
 	{
-		response->catf("%c%.2f", ch, platform->AxisMaximum(axis));
-		ch = ',';
+		json.Float(nullptr, platform->AxisMaximum(axis), 2);
 	}
+	json.EndArray();
 
 	// Accelerations
-	response->cat("],\"accelerations\":");
-	ch = '[';
+	json.StartArray("accelerations");
 	for (size_t drive = 0; drive < DRIVES; drive++)
 	{
-		response->catf("%c%.2f", ch, platform->Acceleration(drive));
-		ch = ',';
+		json.Float(nullptr, platform->Acceleration(drive), 2);
 	}
+	json.EndArray();
 
 	// Motor currents
-	response->cat("],\"currents\":");
-	ch = '[';
+	json.StartArray("currents");
 	for (size_t drive = 0; drive < DRIVES; drive++)
 	{
-		response->catf("%c%.2f", ch, platform->MotorCurrent(drive));
-		ch = ',';
+		json.Float(nullptr, platform->MotorCurrent(drive), 2);
 	}
+	json.EndArray();
 
 	// Firmware details
-	response->catf("],\"firmwareElectronics\":\"%s\"", ELECTRONICS);
-	response->catf(",\"firmwareName\":\"%s\"", NAME);
-	response->catf(",\"firmwareVersion\":\"%s\"", VERSION);
-	response->catf(",\"firmwareDate\":\"%s\"", DATE);
+	json.String("firmwareElectronics", ELECTRONICS);
+	json.String("firmwareName", NAME);
+	json.String("firmwareVersion", VERSION);
+	json.String("firmwareDate", DATE);
 
 	// Motor idle parameters
-	response->catf(",\"idleCurrentFactor\":%.1f", platform->GetIdleCurrentFactor() * 100.0);
-	response->catf(",\"idleTimeout\":%.1f", move->IdleTimeout());
+	json.Float("idleCurrentFactor", platform->GetIdleCurrentFactor() * 100.0, 1);
+	json.Float("idleTimeout", move->IdleTimeout(), 1);
 
 	// Minimum feedrates
-	response->cat(",\"minFeedrates\":");
-	ch = '[';
+	json.StartArray("minFeedrates");
 	for (size_t drive = 0; drive < DRIVES; drive++)
 	{
-		response->catf("%c%.2f", ch, platform->ConfiguredInstantDv(drive));
-		ch = ',';
+		json.Float(nullptr, platform->ConfiguredInstantDv(drive), 2);
 	}
+	json.EndArray();
 
 	// Maximum feedrates
-	response->cat("],\"maxFeedrates\":");
-	ch = '[';
+	json.StartArray("maxFeedrates");
 	for (size_t drive = 0; drive < DRIVES; drive++)
 	{
-		response->catf("%c%.2f", ch, platform->MaxFeedrate(drive));
-		ch = ',';
+		json.Float(nullptr, platform->MaxFeedrate(drive), 2);
 	}
+	json.EndArray();
 
 	// Configuration File (whitespaces are skipped, otherwise we easily risk overflowing the response buffer)
-	response->cat("],\"configFile\":\"");
+	json.Key("configFile");
+	response->cat('"');
 	FileStore *configFile = platform->GetFileStore(platform->GetSysDir(), platform->GetConfigFile(), false);
 	if (configFile == nullptr)
 	{
@@ -1009,7 +1379,8 @@ OutputBuffer *RepRap::GetConfigResponse()
 
 				if (esc)
 				{
-					response->catf("\\%c", esc);
+					response->cat('\\');
+					response->cat(esc);
 					bytesWritten += 2;
 				}
 				else
@@ -1022,7 +1393,8 @@ OutputBuffer *RepRap::GetConfigResponse()
 		}
 		configFile->Close();
 	}
-	response->cat("\"}");
+	response->cat('"');
+	json.EndObject();
 
 	return response;
 }
@@ -1043,6 +1415,9 @@ OutputBuffer *RepRap::GetLegacyStatusResponse(uint8_t type, int seq)
 		return nullptr;
 	}
 
+	JsonWriter json(response);
+	json.StartObject();
+
 	// Send the status. Note that 'S' has always meant that the machine is halted in this version of the status response, so we use A for pAused.
 	char ch = GetStatusCharacter();
 	if (ch == 'S')			// if paused then send 'A'
@@ -1053,79 +1428,57 @@ OutputBuffer *RepRap::GetLegacyStatusResponse(uint8_t type, int seq)
 	{
 		ch = 'S';
 	}
-	response->printf("{\"status\":\"%c\",\"heaters\":", ch);
+	const char status[2] = { ch, 0 };
+	json.String("status", status);
 
 	// Send the heater actual temperatures
 	const int8_t bedHeater = heat->GetBedHeater();
+	json.StartArray("heaters");
 	if (bedHeater != -1)
 	{
-		ch = ',';
-		response->catf("[%.1f", heat->GetTemperature(bedHeater));
-	}
-	else
-	{
-		ch = '[';
+		json.Float(nullptr, heat->GetTemperature(bedHeater), 1);
 	}
 	for (size_t heater = E0_HEATER; heater < GetToolHeatersInUse(); heater++)
 	{
-		response->catf("%c%.1f", ch, heat->GetTemperature(heater));
-		ch = ',';
+		json.Float(nullptr, heat->GetTemperature(heater), 1);
 	}
-	response->cat((ch == '[') ? "[]" : "]");
+	json.EndArray();
 
 	// Send the heater active temperatures
-	response->catf(",\"active\":");
-	if (heat->GetBedHeater() != -1)
-	{
-		ch = ',';
-		response->catf("[%.1f", heat->GetActiveTemperature(heat->GetBedHeater()));
-	}
-	else
+	json.StartArray("active");
+	if (bedHeater != -1)
 	{
-		ch = '[';
+		json.Float(nullptr, heat->GetActiveTemperature(bedHeater), 1);
 	}
 	for (size_t heater = E0_HEATER; heater < GetToolHeatersInUse(); heater++)
 	{
-		response->catf("%c%.1f", ch, heat->GetActiveTemperature(heater));
-		ch = ',';
+		json.Float(nullptr, heat->GetActiveTemperature(heater), 1);
 	}
-	response->cat((ch == '[') ? "[]" : "]");
+	json.EndArray();
 
 	// Send the heater standby temperatures
-	response->catf(",\"standby\":");
+	json.StartArray("standby");
 	if (bedHeater != -1)
 	{
-		ch = ',';
-		response->catf("[%.1f", heat->GetStandbyTemperature(bedHeater));
-	}
-	else
-	{
-		ch = '[';
+		json.Float(nullptr, heat->GetStandbyTemperature(bedHeater), 1);
 	}
 	for (size_t heater = E0_HEATER; heater < GetToolHeatersInUse(); heater++)
 	{
-		response->catf("%c%.1f", ch, heat->GetStandbyTemperature(heater));
-		ch = ',';
+		json.Float(nullptr, heat->GetStandbyTemperature(heater), 1);
 	}
-	response->cat((ch == '[') ? "[]" : "]");
+	json.EndArray();
 
 	// Send the heater statuses (0=off, 1=standby, 2=active)
-	response->cat(",\"hstat\":");
+	json.StartArray("hstat");
 	if (bedHeater != -1)
 	{
-		ch = ',';
-		response->catf("[%d", static_cast<int>(heat->GetStatus(bedHeater)));
-	}
-	else
-	{
-		ch = '[';
+		json.Int(nullptr, static_cast<int>(heat->GetStatus(bedHeater)));
 	}
 	for (size_t heater = E0_HEATER; heater < GetToolHeatersInUse(); heater++)
 	{
-		response->catf("%c%d", ch, static_cast<int>(heat->GetStatus(heater)));
-		ch = ',';
+		json.Int(nullptr, static_cast<int>(heat->GetStatus(heater)));
 	}
-	response->cat((ch == '[') ? "[]" : "]");
+	json.EndArray();
 
 	// Send XYZ positions
 	float liveCoordinates[DRIVES];
@@ -1139,92 +1492,101 @@ OutputBuffer *RepRap::GetLegacyStatusResponse(uint8_t type, int seq)
 			liveCoordinates[i] += offset[i];
 		}
 	}
-	response->catf(",\"pos\":");		// announce the XYZ position
-	ch = '[';
+	json.StartArray("pos");		// announce the XYZ position
 	for (size_t drive = 0; drive < AXES; drive++)
 	{
-		response->catf("%c%.2f", ch, liveCoordinates[drive]);
-		ch = ',';
+		json.Float(nullptr, liveCoordinates[drive], 2);
 	}
+	json.EndArray();
 
 	// Send extruder total extrusion since power up, last G92 or last M23
-	response->cat("],\"extr\":");		// announce the extruder positions
-	ch = '[';
+	json.StartArray("extr");		// announce the extruder positions
 	for (size_t drive = 0; drive < reprap.GetExtrudersInUse(); drive++)		// loop through extruders
 	{
-		response->catf("%c%.1f", ch, gCodes->GetRawExtruderPosition(drive));
-		ch = ',';
+		json.Float(nullptr, gCodes->GetRawExtruderPosition(drive), 1);
 	}
-	response->cat((ch == ']') ? "[]" : "]");
+	json.EndArray();
 
 	// Send the speed and extruder override factors
-	response->catf(",\"sfactor\":%.2f,\"efactor\":", gCodes->GetSpeedFactor() * 100.0);
-	ch = '[';
+	json.Float("sfactor", gCodes->GetSpeedFactor() * 100.0, 2);
+	json.StartArray("efactor");
 	for (size_t i = 0; i < reprap.GetExtrudersInUse(); ++i)
 	{
-		response->catf("%c%.2f", ch, gCodes->GetExtrusionFactor(i) * 100.0);
-		ch = ',';
+		json.Float(nullptr, gCodes->GetExtrusionFactor(i) * 100.0, 2);
 	}
-	response->cat((ch == '[') ? "[]" : "]");
+	json.EndArray();
 
 	// Send the current tool number
-	int toolNumber = (currentTool == nullptr) ? 0 : currentTool->Number();
-	response->catf(",\"tool\":%d", toolNumber);
+	json.Int("tool", (currentTool == nullptr) ? 0 : currentTool->Number());
 
 	// Send the Z probe value
 	int v0 = platform->ZProbe();
 	int v1, v2;
+	char probeText[40];
+	size_t probeLength = JsonWriter::FormatInt(probeText, v0);
 	switch (platform->GetZProbeSecondaryValues(v1, v2))
 	{
 	case 1:
-		response->catf(",\"probe\":\"%d (%d)\"", v0, v1);
+		probeText[probeLength++] = ' ';
+		probeText[probeLength++] = '(';
+		probeLength += JsonWriter::FormatInt(probeText + probeLength, v1);
+		probeText[probeLength++] = ')';
 		break;
 	case 2:
-		response->catf(",\"probe\":\"%d (%d, %d)\"", v0, v1, v2);
+		probeText[probeLength++] = ' ';
+		probeText[probeLength++] = '(';
+		probeLength += JsonWriter::FormatInt(probeText + probeLength, v1);
+		probeText[probeLength++] = ',';
+		probeText[probeLength++] = ' ';
+		probeLength += JsonWriter::FormatInt(probeText + probeLength, v2);
+		probeText[probeLength++] = ')';
 		break;
 	default:
-		response->catf(",\"probe\":\"%d\"", v0);
 		break;
 	}
+	probeText[probeLength] = 0;
+	json.String("probe", probeText);
 
 	// Send the fan0 settings (for PanelDue firmware 1.13)
-	response->catf(",\"fanPercent\":[%.02f,%.02f]", platform->GetFanValue(0) * 100.0, platform->GetFanValue(1) * 100.0);
+	json.StartArray("fanPercent");
+	json.Float(nullptr, platform->GetFanValue(0) * 100.0, 2);
+	json.Float(nullptr, platform->GetFanValue(1) * 100.0, 2);
+	json.EndArray();
 
 	// Send fan RPM value
-	response->catf(",\"fanRPM\":%u", static_cast<unsigned int>(platform->GetFanRPM()));
+	json.UInt("fanRPM", static_cast<unsigned int>(platform->GetFanRPM()));
 
 	// Send the home state. To keep the messages short, we send 1 for homed and 0 for not homed, instead of true and false.
 	if (type != 0)
 	{
-		response->catf(",\"homed\":[%d,%d,%d]",
-				(gCodes->GetAxisIsHomed(0)) ? 1 : 0,
-				(gCodes->GetAxisIsHomed(1)) ? 1 : 0,
-				(gCodes->GetAxisIsHomed(2)) ? 1 : 0);
+		json.StartArray("homed");
+		for (size_t axis = 0; axis < AXES; axis++)
+		{
+			json.Int(nullptr, (gCodes->GetAxisIsHomed(axis)) ? 1 : 0);
+		}
+		json.EndArray();
 	}
 	else
 	{
-		response->catf(",\"hx\":%d,\"hy\":%d,\"hz\":%d",
-				(gCodes->GetAxisIsHomed(0)) ? 1 : 0,
-				(gCodes->GetAxisIsHomed(1)) ? 1 : 0,
-				(gCodes->GetAxisIsHomed(2)) ? 1 : 0);
+		json.Int("hx", (gCodes->GetAxisIsHomed(0)) ? 1 : 0);
+		json.Int("hy", (gCodes->GetAxisIsHomed(1)) ? 1 : 0);
+		json.Int("hz", (gCodes->GetAxisIsHomed(2)) ? 1 : 0);
 	}
 
 	if (printMonitor->IsPrinting())
 	{
 		// Send the fraction printed
-		response->catf(",\"fraction_printed\":%.4f", max<float>(0.0, gCodes->FractionOfFilePrinted()));
+		json.Float("fraction_printed", max<float>(0.0, gCodes->FractionOfFilePrinted()), 4);
 	}
 
-	response->cat(",\"message\":");
-	response->EncodeString(message, ARRAY_SIZE(message), false);
+	json.String("message", message, ARRAY_SIZE(message));
 
 	if (type < 2)
 	{
-		response->catf(",\"buff\":%u",
 #if defined(WEBSERVER)
-					   webserver->GetGCodeBufferSpace(WebSource::HTTP));	// send the amount of buffer space available for gcodes
+		json.UInt("buff", webserver->GetGCodeBufferSpace(WebSource::HTTP));	// send the amount of buffer space available for gcodes
 #else
-		0);
+		json.UInt("buff", 0);
 #endif
 	}
 	else if (type == 2)
@@ -1232,17 +1594,18 @@ OutputBuffer *RepRap::GetLegacyStatusResponse(uint8_t type, int seq)
 		if (printMonitor->IsPrinting())
 		{
 			// Send estimated times left based on file progress, filament usage, and layers
-			response->catf(",\"timesLeft\":[%.1f,%.1f,%.1f]",
-					printMonitor->EstimateTimeLeft(fileBased),
-					printMonitor->EstimateTimeLeft(filamentBased),
-					printMonitor->EstimateTimeLeft(layerBased));
+			json.StartArray("timesLeft");
+			json.Float(nullptr, printMonitor->EstimateTimeLeft(fileBased), 1);
+			json.Float(nullptr, printMonitor->EstimateTimeLeft(filamentBased), 1);
+			json.Float(nullptr, printMonitor->EstimateTimeLeft(layerBased), 1);
+			json.EndArray();
 		}
 	}
 	else if (type == 3)
 	{
 		// Add the static fields. For now this is just geometry and the machine name, but other fields could be added e.g. axis lengths.
-		response->catf(",\"geometry\":\"%s\",\"myName\":", move->GetGeometryString());
-		response->EncodeString(myName, ARRAY_SIZE(myName), false);
+		json.String("geometry", move->GetGeometryString());
+		json.String("myName", myName, ARRAY_SIZE(myName));
 	}
 
 	int auxSeq = (int)gCodes->GetAuxSeq();
@@ -1250,13 +1613,14 @@ OutputBuffer *RepRap::GetLegacyStatusResponse(uint8_t type, int seq)
 	{
 
 		// Send the response to the last command. Do this last because it can be long and may need to be truncated.
-		response->catf(",\"seq\":%u,\"resp\":", auxSeq);					// send the response sequence number
+		json.UInt("seq", auxSeq);									// send the response sequence number
 
 		// Send the JSON response
-		response->EncodeReply(gCodes->GetAuxGCodeReply(), true);			// also releases the OutputBuffer chain
+		json.Key("resp");
+		response->EncodeReply(gCodes->GetAuxGCodeReply(), true);	// also releases the OutputBuffer chain
 	}
 
-	response->cat("}");
+	json.EndObject();
 
 	return response;
 }
@@ -28,6 +28,8 @@ enum class ResponseSource
 	Generic
 };
 
+const uint8_t binaryStatusVersion = 1;						// Version of the binary status frames sent to AUX devices
+
 class RepRap
 {    
 public:
@@ -89,9 +91,10 @@ public:
     uint16_t GetExtrudersInUse() const;
     uint16_t GetToolHeatersInUse() const;
 
-	OutputBuffer *GetStatusResponse(uint8_t type, ResponseSource source);
+	OutputBuffer *GetStatusResponse(uint8_t type, ResponseSource source, uint32_t since = 0);
 	OutputBuffer *GetConfigResponse();
 	OutputBuffer *GetLegacyStatusResponse(uint8_t type, int seq);
+	OutputBuffer *GetBinaryStatusResponse(uint8_t type, uint32_t since);
 	OutputBuffer *GetFilesResponse(const char* dir, bool flagsDirs);
 
 	void Beep(int freq, int ms);
@@ -104,6 +107,8 @@ private:
     static void EncodeString(StringRef& response, const char* src, size_t spaceToLeave, bool allowControlChars = false, char prefix = 0);
   
     char GetStatusCharacter() const;
+    void GetUserCoordinates(float liveCoordinates[DRIVES + 1]) const;
+    void EncodeStatusSection(StatusSection section, BinaryWriter& bin) const;
 
     Platform* platform;
 #if defined(WEBSERVER)
@@ -119,6 +124,8 @@ private:
 	Roland* roland;
 #endif
     PrintMonitor* printMonitor;
+    StatusTracker* statusTracker;
+    StatusTracker* auxStatusTracker;						// for the binary status frames
 
     Tool* toolList;
     Tool* currentTool;
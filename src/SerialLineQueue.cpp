@@ -0,0 +1,257 @@
+/*
+ * SerialLineQueue.cpp
+ *
+ * Receive queue for the windowed serial host protocol, see SerialLineQueue.h
+ */
+
+//*************************************************************************************
+
+#include "RepRapFirmware.h"
+
+SerialLineQueue::SerialLineQueue(Platform* p, SerialSource src)
+	: platform(p), source(src), windowed(false), checksumRequired(false)
+{
+	replyType = (src == SerialSource::USB) ? HOST_MESSAGE : (src == SerialSource::AUX) ? AUX_MESSAGE : AUX2_MESSAGE;
+	Init();
+}
+
+void SerialLineQueue::Init()
+{
+	Reset();
+	linePointer = 0;
+	lineOverflow = false;
+	lastLineNumber = 0;
+	linesReceived = resendRequests = linesDiscarded = 0;
+	maxLinesQueued = 0;
+}
+
+// This is called when doing an emergency stop. We must not execute lines that were received before it.
+void SerialLineQueue::Reset()
+{
+	readPointer = writePointer = 0;
+	linesQueued = 0;
+	resendPending = false;
+}
+
+size_t SerialLineQueue::FreeSpace() const
+{
+	return (readPointer + SERIAL_LINE_QUEUE_LENGTH - writePointer - 1) % SERIAL_LINE_QUEUE_LENGTH;
+}
+
+// Read incoming characters for as long as there is room in the queue for a complete line.
+// This lets the host keep sending while the GCodes class is busy with an earlier line.
+void SerialLineQueue::Spin()
+{
+	for (size_t i = 0; i < SERIAL_LINE_QUEUE_LENGTH && FreeSpace() > GCODE_LENGTH && platform->GCodeAvailable(source); ++i)
+	{
+		Put(platform->ReadFromSource(source));
+	}
+}
+
+void SerialLineQueue::Put(char c)
+{
+	if (c == '\n' || c == 0)
+	{
+		LineComplete();
+	}
+	else if (c != '\r')
+	{
+		if (linePointer < ARRAY_UPB(lineBuffer))
+		{
+			lineBuffer[linePointer++] = c;
+		}
+		else
+		{
+			lineOverflow = true;
+		}
+	}
+}
+
+// Check a complete line and add it to the queue. The line number and checksum are left in place, because
+// GCodeBuffer::Put strips them off again when the line is executed.
+void SerialLineQueue::LineComplete()
+{
+	lineBuffer[linePointer] = 0;
+	linePointer = 0;
+
+	const char *line = lineBuffer;
+	while (*line == ' ' || *line == '\t')
+	{
+		++line;
+	}
+	if (*line == 0 || *line == ';')
+	{
+		lineOverflow = false;
+		return;											// nothing to do for blank lines and comments
+	}
+	++linesReceived;
+
+	const bool hasLineNumber = (*line == 'N');
+	const char *code = line;
+	long lineNumber = 0;
+	if (hasLineNumber)
+	{
+		lineNumber = strtol(line + 1, const_cast<char**>(&code), 10);
+		while (*code == ' ')
+		{
+			++code;
+		}
+	}
+
+	if (lineOverflow)
+	{
+		// Asking for this line again wouldn't help, so report it and skip it
+		platform->Message(GENERIC_MESSAGE, "Error: G-Code buffer length overflow.\n");
+		lineOverflow = false;
+		if (hasLineNumber && lineNumber == lastLineNumber + 1)
+		{
+			lastLineNumber = lineNumber;
+		}
+		++linesDiscarded;
+		Acknowledge();
+		return;
+	}
+
+	// Deal with the checksum. As in GCodeBuffer, it is the XOR of all characters before the '*'.
+	const char *checksum = line;
+	while (*checksum != '*' && *checksum != ';' && *checksum != 0)
+	{
+		++checksum;
+	}
+	if (*checksum == '*')
+	{
+		uint8_t cs = 0;
+		for (const char *p = lineBuffer; p != checksum; ++p)
+		{
+			cs ^= (uint8_t)*p;
+		}
+		if (strtol(checksum + 1, nullptr, 10) != (long)cs)
+		{
+			RequestResend(lastLineNumber + 1);
+			return;
+		}
+	}
+	else if (checksumRequired)
+	{
+		if (hasLineNumber)
+		{
+			RequestResend(lastLineNumber + 1);
+		}
+		else
+		{
+			++linesDiscarded;
+		}
+		return;
+	}
+
+	// Deal with the line number
+	if (hasLineNumber)
+	{
+		if (code[0] == 'M' && strtol(code + 1, nullptr, 10) == 110 && !isDigit(code[4]))
+		{
+			// M110 sets the number of this line, and it may specify it in an N parameter too
+			const char *newNumber = code + 4;
+			while (newNumber != checksum && *newNumber != 'N')
+			{
+				++newNumber;
+			}
+			lastLineNumber = (newNumber != checksum) ? strtol(newNumber + 1, nullptr, 10) : lineNumber;
+			resendPending = false;
+		}
+		else if (lineNumber == lastLineNumber + 1)
+		{
+			lastLineNumber = lineNumber;
+			resendPending = false;
+		}
+		else if (lineNumber <= lastLineNumber)
+		{
+			// The host has resent a line we already have. Don't execute it again, but acknowledge it to keep the window in step.
+			++linesDiscarded;
+			Acknowledge();
+			return;
+		}
+		else
+		{
+			// We have missed one or more lines
+			RequestResend(lastLineNumber + 1);
+			return;
+		}
+	}
+
+	// Queue the line as it was received, so that the checksum still matches. Spin made sure that there is enough room for it.
+	for (const char *p = lineBuffer; *p != 0; ++p)
+	{
+		queue[writePointer] = *p;
+		writePointer = (writePointer + 1) % SERIAL_LINE_QUEUE_LENGTH;
+	}
+	queue[writePointer] = '\n';
+	writePointer = (writePointer + 1) % SERIAL_LINE_QUEUE_LENGTH;
+	++linesQueued;
+	maxLinesQueued = max<size_t>(maxLinesQueued, linesQueued);
+}
+
+// Ask the host to send everything again starting from the specified line.
+// Lines that are still in flight will arrive out of sequence, but we only need to ask once for them.
+void SerialLineQueue::RequestResend(long lineNumber)
+{
+	++linesDiscarded;
+	if (resendPending && lineNumber == resendLineNumber)
+	{
+		return;
+	}
+
+	resendPending = true;
+	resendLineNumber = lineNumber;
+	++resendRequests;
+	if (platform->Emulating() == marlin)
+	{
+		platform->MessageF(replyType, "Resend: %ld\nok\n", lineNumber);
+	}
+	else
+	{
+		platform->MessageF(replyType, "rs %ld\n", lineNumber);
+	}
+}
+
+void SerialLineQueue::Acknowledge()
+{
+	platform->Message(replyType, "ok\n");
+}
+
+// Pass the next queued line to the G-Code buffer. Returns true if it has a complete G-Code to act upon.
+bool SerialLineQueue::GetLine(GCodeBuffer *gb)
+{
+	char c;
+	while (GetChar(c))
+	{
+		if (gb->Put(c))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+bool SerialLineQueue::GetChar(char& c)
+{
+	if (readPointer == writePointer)
+	{
+		return false;
+	}
+
+	c = queue[readPointer];
+	readPointer = (readPointer + 1) % SERIAL_LINE_QUEUE_LENGTH;
+	if (c == '\n')
+	{
+		--linesQueued;
+	}
+	return true;
+}
+
+void SerialLineQueue::Diagnostics()
+{
+	platform->MessageF(GENERIC_MESSAGE, "Serial line queue: %s, %u lines received, %u queued (max %u), %u resend requests, %u lines discarded\n",
+						(windowed) ? "windowed" : "not windowed", linesReceived, linesQueued, maxLinesQueued, resendRequests, linesDiscarded);
+}
+
+// End
@@ -0,0 +1,57 @@
+/*
+ * SerialLineQueue.h
+ *
+ * Receive queue for the windowed serial host protocol. In windowed mode the host may send several lines without
+ * waiting for the "ok" of each one. The lines are checked as they arrive and complete lines are held in a ring
+ * buffer until the GCodes class is ready for them. When a line has a bad checksum or its line number is not the
+ * one we expect, we ask the host to resend it from its own history and discard the lines that follow until it does.
+ */
+
+#ifndef SERIALLINEQUEUE_H_
+#define SERIALLINEQUEUE_H_
+
+class SerialLineQueue
+{
+  public:
+    SerialLineQueue(Platform* p, SerialSource src);
+    void Init();										// Discard everything, including the line number
+    void Reset();										// Discard the queued data but keep the line number
+    void SetCommsProperties(uint32_t arg) { checksumRequired = (arg & 1); windowed = (arg & 2); }
+    bool IsWindowed() const { return windowed; }
+    bool InUse() const { return windowed || readPointer != writePointer; }	// Do we have to read G-Codes from the queue?
+    void Spin();										// Read as much from the serial source as the queue can hold
+    bool GetLine(GCodeBuffer *gb);						// Pass the next complete line to a G-Code buffer
+    bool GetChar(char& c);								// Get the next queued character
+    size_t Capacity() const { return SERIAL_LINE_QUEUE_LENGTH; }
+    void Diagnostics();
+
+  private:
+    size_t FreeSpace() const;
+    void Put(char c);									// Add a character to the line being assembled
+    void LineComplete();								// Check the line being assembled and queue it if it's OK
+    void RequestResend(long lineNumber);
+    void Acknowledge();
+
+    Platform* platform;
+    SerialSource source;
+    MessageType replyType;								// Where resend requests go
+    char queue[SERIAL_LINE_QUEUE_LENGTH];				// Ring buffer of complete lines, each one terminated by '\n'
+    size_t readPointer, writePointer;
+    size_t linesQueued;
+    char lineBuffer[GCODE_LENGTH];						// The line being received
+    size_t linePointer;
+    bool lineOverflow;									// Was the line being received too long?
+    bool windowed;										// True if the windowed protocol is enabled
+    bool checksumRequired;								// True if we only accept lines with a valid checksum
+    bool resendPending;									// True if we are waiting for the host to resend a line
+    long lastLineNumber;								// Number of the last line we accepted
+    long resendLineNumber;								// Number of the line we asked the host to resend
+
+    // Statistics for M122
+    uint32_t linesReceived;
+    uint32_t resendRequests;
+    uint32_t linesDiscarded;
+    size_t maxLinesQueued;
+};
+
+#endif /* SERIALLINEQUEUE_H_ */
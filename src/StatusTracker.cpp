@@ -0,0 +1,86 @@
+/*
+ * StatusTracker.cpp
+ *
+ * Change tracking for the JSON status response, see StatusTracker.h
+ */
+
+#include "RepRapFirmware.h"
+
+// We use FNV-1a, one byte at a time
+void StatusFingerprint::Add(int32_t value)
+{
+	for (size_t i = 0; i < sizeof(value); i++)
+	{
+		hash = (hash ^ (uint8_t)value) * 16777619u;
+		value >>= 8;
+	}
+}
+
+void StatusFingerprint::Add(const char *s)
+{
+	while (*s != 0)
+	{
+		hash = (hash ^ (uint8_t)*s++) * 16777619u;
+	}
+	hash = (hash ^ 0) * 16777619u;				// so that "ab","c" differs from "a","bc"
+}
+
+StatusTracker::StatusTracker() : sinceSeq(0), changed(false), fullResponse(true), sectionsSent(0), sectionsSkipped(0)
+{
+	Init(0);
+}
+
+// Start the sequence numbers at a random value below 2^30, so that they also fit in the integer parameter of M408. A client that comes
+// back after a reset with a statusSeq from before it is then very unlikely to hit the range we have used since, and there are enough
+// numbers left for years of changes.
+void StatusTracker::Init(uint32_t seed)
+{
+	firstSeq = statusSeq = (seed & 0x3FFFFFFF) + 1;
+	for (size_t i = 0; i < numStatusSections; i++)
+	{
+		fingerprints[i] = 0;
+		changeSeqs[i] = statusSeq;
+	}
+}
+
+void StatusTracker::Begin(uint32_t since)
+{
+	// A sequence number we haven't handed out must have come from before a reset, so the client needs everything
+	fullResponse = (since < firstSeq || since > statusSeq);
+	sinceSeq = since;
+	changed = false;
+}
+
+bool StatusTracker::NeedSection(StatusSection section, const StatusFingerprint& fingerprint)
+{
+	if (fingerprint.Get() != fingerprints[section])
+	{
+		fingerprints[section] = fingerprint.Get();
+		changeSeqs[section] = statusSeq + 1;
+		changed = true;
+	}
+
+	if (fullResponse || changeSeqs[section] > sinceSeq)
+	{
+		++sectionsSent;
+		return true;
+	}
+	++sectionsSkipped;
+	return false;
+}
+
+uint32_t StatusTracker::End()
+{
+	if (changed)
+	{
+		++statusSeq;
+	}
+	return statusSeq;
+}
+
+void StatusTracker::Diagnostics(Platform *platform, const char *name) const
+{
+	platform->MessageF(GENERIC_MESSAGE, "%s status responses: sequence %lu, %lu sections sent, %lu unchanged sections skipped\n", name, statusSeq, sectionsSent, sectionsSkipped);
+}
+
+// End
@@ -0,0 +1,60 @@
+/*
+ * StatusTracker.h
+ *
+ * Keeps track of which parts of the JSON status response have changed, so that a client that polls rr_status with the
+ * statusSeq it last received only needs to be sent the parts that are different. For each section of the response we
+ * keep a fingerprint of the values it reports, made from the raw values rounded to the precision they are printed with,
+ * and the status sequence number at which it last changed. Working out a fingerprint is much quicker than formatting
+ * the section, so sections that haven't changed cost neither the formatting time nor the bytes sent.
+ */
+
+#ifndef STATUSTRACKER_H_
+#define STATUSTRACKER_H_
+
+enum StatusSection : uint8_t
+{
+	statusCoords = 0,
+	statusParams,
+	statusSensors,
+	statusTemps,
+	statusExtended,				// only in type 2 responses
+	statusPrint,				// only in type 3 responses
+	numStatusSections
+};
+
+// Builds the fingerprint of a section
+class StatusFingerprint
+{
+  public:
+	StatusFingerprint() : hash(2166136261u) { }
+	void Add(int32_t value);
+	void Add(float value, float resolution) { Add((int32_t)lrintf(value / resolution)); }
+	void Add(const char *s);
+	void AddByte(uint8_t b) { hash = (hash ^ b) * 16777619u; }
+	uint32_t Get() const { return hash; }
+
+  private:
+	uint32_t hash;
+};
+
+class StatusTracker
+{
+  public:
+	StatusTracker();
+	void Init(uint32_t seed);									// Start a new range of sequence numbers
+	void Begin(uint32_t since);									// Start a response for a client that has seen statusSeq 'since', 0 for a full response
+	bool NeedSection(StatusSection section, const StatusFingerprint& fingerprint);	// Record the fingerprint, return true if the section must be sent
+	uint32_t End();												// Finish the response and return the statusSeq to report
+	void Diagnostics(Platform *platform, const char *name) const;
+
+  private:
+	uint32_t fingerprints[numStatusSections];
+	uint32_t changeSeqs[numStatusSections];						// statusSeq at which each section last changed
+	uint32_t statusSeq;											// incremented when a response finds that something has changed
+	uint32_t firstSeq;											// the first statusSeq since startup
+	uint32_t sinceSeq;
+	bool changed, fullResponse;
+	uint32_t sectionsSent, sectionsSkipped;
+};
+
+#endif /* STATUSTRACKER_H_ */
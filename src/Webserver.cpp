@@ -57,11 +57,12 @@
  rr_configfile
 			 Sends the config file as plain text (not encapsulated as JSON either).
 
- rr_upload?name=xxx
+ rr_upload?name=xxx[&crc32=yyyyyyyy]
  	 	 	 Upload a specified file using a POST request. The payload of this request has to be
  	 	 	 the file content. Only one file may be uploaded at once. When the upload has finished,
  	 	 	 a JSON response with the variable "err" will be returned, which will be 0 if the job
- 	 	 	 has finished without problems, it will be set to 1 otherwise.
+ 	 	 	 has finished without problems, it will be set to 1 otherwise. If the CRC-32 of the
+ 	 	 	 file is given in hex, the upload fails and the file is deleted if it doesn't match.
 
  rr_delete?name=xxx
 			 Delete file xxx. Returns err (zero if successful).
@@ -95,6 +96,7 @@ Webserver::Webserver(Platform* p, Network *n) : platform(p), network(n), webserv
 	httpInterpreter = new HttpInterpreter(p, this, n);
 	ftpInterpreter = new FtpInterpreter(p, this, n);
 	telnetInterpreter = new TelnetInterpreter(p, this, n);
+	uploadIndexer = new GCodeIndexer(p);
 }
 
 void Webserver::Init()
@@ -205,8 +207,20 @@ void Webserver::Spin()
 			{
 				telnetInterpreter->SendGCodeReply();
 			}
-			// Process other messages (if we can)
-			else if (interpreter != httpInterpreter || httpInterpreter->IsReady())
+			// HTTP requests are parsed a span at a time
+			else if (interpreter == httpInterpreter)
+			{
+				if (httpInterpreter->IsReady())
+				{
+					readingConnection = currentTransaction->GetConnection();
+					if (httpInterpreter->ParseRequest(currentTransaction))
+					{
+						readingConnection = nullptr;
+					}
+				}
+			}
+			// Process other messages
+			else
 			{
 				readingConnection = currentTransaction->GetConnection();
 				for(size_t i = 0; i < TCP_MSS / 3; i++)
@@ -393,6 +407,9 @@ ProtocolInterpreter::ProtocolInterpreter(Platform *p, Webserver *ws, Network *n)
 {
 	uploadState = notUploading;
 	filenameBeingUploaded[0] = 0;
+	indexingUpload = false;
+	checkingCrc = false;
+	expectedCrc = 0;
 }
 
 void ProtocolInterpreter::Spin()
@@ -404,6 +421,11 @@ void ProtocolInterpreter::Spin()
 		{
 			fileBeingUploaded.Close();
 		}
+		if (indexingUpload)
+		{
+			webserver->uploadIndexer->Finish(false);
+			indexingUpload = false;
+		}
 		if (filenameBeingUploaded[0] != 0)
 		{
 			platform->GetMassStorage()->Delete(FS_PREFIX, filenameBeingUploaded);
@@ -427,14 +449,24 @@ void ProtocolInterpreter::NoMoreDataAvailable()
 	webserver->currentTransaction->Discard();
 }
 
-// Start writing to a new file
-bool ProtocolInterpreter::StartUpload(FileStore *file, const char *fileName)
+// Start writing to a new file. If it is a G-Code file, we build its index while it is being uploaded.
+// If we know how long the file will be, we allocate its clusters before the data arrives.
+// If the client has told us the CRC-32 of the file, we work out the CRC of the data we write and check it when the upload has finished.
+bool ProtocolInterpreter::StartUpload(FileStore *file, const char *directory, const char *fileName, uint32_t fileLength, bool haveCrc, uint32_t crc)
 {
 	if (file != nullptr)
 	{
 		fileBeingUploaded.Set(file);
+		if (fileBeingUploaded.EnableWriteBehind() && fileLength != 0)
+		{
+			fileBeingUploaded.Preallocate(fileLength);
+		}
 		strncpy(filenameBeingUploaded, fileName, ARRAY_SIZE(filenameBeingUploaded));
 		filenameBeingUploaded[ARRAY_UPB(filenameBeingUploaded)] = 0;
+		indexingUpload = webserver->uploadIndexer->Start(directory, fileName, false);
+		checkingCrc = haveCrc;
+		expectedCrc = crc;
+		uploadCrc.Reset();
 
 		uploadState = uploadOK;
 		return true;
@@ -444,6 +476,24 @@ bool ProtocolInterpreter::StartUpload(FileStore *file, const char *fileName)
 	return false;
 }
 
+// Write a chunk of upload data to the file and pass it on to the indexer and the CRC
+bool ProtocolInterpreter::WriteUploadData(const char *data, size_t len)
+{
+	if (!fileBeingUploaded.Write(data, len))
+	{
+		return false;
+	}
+	if (checkingCrc)
+	{
+		uploadCrc.Update(data, len);
+	}
+	if (indexingUpload)
+	{
+		webserver->uploadIndexer->Process(data, len);
+	}
+	return true;
+}
+
 void ProtocolInterpreter::CancelUpload()
 {
 	if (uploadState == uploadOK)
@@ -453,13 +503,17 @@ void ProtocolInterpreter::CancelUpload()
 	}
 }
 
+// Write all the data of the current transaction straight from its pbufs. Doing the whole transaction in one go means that
+// its pbufs are freed and the TCP window is reopened as soon as possible, instead of one pbuf per call to Webserver::Spin.
 void ProtocolInterpreter::DoFastUpload()
 {
 	NetworkTransaction *transaction = webserver->currentTransaction;
 
+	// Writing data usually takes a while, so keep LwIP running while this is being done
+	network->Unlock();
 	const char *buffer;
 	size_t len;
-	if (transaction->ReadBuffer(buffer, len))
+	while (uploadState == uploadOK && transaction->ReadBuffer(buffer, len))
 	{
 		// See if we can output a debug message
 		if (reprap.Debug(moduleWebserver))
@@ -467,9 +521,7 @@ void ProtocolInterpreter::DoFastUpload()
 			platform->MessageF(HOST_MESSAGE, "Writing %u bytes of upload data\n", len);
 		}
 
-		// Writing data usually takes a while, so keep LwIP running while this is being done
-		network->Unlock();
-		if (!fileBeingUploaded.Write(buffer, len))
+		if (!WriteUploadData(buffer, len))
 		{
 			platform->Message(GENERIC_MESSAGE, "Error: Could not write upload data!\n");
 			CancelUpload();
@@ -478,13 +530,10 @@ void ProtocolInterpreter::DoFastUpload()
 			transaction->Commit(false);
 			return;
 		}
-		while (!network->Lock());
 	}
+	while (!network->Lock());
 
-	if (uploadState != uploadOK || !transaction->HasMoreDataToRead())
-	{
-		transaction->Discard();
-	}
+	transaction->Discard();
 }
 
 bool ProtocolInterpreter::FinishUpload(uint32_t fileLength)
@@ -503,12 +552,26 @@ bool ProtocolInterpreter::FinishUpload(uint32_t fileLength)
 		platform->MessageF(GENERIC_MESSAGE, "Error: Uploaded file size is different (%u vs. expected %u bytes)!\n", fileBeingUploaded.Length(), fileLength);
 	}
 
+	// Check the CRC if the client sent one
+	if (uploadState == uploadOK && checkingCrc && uploadCrc.Get() != expectedCrc)
+	{
+		uploadState = uploadError;
+		platform->MessageF(GENERIC_MESSAGE, "Error: CRC32 of uploaded file is %08lx, expected %08lx!\n", uploadCrc.Get(), expectedCrc);
+	}
+
 	// Close the file
 	if (fileBeingUploaded.IsLive())
 	{
 		fileBeingUploaded.Close();
 	}
 
+	// Complete the index. This must be done after closing the file, because the index records its final timestamp
+	if (indexingUpload)
+	{
+		webserver->uploadIndexer->Finish(uploadState == uploadOK);
+		indexingUpload = false;
+	}
+
 	// Delete the file again if an error has occurred
 	if (uploadState == uploadError && filenameBeingUploaded[0] != 0)
 	{
@@ -519,6 +582,7 @@ bool ProtocolInterpreter::FinishUpload(uint32_t fileLength)
 	bool success = (uploadState == uploadOK);
 	uploadState = notUploading;
 	filenameBeingUploaded[0] = 0;
+	checkingCrc = false;
 	return success;
 }
 
@@ -538,11 +602,18 @@ Webserver::HttpInterpreter::HttpInterpreter(Platform *p, Webserver *ws, Network
 	gcodeReply = new OutputStack();
 	deferredRequestConnection = nullptr;
 	seq = 0;
+	numStatusStreams = 0;
+	statusFramesBuilt = statusFramesSent = 0;
+	postFileLength = uploadedBytes = 0;
+	uploadSucceeded = false;
+	uploadStartTime = uploadDuration = 0;
 }
 
 void Webserver::HttpInterpreter::Diagnostics()
 {
 	platform->MessageF(GENERIC_MESSAGE, "HTTP sessions: %d of %d\n", numSessions, maxHttpSessions);
+	platform->MessageF(GENERIC_MESSAGE, "Status streams: %u of %u, %lu frames built, %lu sent\n", numStatusStreams, maxStatusStreams, statusFramesBuilt, statusFramesSent);
+	platform->MessageF(GENERIC_MESSAGE, "Last upload: %lu bytes in %lums\n", uploadedBytes, uploadDuration);
 }
 
 void Webserver::HttpInterpreter::Spin()
@@ -585,6 +656,130 @@ void Webserver::HttpInterpreter::Spin()
 		clientsServed = 0;
 	}
 
+	// Push status frames to the clients that are streaming them
+	SendStatusFrames();
+}
+
+// Status streams
+
+// Start pushing status frames over the current connection instead of having the client poll rr_status.
+// The client sends "rr_stream?type=<1..3>&interval=<ms>" and receives a text/event-stream response, so it can use an EventSource.
+void Webserver::HttpInterpreter::StartStatusStream()
+{
+	if (numStatusStreams == maxStatusStreams)
+	{
+		RejectMessage("too many status streams", 503);
+		return;
+	}
+
+	uint8_t type = 1;
+	uint32_t interval = defaultStatusStreamInterval;
+	for (size_t i = 0; i < numQualKeys; i++)
+	{
+		if (StringEquals(qualifiers[i].key, "type"))
+		{
+			const int requestedType = atoi(qualifiers[i].value);
+			type = (requestedType >= 1 && requestedType <= 3) ? requestedType : 1;
+		}
+		else if (StringEquals(qualifiers[i].key, "interval"))
+		{
+			interval = max<uint32_t>(min<uint32_t>(strtoul(qualifiers[i].value, nullptr, 10), UINT16_MAX), minStatusStreamInterval);
+		}
+	}
+	UpdateAuthentication();
+
+	// The response has no length, it ends when the connection is closed
+	NetworkTransaction *transaction = webserver->currentTransaction;
+	transaction->Write("HTTP/1.1 200 OK\n");
+	transaction->Write("Cache-Control: no-cache\n");
+	transaction->Write("Content-Type: text/event-stream\n\n");
+	transaction->Commit(true);
+
+	StatusStream& stream = statusStreams[numStatusStreams++];
+	stream.cs = transaction->GetConnection();
+	stream.lastFrameTime = millis() - interval;			// send the first frame straight away
+	stream.interval = interval;
+	stream.type = type;
+}
+
+// Send a status frame to each client whose interval has elapsed. A frame is built only once for all the clients
+// that want the same type and they share its OutputBuffers, which we release once the last of them has sent it.
+void Webserver::HttpInterpreter::SendStatusFrames()
+{
+	const uint32_t now = millis();
+	for (uint8_t type = 1; type <= 3; type++)
+	{
+		OutputBuffer *frame = nullptr;
+		for (size_t i = 0; i < numStatusStreams; i++)
+		{
+			StatusStream& stream = statusStreams[i];
+
+			// Don't queue up frames for a client that hasn't received the previous one yet, skip one instead
+			if (stream.type != type || now - stream.lastFrameTime < stream.interval || stream.cs->sendingTransaction != nullptr)
+			{
+				continue;
+			}
+
+			if (frame == nullptr)
+			{
+				frame = GetStatusFrame(type);
+				if (frame == nullptr)
+				{
+					// Not enough memory at the moment, try again later
+					return;
+				}
+			}
+
+			if (network->AcquireTransaction(stream.cs))
+			{
+				NetworkTransaction *transaction = network->GetTransaction(stream.cs);
+				frame->IncreaseReferences(1);
+				transaction->Write(frame);
+				transaction->Commit(true);
+				stream.lastFrameTime = now;
+				++statusFramesSent;
+
+				// Streaming clients don't poll, so keep their sessions alive here
+				for (size_t k = 0; k < numSessions; k++)
+				{
+					if (sessions[k].ip == stream.cs->GetRemoteIP())
+					{
+						sessions[k].lastQueryTime = now;
+						break;
+					}
+				}
+			}
+		}
+
+		if (frame != nullptr)
+		{
+			// Drop our own reference to the frame
+			OutputBuffer::ReleaseAll(frame);
+		}
+	}
+}
+
+// Build a status frame in the event-stream format
+OutputBuffer *Webserver::HttpInterpreter::GetStatusFrame(uint8_t type)
+{
+	OutputBuffer *frame;
+	if (OutputBuffer::GetBytesLeft(nullptr) < minHttpResponseSize || !OutputBuffer::Allocate(frame))
+	{
+		return nullptr;
+	}
+
+	OutputBuffer *statusResponse = reprap.GetStatusResponse(type, ResponseSource::HTTP);
+	if (statusResponse == nullptr)
+	{
+		OutputBuffer::Release(frame);
+		return nullptr;
+	}
+
+	frame->copy("data: ");
+	frame->Append(statusResponse);
+	frame->cat("\n\n");
+	++statusFramesBuilt;
+	return frame;
 }
 
 // File Uploads
@@ -604,28 +799,31 @@ bool Webserver::HttpInterpreter::DoingFastUpload() const
 	return false;
 }
 
+// Write all the data of the current transaction on the SD card straight from its pbufs, but no more than the client said it would send.
+// This is also called for the rest of the transaction that contained the headers, so small uploads are finished straight away.
 void Webserver::HttpInterpreter::DoFastUpload()
 {
 	NetworkTransaction *transaction = webserver->currentTransaction;
 
-	// Write some data on the SD card
+	network->Unlock();
 	const char *buffer;
 	size_t len;
-	if (transaction->ReadBuffer(buffer, len))
+	while (uploadState == uploadOK && uploadedBytes < postFileLength && transaction->ReadBuffer(buffer, len))
 	{
-		network->Unlock();
-		if (!fileBeingUploaded.Write(buffer, len))
+		len = min<size_t>(len, postFileLength - uploadedBytes);
+		if (!WriteUploadData(buffer, len))
 		{
 			platform->Message(GENERIC_MESSAGE, "Error: Could not write upload data!\n");
 			CancelUpload();
 
 			while (!network->Lock());
+			uploadSucceeded = false;
 			SendJsonResponse("upload");
 			return;
 		}
 		uploadedBytes += len;
-		while (!network->Lock());
 	}
+	while (!network->Lock());
 
 	// See if the upload has finished
 	if (uploadState == uploadOK && uploadedBytes >= postFileLength)
@@ -643,7 +841,8 @@ void Webserver::HttpInterpreter::DoFastUpload()
 		}
 
 		// We're done, flush the remaining upload data and send the JSON response
-		FinishUpload(postFileLength);
+		uploadSucceeded = FinishUpload(postFileLength);
+		uploadDuration = millis() - uploadStartTime;
 		SendJsonResponse("upload");
 	}
 	else if (uploadState != uploadOK || !transaction->HasMoreDataToRead())
@@ -653,6 +852,26 @@ void Webserver::HttpInterpreter::DoFastUpload()
 	}
 }
 
+// Return the value of the specified header, or nullptr if the client didn't send it
+const char* Webserver::HttpInterpreter::GetHeaderValue(const char *key) const
+{
+	for (size_t i = 0; i < numHeaderKeys; i++)
+	{
+		if (StringEquals(headers[i].key, key))
+		{
+			return headers[i].value;
+		}
+	}
+	return nullptr;
+}
+
+// Check whether the client's copy of a resource is the one with the specified ETag
+bool Webserver::HttpInterpreter::ClientHasETag(const char *eTag) const
+{
+	const char *ifNoneMatch = GetHeaderValue("If-None-Match");
+	return ifNoneMatch != nullptr && strstr(ifNoneMatch, eTag) != nullptr;
+}
+
 // Output to the client
 
 // Start sending a file or a JSON response.
@@ -668,9 +887,60 @@ void Webserver::HttpInterpreter::SendFile(const char* nameOfFileToSend)
 			nameOfFileToSend = INDEX_PAGE_FILE;
 		}
 	}
-	FileStore *fileToSend = platform->GetFileStore(platform->GetWebDir(), nameOfFileToSend, false);
-	if (fileToSend == nullptr)
+
+	// If the client accepts gzip encoding and there is a compressed copy of the file, send that instead.
+	// Look at the directory entry first, so that we needn't open the file at all if the client's copy is still valid.
+	MassStorage *massStorage = platform->GetMassStorage();
+	char gzFileName[FILENAME_LENGTH];
+	const char *fileName = nameOfFileToSend;
+	uint32_t fileSize, fileTime;
+	bool gzipped = false;
+	const char *acceptEncoding = GetHeaderValue("Accept-Encoding");
+	if (acceptEncoding != nullptr && strstr(acceptEncoding, "gzip") != nullptr && !StringEndsWith(nameOfFileToSend, ".gz")
+		&& snprintf(gzFileName, ARRAY_SIZE(gzFileName), "%s.gz", nameOfFileToSend) < (int)ARRAY_SIZE(gzFileName))
+	{
+		gzipped = massStorage->GetFileStatus(massStorage->CombineName(platform->GetWebDir(), gzFileName), fileSize, fileTime);
+		if (gzipped)
+		{
+			fileName = gzFileName;
+		}
+	}
+
+	FileStore *fileToSend = nullptr;
+	char eTag[eTagLength];
+	bool found = gzipped || massStorage->GetFileStatus(massStorage->CombineName(platform->GetWebDir(), fileName), fileSize, fileTime);
+	if (found)
 	{
+		// The ETag is made from the FAT size and date of the file, so it changes when the file is replaced
+		snprintf(eTag, ARRAY_SIZE(eTag), "\"%08lx%08lx%s\"", fileSize, fileTime, (gzipped) ? "z" : "");
+		if (ClientHasETag(eTag))
+		{
+			transaction->Write("HTTP/1.1 304 Not Modified\n");
+			WriteCacheControl();
+			transaction->Printf("ETag: %s\n", eTag);
+			transaction->Write("Vary: Accept-Encoding\n");
+			transaction->Write("Connection: close\n\n");
+			transaction->Commit(false);
+			return;
+		}
+
+		fileToSend = platform->GetFileStore(platform->GetWebDir(), fileName, false);
+		if (fileToSend == nullptr && gzipped)
+		{
+			// We couldn't open the compressed copy, so try to send the uncompressed file instead
+			gzipped = false;
+			fileName = nameOfFileToSend;
+			if (massStorage->GetFileStatus(massStorage->CombineName(platform->GetWebDir(), fileName), fileSize, fileTime))
+			{
+				snprintf(eTag, ARRAY_SIZE(eTag), "\"%08lx%08lx\"", fileSize, fileTime);
+				fileToSend = platform->GetFileStore(platform->GetWebDir(), fileName, false);
+			}
+		}
+		found = (fileToSend != nullptr);
+	}
+	if (!found)
+	{
+		gzipped = false;						// the 404 page is never compressed
 		nameOfFileToSend = FOUR04_PAGE_FILE;
 		fileToSend = platform->GetFileStore(platform->GetWebDir(), nameOfFileToSend, false);
 		if (fileToSend == nullptr)
@@ -684,7 +954,7 @@ void Webserver::HttpInterpreter::SendFile(const char* nameOfFileToSend)
 	transaction->Write("HTTP/1.1 200 OK\n");
 
 	const char* contentType;
-	bool zip = false;
+	bool zip = gzipped;
 	if (StringEndsWith(nameOfFileToSend, ".png"))
 	{
 		contentType = "image/png";
@@ -716,16 +986,31 @@ void Webserver::HttpInterpreter::SendFile(const char* nameOfFileToSend)
 	}
 	transaction->Printf("Content-Type: %s\n", contentType);
 
-	if (zip && fileToSend != nullptr)
+	if (zip)
 	{
 		transaction->Write("Content-Encoding: gzip\n");
-		transaction->Printf("Content-Length: %lu\n", fileToSend->Length());
 	}
+	transaction->Printf("Content-Length: %lu\n", fileToSend->Length());
+
+	WriteCacheControl();
+	if (found)
+	{
+		transaction->Printf("ETag: %s\n", eTag);
+	}
+	transaction->Write("Vary: Accept-Encoding\n");
 
 	transaction->Write("Connection: close\n\n");
 	transaction->Commit(false);
 }
 
+// Let the browser keep web files and JSON responses that carry an ETag, but make it check them before it uses them again. The web
+// interface loads its scripts and style sheets under fixed names, so an updated version must be picked up as soon as the page is reloaded.
+// Revalidation costs a 304 response without any data.
+void Webserver::HttpInterpreter::WriteCacheControl()
+{
+	webserver->currentTransaction->Write("Cache-Control: no-cache\n");
+}
+
 void Webserver::HttpInterpreter::SendConfigFile()
 {
 	FileStore *configFile = platform->GetFileStore(platform->GetSysDir(), platform->GetConfigFile(), false);
@@ -808,6 +1093,27 @@ void Webserver::HttpInterpreter::SendJsonResponse(const char* command)
 			SendConfigFile();
 			return;
 		}
+
+		if (StringEquals(command, "stream"))		// rr_stream
+		{
+			StartStatusStream();
+			return;
+		}
+	}
+
+	// rr_config only changes when the configuration does, so the client may already have the current version
+	NetworkTransaction *transaction = webserver->currentTransaction;
+	char eTag[eTagLength];
+	const bool isConfig = IsAuthenticated() && StringEquals(command, "config") && GetConfigETag(eTag);
+	if (isConfig && ClientHasETag(eTag))
+	{
+		UpdateAuthentication();
+		transaction->Write("HTTP/1.1 304 Not Modified\n");
+		WriteCacheControl();
+		transaction->Printf("ETag: %s\n", eTag);
+		transaction->Write("Connection: close\n\n");
+		transaction->Commit(false);
+		return;
 	}
 
 	// Try to process a request for JSON responses
@@ -832,7 +1138,6 @@ void Webserver::HttpInterpreter::SendJsonResponse(const char* command)
 	}
 
 	// Check the special case of a deferred request (rr_fileinfo)
-	NetworkTransaction *transaction = webserver->currentTransaction;
 	if (transaction->GetStatus() == deferred || transaction->GetStatus() == sending)
 	{
 		OutputBuffer::Release(jsonResponse);
@@ -869,9 +1174,17 @@ void Webserver::HttpInterpreter::SendJsonResponse(const char* command)
 	}
 
 	transaction->Write("HTTP/1.1 200 OK\n");
-	transaction->Write("Cache-Control: no-cache, no-store, must-revalidate\n");
-	transaction->Write("Pragma: no-cache\n");
-	transaction->Write("Expires: 0\n");
+	if (isConfig)
+	{
+		WriteCacheControl();
+		transaction->Printf("ETag: %s\n", eTag);
+	}
+	else
+	{
+		transaction->Write("Cache-Control: no-cache, no-store, must-revalidate\n");
+		transaction->Write("Pragma: no-cache\n");
+		transaction->Write("Expires: 0\n");
+	}
 	transaction->Write("Content-Type: application/json\n");
 	transaction->Printf("Content-Length: %u\n", (jsonResponse != nullptr) ? jsonResponse->Length() : 0);
 	transaction->Printf("Connection: %s\n\n", keepOpen ? "keep-alive" : "close");
@@ -880,6 +1193,18 @@ void Webserver::HttpInterpreter::SendJsonResponse(const char* command)
 	transaction->Commit(keepOpen);
 }
 
+// Make the ETag of the rr_config response from the configuration generation and the FAT size and date of the config file
+bool Webserver::HttpInterpreter::GetConfigETag(char *eTag) const
+{
+	MassStorage *massStorage = platform->GetMassStorage();
+	uint32_t fileSize, fileTime;
+	if (!massStorage->GetFileStatus(massStorage->CombineName(platform->GetSysDir(), platform->GetConfigFile()), fileSize, fileTime))
+	{
+		fileSize = fileTime = 0;
+	}
+	return snprintf(eTag, eTagLength, "\"c%08lx%08lx%08lx\"", platform->GetConfigGeneration(), fileSize, fileTime) < (int)eTagLength;
+}
+
 bool Webserver::HttpInterpreter::IsReady()
 {
 	// We want to send a response, but we need memory for that. Check if we have to truncate the G-Code reply
@@ -980,8 +1305,18 @@ bool Webserver::HttpInterpreter::GetJsonResponse(const char* request, OutputBuff
 					type = 1;
 				}
 
+				// A client that passes back the statusSeq it last received only gets the sections that have changed
+				uint32_t since = 0;
+				for (size_t i = 1; i < numQualKeys; i++)
+				{
+					if (StringEquals(qualifiers[i].key, "since"))
+					{
+						since = strtoul(qualifiers[i].value, nullptr, 10);
+					}
+				}
+
 				OutputBuffer::Release(response);
-				response = reprap.GetStatusResponse(type, ResponseSource::HTTP);
+				response = reprap.GetStatusResponse(type, ResponseSource::HTTP, since);
 			}
 			else
 			{
@@ -997,7 +1332,7 @@ bool Webserver::HttpInterpreter::GetJsonResponse(const char* request, OutputBuff
 		}
 		else if (StringEquals(request, "upload"))
 		{
-			response->printf("{\"err\":%d}", (uploadedBytes == postFileLength) ? 0 : 1);
+			response->printf("{\"err\":%d}", (uploadSucceeded) ? 0 : 1);
 		}
 		else if (StringEquals(request, "delete") && StringEquals(key, "name"))
 		{
@@ -1098,6 +1433,16 @@ void Webserver::HttpInterpreter::NoMoreDataAvailable()
 // May be called from ISR!
 void Webserver::HttpInterpreter::ConnectionLost(const ConnectionState *cs)
 {
+	// Stop pushing status frames to this connection
+	for (size_t i = 0; i < numStatusStreams; i++)
+	{
+		if (statusStreams[i].cs == cs)
+		{
+			statusStreams[i] = statusStreams[--numStatusStreams];
+			break;
+		}
+	}
+
 	// Make sure deferred requests are cancelled
 	if (deferredRequestConnection == cs)
 	{
@@ -1436,6 +1781,95 @@ bool Webserver::HttpInterpreter::CharFromClient(char c)
 	return false;
 }
 
+// Return how many characters at the start of 'data' would just be copied to clientMessage by CharFromClient in the current state
+size_t Webserver::HttpInterpreter::OrdinaryCharacters(const char *data, size_t length) const
+{
+	// All the characters that CharFromClient treats specially are below 64, so we keep them in a bitmap
+	const uint64_t lineEnd = (1ull << 0) | (1ull << '\r') | (1ull << '\n');
+	const uint64_t wordEnd = lineEnd | (1ull << ' ') | (1ull << '\t');
+	uint64_t delimiters;
+	switch (state)
+	{
+		case doingCommandWord:
+			delimiters = wordEnd;
+			break;
+		case doingFilename:
+			delimiters = wordEnd | (1ull << '?') | (1ull << '%');
+			break;
+		case doingQualifierKey:
+			delimiters = wordEnd | (1ull << '=') | (1ull << '%') | (1ull << '&');
+			break;
+		case doingQualifierValue:
+			delimiters = wordEnd | (1ull << '%') | (1ull << '&') | (1ull << '+');
+			break;
+		case doingHeaderKey:
+			delimiters = lineEnd | (1ull << ':');
+			break;
+		case doingHeaderValue:
+			{
+				// Header values make up most of a request, so look for the end of the line with memchr
+				const char * const lf = (const char *)memchr(data, '\n', length);
+				const size_t lineLength = (lf == nullptr) ? length : lf - data;
+				const char * const cr = (const char *)memchr(data, '\r', lineLength);
+				return (cr == nullptr) ? lineLength : cr - data;
+			}
+		default:
+			return 0;
+	}
+
+	size_t n = 0;
+	while (n < length && ((uint8_t)data[n] >= 64 || ((delimiters >> data[n]) & 1) == 0))
+	{
+		++n;
+	}
+	return n;
+}
+
+// Parse as much of the request as we can in one go. Runs of ordinary characters are copied to clientMessage with memcpy and only
+// the delimiters and escapes go through the CharFromClient state machine, which also sees them at the same position in the
+// transaction as before, so that ProcessMessage can read any POST data that follows the headers.
+// Returns true if the request has been processed and the transaction dealt with, false if we want to be called again.
+bool Webserver::HttpInterpreter::ParseRequest(NetworkTransaction *transaction)
+{
+	size_t budget = ARRAY_SIZE(clientMessage);					// don't spend longer on a request in one Spin than its maximum length
+	while (budget != 0)
+	{
+		const char *data;
+		size_t length;
+		if (!transaction->PeekBuffer(data, length))
+		{
+			// We ran out of data before finding a complete request. This happens when the incoming
+			// message length exceeds the TCP MSS. This removes the current transaction too
+			NoMoreDataAvailable();
+			return true;
+		}
+
+		const size_t run = OrdinaryCharacters(data, min<size_t>(min<size_t>(length, budget), ARRAY_SIZE(clientMessage) - clientPointer));
+		if (run != 0)
+		{
+			memcpy(clientMessage + clientPointer, data, run);
+			clientPointer += run;
+			transaction->Skip(run);
+			budget -= run;
+			if (clientPointer == ARRAY_SIZE(clientMessage))
+			{
+				return RejectMessage(overflowResponse);
+			}
+		}
+		else
+		{
+			char c;
+			transaction->Read(c);
+			--budget;
+			if (CharFromClient(c))
+			{
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
 // Process the message received so far. We have reached the end of the headers.
 // Return true if the message is complete, false if we want to continue receiving data (i.e. postdata)
 bool Webserver::HttpInterpreter::ProcessMessage()
@@ -1511,9 +1945,22 @@ bool Webserver::HttpInterpreter::ProcessMessage()
 					return RejectMessage("invalid POST upload request");
 				}
 
+				// See if the client wants us to check the CRC-32 of the file, given in hex
+				bool haveCrc = false;
+				uint32_t crc = 0;
+				for (size_t i = 1; i < numQualKeys; i++)
+				{
+					if (StringEquals(qualifiers[i].key, "crc32"))
+					{
+						crc = strtoul(qualifiers[i].value, nullptr, 16);
+						haveCrc = true;
+						break;
+					}
+				}
+
 				// Start a new file upload
 				FileStore *file = platform->GetFileStore(FS_PREFIX, qualifiers[0].value, true);
-				if (!StartUpload(file, qualifiers[0].value))
+				if (!StartUpload(file, FS_PREFIX, qualifiers[0].value, postFileLength, haveCrc, crc))
 				{
 					return RejectMessage("could not start file upload");
 				}
@@ -1523,6 +1970,8 @@ bool Webserver::HttpInterpreter::ProcessMessage()
 					platform->MessageF(HOST_MESSAGE, "Start uploading file %s length %lu\n", qualifiers[0].value, postFileLength);
 				}
 				uploadedBytes = 0;
+				uploadSucceeded = false;
+				uploadStartTime = millis();
 
 				// Keep track of the connection that is now uploading
 				uint32_t remoteIP = webserver->currentTransaction->GetRemoteIP();
@@ -1537,7 +1986,9 @@ bool Webserver::HttpInterpreter::ProcessMessage()
 					}
 				}
 
+				// Write any file data that arrived with the headers now instead of waiting for the next Spin
 				ResetState();
+				DoFastUpload();
 				return true;
 			}
 		}
@@ -2271,7 +2722,7 @@ void Webserver::FtpInterpreter::ProcessLine()
 				ReadFilename(4);
 
 				FileStore *file = platform->GetFileStore(currentDir, filename, true);
-				if (StartUpload(file, filename))
+				if (StartUpload(file, currentDir, filename, 0))
 				{
 					SendReply(150, "OK to send data.");
 					state = doingPasvIO;
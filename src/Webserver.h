@@ -47,10 +47,15 @@ const size_t minHttpResponseSize = 768;			// minimum number of bytes required fo
 const size_t maxCommandWords = 4;				// max number of space-separated words in the command
 const size_t maxQualKeys = 5;					// max number of key/value pairs in the qualifier
 const size_t maxHeaders = 16;					// max number of key/value pairs in the headers
+const size_t eTagLength = 32;					// buffer size for the ETags of files and rr_config responses
 
 const size_t  maxHttpSessions = 8;				// maximum number of simultaneous HTTP sessions
 const uint32_t httpSessionTimeout = 8000;		// HTTP session timeout in milliseconds
 
+const size_t maxStatusStreams = 4;				// maximum number of clients that can have status frames pushed to them (rr_stream)
+const uint32_t defaultStatusStreamInterval = 250;	// default interval between pushed status frames in milliseconds
+const uint32_t minStatusStreamInterval = 100;	// shortest interval between pushed status frames we allow
+
 /* FTP */
 
 const uint16_t ftpMessageLength = 128;			// maximum line length for incoming FTP commands
@@ -108,8 +113,13 @@ class ProtocolInterpreter
 		UploadState uploadState;
 		FileData fileBeingUploaded;
 		char filenameBeingUploaded[FILENAME_LENGTH];
+		bool indexingUpload;								// are we building a G-Code index for this upload?
+		bool checkingCrc;									// did the client tell us the CRC-32 of the file?
+		uint32_t expectedCrc;
+		CRC32 uploadCrc;									// CRC-32 of the data written so far
 
-		bool StartUpload(FileStore *file, const char *fileName);
+		bool StartUpload(FileStore *file, const char *directory, const char *fileName, uint32_t fileLength, bool haveCrc = false, uint32_t crc = 0);
+		bool WriteUploadData(const char *data, size_t len);
 		bool IsUploading() const;
 		bool FinishUpload(uint32_t fileLength);
 };
@@ -150,6 +160,7 @@ class Webserver
 			void Diagnostics();
 			void ConnectionLost(const ConnectionState *cs);
 			bool CharFromClient(const char c) override;
+			bool ParseRequest(NetworkTransaction *transaction);
 			void NoMoreDataAvailable() override;
 			void ResetState();
 			void ResetSessions();
@@ -194,6 +205,11 @@ class Webserver
 				const char* value;
 			};
 
+			size_t OrdinaryCharacters(const char *data, size_t length) const;
+			const char* GetHeaderValue(const char *key) const;
+			bool ClientHasETag(const char *eTag) const;
+			bool GetConfigETag(char *eTag) const;
+			void WriteCacheControl();
 			void SendFile(const char* nameOfFileToSend);
 			void SendConfigFile();
 			void SendGCodeReply();
@@ -248,12 +264,31 @@ class Webserver
 
 			// File uploads
 			uint32_t postFileLength, uploadedBytes;			// How many POST bytes do we expect and how many have already been written?
+			bool uploadSucceeded;							// result of the last upload, reported by rr_upload
+			uint32_t uploadStartTime, uploadDuration;		// for the diagnostics
 
 			// Deferred requests (rr_fileinfo)
 			ConnectionState * volatile deferredRequestConnection;	// Which connection expects a response for a deferred request?
 			char filenameBeingProcessed[FILENAME_LENGTH];	// The filename being processed (for rr_fileinfo)
 
 			void ProcessDeferredRequest();
+
+			// Status streams (rr_stream)
+			struct StatusStream
+			{
+				ConnectionState *cs;
+				uint32_t lastFrameTime;
+				uint16_t interval;
+				uint8_t type;
+			};
+
+			StatusStream statusStreams[maxStatusStreams];
+			size_t numStatusStreams;
+			uint32_t statusFramesBuilt, statusFramesSent;
+
+			void StartStatusStream();
+			void SendStatusFrames();
+			OutputBuffer *GetStatusFrame(uint8_t type);
 	};
 	HttpInterpreter *httpInterpreter;
 
@@ -362,6 +397,7 @@ class Webserver
     bool webserverActive;
 	NetworkTransaction *currentTransaction;
 	ConnectionState * volatile readingConnection;
+	GCodeIndexer *uploadIndexer;						// shared by all protocols, only one upload can be indexed at a time
 
     float longWait;
 };
@@ -0,0 +1,267 @@
+/*
+ * FileInfoTest.cpp
+ *
+ * Host test and benchmark of PrintMonitor::GetFileInfo. For each slicer, a G-Code file is written to the card from the
+ * start and end sections in samples/ with generated layers in between: a short one with three layers, and one of about
+ * 1.7MB like a real print. The test checks that GetFileInfo finds the expected values and exactly the values that the
+ * parser it replaced finds (OldPrintMonitor.cpp), then times both on the long files.
+ *
+ * Both parsers read the files through FileStore in the same chunks, so the difference in time is the parsing.
+ * The times are those of the host, where strstr is much faster than newlib's on the Duet.
+ *
+ * Usage: fileinfotest [image file [samples directory]]
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "RepRapFirmware.h"
+#include "diskio_host.h"
+#include "FirmwareHost.h"
+#include "HostTest.h"
+#include "OldPrintMonitor.h"
+
+const unsigned int ShortFileLayers = 3, ShortFileMoves = 20;
+const unsigned int LongFileLayers = 150, LongFileMoves = 400;
+const unsigned int Iterations = 50;
+
+// A slicer, how it starts a layer and what GetFileInfo should find in its files. In the layer template {n} is the layer
+// number counting from 1, {n0} counting from 0, {z2} and {z3} are the height with 2 and 3 decimals, and {moves} the moves.
+struct Slicer
+{
+	const char *name;
+	const char *layerTemplate;
+	float firstLayerHeight;
+	float layerHeight;
+	float filamentNeeded;
+	const char *generatedBy;
+};
+
+static const Slicer slicers[] =
+{
+	{ "slic3r", "G1 Z{z3} F7800.000\n{moves}", 0.3, 0.2, 3456.7, "Slic3r 1.2.9 on 2016-01-01 at 10:00:00" },
+	{ "cura", ";LAYER:{n0}\nG0 F9000 X100.000 Y100.000 Z{z3}\n{moves}", 0.3, 0.1, 2350.0, "Cura at Fri 01-01-2016 10:00:00" },
+	{ "simplify3d", "; layer {n}, Z = {z3}\nG1 Z{z3} F1000\n{moves}", 0.3, 0.2, 3456.7, "Simplify3D(R) Version 3.0.2" },
+	{ "kisslicer", "; BEGIN_LAYER_OBJECT z={z2}\nG1 Z{z2} F600\n{moves}; END_LAYER_OBJECT z={z2}\n", 0.3, 0.2,
+			7411.0 / (PI * (FILAMENT_WIDTH / 2.0) * (FILAMENT_WIDTH / 2.0)), "KISSlicer - PRO" }
+};
+
+static bool ReadSample(const std::string& fileName, std::string& text)
+{
+	FILE *f = fopen(fileName.c_str(), "rb");
+	if (f == nullptr)
+	{
+		printf("Can't read %s\n", fileName.c_str());
+		return false;
+	}
+	char buf[4096];
+	size_t n;
+	while ((n = fread(buf, 1, sizeof(buf), f)) != 0)
+	{
+		text.append(buf, n);
+	}
+	fclose(f);
+	return true;
+}
+
+static void Replace(std::string& text, const char *token, const std::string& value)
+{
+	for (size_t pos = text.find(token); pos != std::string::npos; pos = text.find(token, pos + value.length()))
+	{
+		text.replace(pos, strlen(token), value);
+	}
+}
+
+// The same random moves every time, with absolute extrusion
+static std::string MakeMoves(unsigned int count, uint32_t& seed, float& e)
+{
+	std::string moves;
+	char line[64];
+	for (unsigned int i = 0; i < count; i++)
+	{
+		seed = seed * 1103515245u + 12345u;
+		const float x = (seed >> 8) % 200000 / 1000.0;
+		seed = seed * 1103515245u + 12345u;
+		const float y = (seed >> 8) % 200000 / 1000.0;
+		seed = seed * 1103515245u + 12345u;
+		e += (seed >> 8) % 200000 / 100000.0;
+		snprintf(line, sizeof(line), "G1 X%.3f Y%.3f E%.5f\n", x, y, e);
+		moves += line;
+	}
+	return moves;
+}
+
+static std::string MakeGCode(const Slicer& slicer, const std::string& start, const std::string& end, unsigned int layers, unsigned int movesPerLayer)
+{
+	std::string gcode = start;
+	uint32_t seed = 1;
+	float e = 0.0;
+	for (unsigned int layer = 0; layer < layers; layer++)
+	{
+		const float z = slicer.firstLayerHeight + layer * slicer.layerHeight;
+		char num[16];
+		std::string text = slicer.layerTemplate;
+		snprintf(num, sizeof(num), "%u", layer + 1);
+		Replace(text, "{n}", num);
+		snprintf(num, sizeof(num), "%u", layer);
+		Replace(text, "{n0}", num);
+		snprintf(num, sizeof(num), "%.2f", z);
+		Replace(text, "{z2}", num);
+		snprintf(num, sizeof(num), "%.3f", z);
+		Replace(text, "{z3}", num);
+		Replace(text, "{moves}", MakeMoves(movesPerLayer, seed, e));
+		gcode += text;
+	}
+	return gcode + end;
+}
+
+static bool WriteFile(const char *fileName, const std::string& contents)
+{
+	Platform * const platform = reprap.GetPlatform();
+	FileStore * const f = platform->GetFileStore(platform->GetGCodeDir(), fileName, true);
+	if (f == nullptr)
+	{
+		return false;
+	}
+	bool ok = true;
+	for (size_t done = 0; ok && done < contents.length(); done += 4096)
+	{
+		ok = f->Write(contents.data() + done, std::min<size_t>(4096, contents.length() - done));
+	}
+	return f->Close() && ok;
+}
+
+static void GetNewFileInfo(const char *fileName, GCodeFileInfo& info)
+{
+	PrintMonitor * const printMonitor = reprap.GetPrintMonitor();
+	while (!printMonitor->GetFileInfo(reprap.GetPlatform()->GetGCodeDir(), fileName, info)) { }
+}
+
+static void GetOldFileInfo(OldPrintMonitor& oldPrintMonitor, const char *fileName, GCodeFileInfo& info)
+{
+	while (!oldPrintMonitor.GetFileInfo(reprap.GetPlatform()->GetGCodeDir(), fileName, info)) { }
+}
+
+static void PrintFileInfo(const char *parser, const GCodeFileInfo& info)
+{
+	printf("  %s: height %.3f, first layer %.3f, layer %.3f, filament", parser, info.objectHeight, info.firstLayerHeight, info.layerHeight);
+	for (unsigned int i = 0; i < info.numFilaments; i++)
+	{
+		printf(" %.1f", info.filamentNeeded[i]);
+	}
+	printf(", generated by \"%s\"\n", info.generatedBy);
+}
+
+static bool SameFileInfo(const GCodeFileInfo& a, const GCodeFileInfo& b)
+{
+	if (a.isValid != b.isValid || a.fileSize != b.fileSize || a.objectHeight != b.objectHeight || a.firstLayerHeight != b.firstLayerHeight
+		|| a.layerHeight != b.layerHeight || a.numFilaments != b.numFilaments || strcmp(a.generatedBy, b.generatedBy) != 0)
+	{
+		return false;
+	}
+	for (unsigned int i = 0; i < a.numFilaments; i++)
+	{
+		if (a.filamentNeeded[i] != b.filamentNeeded[i])
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool Near(float a, float b, float tolerance)
+{
+	return fabs(a - b) <= tolerance;
+}
+
+// Parse one file with both parsers and check the results
+static void TestFile(OldPrintMonitor& oldPrintMonitor, const Slicer& slicer, const char *fileName, unsigned int layers, size_t length)
+{
+	GCodeFileInfo newInfo, oldInfo;
+	GetNewFileInfo(fileName, newInfo);
+	GetOldFileInfo(oldPrintMonitor, fileName, oldInfo);
+
+	char what[80];
+	snprintf(what, sizeof(what), "%s: the parsers found the same information", fileName);
+	const bool same = SameFileInfo(newInfo, oldInfo);
+	Check(same, what);
+
+	const float objectHeight = slicer.firstLayerHeight + (layers - 1) * slicer.layerHeight;
+	snprintf(what, sizeof(what), "%s: the expected information", fileName);
+	const bool expected = newInfo.isValid && newInfo.fileSize == length && Near(newInfo.objectHeight, objectHeight, 0.001)
+							&& Near(newInfo.firstLayerHeight, slicer.firstLayerHeight, 0.001) && Near(newInfo.layerHeight, slicer.layerHeight, 0.001)
+							&& newInfo.numFilaments == 1 && Near(newInfo.filamentNeeded[0], slicer.filamentNeeded, 0.1)
+							&& StringEquals(newInfo.generatedBy, slicer.generatedBy);
+	Check(expected, what);
+
+	if (!same || !expected)
+	{
+		PrintFileInfo("new", newInfo);
+		PrintFileInfo("old", oldInfo);
+	}
+}
+
+// Time both parsers on one file, in microseconds per file
+static void Benchmark(OldPrintMonitor& oldPrintMonitor, const char *fileName, size_t length)
+{
+	GCodeFileInfo info;
+	double start = Now();
+	for (unsigned int i = 0; i < Iterations; i++)
+	{
+		GetOldFileInfo(oldPrintMonitor, fileName, info);
+	}
+	const double oldTime = (Now() - start) * 1.0e6 / Iterations;
+
+	start = Now();
+	for (unsigned int i = 0; i < Iterations; i++)
+	{
+		GetNewFileInfo(fileName, info);
+	}
+	const double newTime = (Now() - start) * 1.0e6 / Iterations;
+
+	printf("%-20s %8u bytes: old %8.1f us, new %8.1f us, %5.1f times as fast\n", fileName, (unsigned int)length, oldTime, newTime, oldTime / newTime);
+}
+
+int main(int argc, char **argv)
+{
+	setvbuf(stdout, nullptr, _IOLBF, 0);
+	const char * const imageFile = (argc > 1) ? argv[1] : "fileinfo.img";
+	const std::string samples = (argc > 2) ? argv[2] : "fileinfo/samples";
+	if (!StartFirmware(imageFile))
+	{
+		return 2;
+	}
+
+	// A file in the place of the index directory keeps GetFileInfo from storing what it finds, so every call parses the file
+	Platform * const platform = reprap.GetPlatform();
+	FileStore * const notADirectory = platform->GetFileStore(nullptr, GCODE_INDEX_DIR, true);
+	Check(notADirectory != nullptr && notADirectory->Close(), "file in the place of the index directory");
+
+	OldPrintMonitor oldPrintMonitor(platform);
+	for (const Slicer& slicer : slicers)
+	{
+		std::string start, end;
+		if (!ReadSample(samples + "/" + slicer.name + "-start.gcode", start) || !ReadSample(samples + "/" + slicer.name + "-end.gcode", end))
+		{
+			return 2;
+		}
+
+		const std::string shortFileName = std::string(slicer.name) + "-short.gcode";
+		const std::string shortFile = MakeGCode(slicer, start, end, ShortFileLayers, ShortFileMoves);
+		const std::string longFileName = std::string(slicer.name) + ".gcode";
+		const std::string longFile = MakeGCode(slicer, start, end, LongFileLayers, LongFileMoves);
+		Check(WriteFile(shortFileName.c_str(), shortFile) && WriteFile(longFileName.c_str(), longFile), "writing the G-Code files");
+
+		TestFile(oldPrintMonitor, slicer, shortFileName.c_str(), ShortFileLayers, shortFile.length());
+		TestFile(oldPrintMonitor, slicer, longFileName.c_str(), LongFileLayers, longFile.length());
+		Benchmark(oldPrintMonitor, longFileName.c_str(), longFile.length());
+	}
+
+	disk_host_close();
+	printf((hostFailures == 0) ? "All file info tests passed\n" : "%d file info tests failed\n", hostFailures);
+	return (hostFailures == 0) ? 0 : 1;
+}
+
+// End
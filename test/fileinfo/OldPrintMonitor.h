@@ -0,0 +1,38 @@
+/*
+ * OldPrintMonitor.h
+ *
+ * The G-Code file parser of PrintMonitor as it was before the single-pass ScanMetadata, kept as the reference for
+ * FileInfoTest.cpp. It has the same chunking as PrintMonitor::GetFileInfo, but doesn't use the G-Code index.
+ */
+
+#ifndef OLDPRINTMONITOR_H_
+#define OLDPRINTMONITOR_H_
+
+class OldPrintMonitor
+{
+	public:
+		OldPrintMonitor(Platform *p);
+
+		// Needs to be called until it returns true
+		bool GetFileInfo(const char *directory, const char *fileName, GCodeFileInfo& info);
+
+	private:
+		Platform *platform;
+
+		volatile FileParseState parseState;
+		char filenameBeingParsed[FILENAME_LENGTH];
+		FileStore *fileBeingParsed;
+		GCodeFileInfo parsedFileInfo;
+
+		char fileOverlap[GCODE_OVERLAP_SIZE];
+		size_t fileOverlapLength;
+
+		bool FindHeight(const char* buf, size_t len, float& height) const;
+		bool FindFirstLayerHeight(const char* buf, size_t len, float& layerHeight) const;
+		bool FindLayerHeight(const char* buf, size_t len, float& layerHeight) const;
+		unsigned int FindFilamentUsed(const char* buf, size_t len, float *filamentUsed, unsigned int maxFilaments) const;
+
+		float accumulatedParseTime, accumulatedReadTime;
+};
+
+#endif /* OLDPRINTMONITOR_H_ */
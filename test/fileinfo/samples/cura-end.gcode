@@ -0,0 +1,10 @@
+;End GCode
+M104 S0                     ;extruder heater off
+M140 S0                     ;heated bed heater off (if you have it)
+G91                                    ;relative positioning
+G1 E-1 F300                            ;retract the filament a bit before lifting the nozzle, to release some of the pressure
+G1 Z+0.5 E-5 X-20 Y-20 F9000 ;move Z up a bit and retract filament even more
+G28 X0 Y0                              ;move X/Y to min endstops, so the head is out of the way
+M84                         ;steppers off
+G90                         ;absolute positioning
+;CURA_PROFILE_STRING:eJzLSaxMLYrPSM1MzyixNdAz5ChPzMmJL8nITM7OSy0uBgpZcBSllhQlJpdk5ufFp+YlJuWk2oYUlaZyFOfnZKbE54ANQNZgxpGWCTQjJTWvOLOk0tbIgCMvv6oqJzW+OLMqFShvwlFQlJlXEl9ckJqaYmtqAOWWpOYWpBYllpQWpQL1wESTUlNQZMwMOIpLCwryi0ps/fLzUjkKchJL0vKLcuMTUzJSi4FOhAgDXZCYmwrUn5IJpEtSi2wN9cxNEcJpOfnltoYGBnoGyL6DuMgETTQxN780r8TWRM+UAyhWlpoDVWcIdHpSfklJfi40ECDCQP9m5oFDAMIHmZacn58Tn5uZBwutzNxUW6BrEmEBmgIN0ezMopL4nMy81PhksJ2GUKH0xAJbYz24dcihbcyRn5SVmgwMzsy8bLBlOaNROhqlo1E6GqWjUToapaNROhqlo1GKHKVKE2+cPSzgKFd3qLhiWeJJU4ka9idXk/NmHz7CsKnIZcdZq+kfpZ4FsrOyLeti+vAwcb35j5yd7O0Whws+1PVaR1ivtThU+tnrLWvWtVd9b5ZI6i/8t/OOt9y+0Kc7fm5reP89p/HKy9UGvh7Tfj6sv/GhMWXaLY4qu31n0rNW6cT2PNx8bM2eeLGClU3SxzVbr6fE1e5mr+D223Lz99zpU1KWams3WP1mPmrc9fpOj3V6c8TnG5OjSl+4rOiZ/XUXY9KJ25e+PPqwt/m8YsvxfpPcz3zV92In9hp/aMysuRCdFcHQ2TX/5JyQ0pnsZ60W6fZM1bsjfqb3zM2L7xw5rn9cIyR6j6WY+eBBd3sXmTPz9SO8BLU0HNs/a69wXbrNu2RzUH2lLJt/Unj2aQMnaYdnu5p+mX6fnXfxJ6slS6oq546vmkVbGtfmdl+1+PVz4ZmNLcWWbcvYU9dMPhu0YmEu/x4fhe9mD3j8hG4L+7/64LNPI2uCgyJT/4ObnNMvmn97NrFU+/K9ez+Pb5nfxJlgHCFpMmnN07zphnVSH1YlezfWswTPuZ/2zINFw/h28Pk/E04oheWauayRuJb4rifi1cNr6ztqjvzpsBHYySWqpK31stPM5VDozMbrjnFh4bJeNvc+zjr+ZfvjWqUpvUelgrgyhBLv/j2pekUhXHbutBNvE4Qn9VhOEPnsEvvEe0LHG9nSp27SJ7kvezPPXc0snil7+dEpLgPbk3+mZWvKFmuts9XYd0Mq/+W3hHM/ul5c9O5x2FYVIGm6LJCLjenk7zfeO2cEFqcEpAkIvAz8MfNHiYyD+Yl5x3896bq3oWJltJNelykAWKQgjA==
@@ -0,0 +1,22 @@
+;Sliced at: Fri 01-01-2016 10:00:00
+;Basic settings: Layer height: 0.1 Walls: 0.8 Fill: 20
+;Print time: 1 hour 2 minutes
+;Filament used: 2.35m 0.0g
+;Filament cost: None
+;M190 S60 ;Uncomment to add your own bed temperature line
+;M109 S200 ;Uncomment to add your own temperature line
+G21        ;metric values
+G90        ;absolute positioning
+M82        ;set extruder to absolute mode
+M107       ;start with the fan off
+G28 X0 Y0  ;move X/Y to min endstops
+G28 Z0     ;move Z to min endstops
+G1 Z15.0 F9000 ;move the platform down 15mm
+G92 E0                  ;zero the extruded length
+G1 F200 E3              ;extrude 3mm of feed stock
+G92 E0                  ;zero the extruded length again
+G1 F9000
+;Put printing message on LCD screen
+M117 Printing...
+
+;Layer count: 150
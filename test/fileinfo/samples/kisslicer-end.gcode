@@ -0,0 +1,33 @@
+;
+; *** G-code Postfix ***
+;
+M104 S0
+G28 X0
+M84
+;
+;
+; Estimated Build Time:   60.21 minutes
+; Estimated Build Volume: 7.411 cm^3
+; Estimated Build Cost:   $0.15
+;
+; *** Extrusion Time Breakdown ***
+; * estimated time in [s]
+; * before possibly slowing down for 'cool'
+; * not including Z-travel
+;	+-------------+-------------+-------------+-----------------------+
+;	| When Extrude| When Travel |  Total Time | Category              |
+;	+-------------+-------------+-------------+-----------------------+
+;	|     1160.01 |      134.71 |     1294.72 | Perimeter             |
+;	|      907.67 |       65.06 |      972.73 | Loop                  |
+;	|      802.88 |       58.21 |      861.09 | Solid                 |
+;	|      286.43 |       91.40 |      377.83 | Sparse Infill         |
+;	|       96.82 |        9.12 |      105.94 | Stacked Sparse Infill |
+;	|        0.00 |        0.00 |        0.00 | Support Interface     |
+;	|        0.00 |        0.00 |        0.00 | Support (may Stack)   |
+;	|        0.00 |        0.00 |        0.00 | Prime Pillar          |
+;	|        0.00 |        0.00 |        0.00 | Raft                  |
+;	|        0.00 |        0.00 |        0.00 | Pillar                |
+;	|        0.00 |        0.00 |        0.00 | Skirt                 |
+;	+-------------+-------------+-------------+-----------------------+
+;	|     3253.81 |      358.50 |     3612.31 | Total                 |
+;	+-------------+-------------+-------------+-----------------------+
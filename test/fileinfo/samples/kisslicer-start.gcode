@@ -0,0 +1,150 @@
+; KISSlicer - PRO
+; Windows Version 1.5
+; Built: Jan  1 2016, 10:00:00
+; Running on 8 cores
+;
+; Saved: Fri Jan 01 10:00:00 2016
+; 'part.gcode'
+;
+; *** Printer Settings ***
+;
+; printer_name = sample printer
+; bed_STL_filename = 
+; extension = gcode
+; cost_per_hour = 0
+; g_code_prefix = 3B202A2A2A20507265666978202A2A2A0A4732380A4739322045300A
+; g_code_warm = 4D31303920533C54454D503E0A
+; g_code_cool = 4D31303420533C54454D503E0A
+; g_code_N_layers = 
+; layer_N = 1
+; g_code_postfix = 4D3130342053300A4732382058300A4D38340A
+; post_process = NULL
+; every_N_layers = 0
+; num_extruders = 1
+; firmware_type = 1
+; add_comments = 1
+; fan_on = 4D31303620533C46414E3E0A
+; fan_off = 4D3130370A
+; fan_pwm = 1
+; add_m101_g10 = 0
+; z_speed_mm_per_s = 3.5
+; z_settle_mm = 0.25
+; bed_size_x_mm = 200
+; bed_size_y_mm = 200
+; bed_size_z_mm = 200
+; bed_offset_x_mm = 0
+; bed_offset_y_mm = 0
+; bed_offset_z_mm = 0
+; bed_roughness_mm = 0.125
+; travel_speed_mm_per_s = 130
+; first_layer_speed_mm_per_s = 20
+; dmax_per_layer_mm_per_s = 50
+; xy_accel_mm_per_s_per_s = 1500
+; lo_speed_perim_mm_per_s = 20
+; lo_speed_solid_mm_per_s = 30
+; lo_speed_sparse_mm_per_s = 40
+; hi_speed_perim_mm_per_s = 50
+; hi_speed_solid_mm_per_s = 60
+; hi_speed_sparse_mm_per_s = 80
+; ext_gain_1 = 1
+; ext_material_1 = 0
+; ext_axis_1 = 0
+; model_ext = 0
+; support_ext = 0
+; support_body_ext = 0
+; raft_ext = 0
+; solid_loop_overlap_fraction = 0.5
+;
+; *** Material Settings for Extruder 1 ***
+;
+; material_name = PLA
+; g_code_matl = 3B204D6174657269616C0A
+; fan_Z_mm = 0
+; fan_loops_percent = 100
+; fan_inset_percent = 100
+; fan_cool_percent = 100
+; fan_fractional_percent = 100
+; fan_support_percent = 100
+; fan_raft_percent = 100
+; fan_main_percent = 100
+; matl_mm_per_s = 100
+; cost_per_cm3 = 0.02
+; flowrate_tweak = 1
+; fiber_dia_mm = 1.75
+; color = 0
+; ext_temp_C = 200
+; bed_C = 60
+; bed_temp_C = 60
+; ext_idle_temp_C = 150
+; chamber_C = 0
+; first_layer_C = 205
+; first_layer_bed_C = 65
+; destring_suck = 1.0
+; destring_prime = 1.0
+; destring_min_mm = 2
+; destring_trigger_mm = 20
+; destring_speed_mm_per_s = 30
+; Z_lift_mm = 0
+; wipe_mm = 0
+; dwell_at_temp_s = 0
+; fan_pwm_at_C = 0
+;
+; *** Style Settings ***
+;
+; style_name = Default
+; layer_thickness_mm = 0.2
+; extrusion_width_mm = 0.45
+; num_loops = 2
+; skin_thickness_mm = 0.6
+; infill_extrusion_width = 0.45
+; infill_density_denominator = 4
+; stacked_layers = 1
+; use_destring = 1
+; use_wipe = 0
+; loops_insideout = 0
+; infill_st_oct_rnd = 1
+; inset_surface_xy_mm = 0
+; seam_jitter_degrees = 0
+; seam_depth_scaler = 1
+; seam_angle_degrees = 0
+; seam_reverse = 0
+; cost_of_seam = 20
+; bridge_speed_mm_per_s = 30
+; wiggle_factor = 0
+; solid_infill_angle = 45
+; first_layer_thickness_mm = 0.3
+; use_corners = 0
+; extra_perimeters = 0
+;
+; *** Support Settings ***
+;
+; support_name = None
+; support_sheathe = 0
+; support_density = 0
+; support_inflate_mm = 0
+; support_gap_mm = 0.5
+; support_angle_deg = 50
+; support_z_max_mm = -1
+; sheathe_z_max_mm = -1
+; raft_mode = 0
+; prime_pillar_mode = 0
+; raft_inflate_mm = 2
+; dense_support_layers = 0
+; support_interface_layers = 0
+;
+; *** Actual Slicing Settings As Used ***
+;
+; layer_thickness_mm = 0.2
+; extrusion_width = 0.45
+;
+; *** G-code Prefix ***
+;
+; *** Prefix ***
+G28
+G92 E0
+;
+; *** Main G-code ***
+;
+M109 S205
+M190 S65
+M106 S255
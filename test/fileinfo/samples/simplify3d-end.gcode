@@ -0,0 +1,11 @@
+G1 E-1.0000 F1800
+; layer end
+M104 S0 ; turn off extruder
+M140 S0 ; turn off bed
+M84 ; disable motors
+; Build Summary
+;   Build time: 1 hours 2 minutes
+;   Filament length: 3456.7 mm (3.46 m)
+;   Plastic volume: 8315.93 mm^3 (8.32 cc)
+;   Plastic weight: 10.40 g (0.02 lb)
+;   Material cost: 0.21
@@ -0,0 +1,197 @@
+; G-Code generated by Simplify3D(R) Version 3.0.2
+; Jan 1, 2016 at 10:00:00 AM
+; Settings Summary
+;   processName,Process1
+;   applyToModels,part
+;   profileName,Default
+;   profileVersion,2015-10-23 08:00:00
+;   baseProfile,
+;   printMaterial,PLA
+;   printQuality,Medium
+;   printExtruders,
+;   extruderName,Primary Extruder
+;   extruderToolheadNumber,0
+;   extruderDiameter,0.4
+;   extruderAutoWidth,1
+;   extruderWidth,0.48
+;   extrusionMultiplier,1
+;   extruderUseRetract,1
+;   extruderRetractionDistance,1
+;   extruderExtraRestartDistance,0
+;   extruderRetractionZLift,0
+;   extruderRetractionSpeed,1800
+;   extruderUseCoasting,0
+;   extruderCoastingDistance,0.2
+;   extruderUseWipe,0
+;   extruderWipeDistance,5
+;   primaryExtruder,0
+;   layerHeight,0.2
+;   topSolidLayers,3
+;   bottomSolidLayers,3
+;   perimeterOutlines,2
+;   printPerimetersInsideOut,1
+;   startPointOption,2
+;   startPointOriginX,0
+;   startPointOriginY,0
+;   sequentialIslands,0
+;   spiralVaseMode,0
+;   firstLayerHeightPercentage,150
+;   firstLayerWidthPercentage,100
+;   firstLayerUnderspeed,0.5
+;   useRaft,0
+;   raftExtruder,0
+;   raftTopLayers,3
+;   raftBaseLayers,2
+;   raftOffset,3
+;   raftSeparationDistance,0.14
+;   raftTopInfill,100
+;   aboveRaftSpeedMultiplier,0.3
+;   useSkirt,1
+;   skirtExtruder,0
+;   skirtLayers,1
+;   skirtOutlines,2
+;   skirtOffset,4
+;   usePrimePillar,0
+;   primePillarExtruder,999
+;   primePillarWidth,12
+;   primePillarLocation,7
+;   primePillarSpeedMultiplier,1
+;   useOozeShield,0
+;   oozeShieldExtruder,999
+;   oozeShieldOffset,2
+;   oozeShieldOutlines,1
+;   oozeShieldSidewallShape,1
+;   oozeShieldSidewallAngle,30
+;   oozeShieldSpeedMultiplier,1
+;   infillExtruder,0
+;   internalInfillPattern,Rectilinear
+;   externalInfillPattern,Rectilinear
+;   infillPercentage,20
+;   outlineOverlapPercentage,15
+;   infillExtrusionWidthPercent,100
+;   minInfillLength,5
+;   infillLayerInterval,1
+;   infillAngles,45,-45
+;   generateSupport,0
+;   supportExtruder,0
+;   supportInfillPercentage,30
+;   supportExtraInflation,0
+;   denseSupportLayers,0
+;   denseSupportInfillPercentage,70
+;   supportLayerInterval,1
+;   supportHorizontalPartOffset,0.3
+;   supportUpperSeparationLayers,1
+;   supportLowerSeparationLayers,1
+;   supportType,0
+;   supportGridSpacing,4
+;   maxOverhangAngle,45
+;   supportAngles,0
+;   temperatureName,Primary Extruder,Heated Bed
+;   temperatureNumber,0,1
+;   temperatureSetpointCount,1,1
+;   temperatureSetpointLayers,1,1
+;   temperatureSetpointTemperatures,200,60
+;   temperatureStabilizeAtStartup,1,1
+;   temperatureHeatedBed,0,1
+;   fanLayers,1,2
+;   fanSpeeds,0,100
+;   blipFanToFullPower,0
+;   adjustSpeedForCooling,1
+;   minSpeedLayerTime,15
+;   minCoolingSpeedSlowdown,20
+;   increaseFanForCooling,0
+;   minFanLayerTime,45
+;   maxCoolingFanSpeed,100
+;   increaseFanForBridging,0
+;   bridgingFanSpeed,100
+;   use5D,1
+;   relativeEdistances,0
+;   allowEaxisZeroing,1
+;   independentExtruderAxes,0
+;   includeM10123,0
+;   stickySupport,1
+;   applyToolheadOffsets,0
+;   gcodeXoffset,0
+;   gcodeYoffset,0
+;   gcodeZoffset,0
+;   overrideMachineDefinition,1
+;   machineTypeOverride,0
+;   strokeXoverride,200
+;   strokeYoverride,200
+;   strokeZoverride,200
+;   originOffsetXoverride,0
+;   originOffsetYoverride,0
+;   originOffsetZoverride,0
+;   homeXdirOverride,-1
+;   homeYdirOverride,-1
+;   homeZdirOverride,-1
+;   flipXoverride,1
+;   flipYoverride,-1
+;   flipZoverride,1
+;   toolheadOffsets,0,0|0,0|0,0|0,0|0,0|0,0
+;   overrideFirmwareConfiguration,1
+;   firmwareTypeOverride,RepRap (Marlin/Repetier/Sprinter)
+;   GPXconfigOverride,r2
+;   baudRateOverride,115200
+;   overridePrinterModels,0
+;   printerModelsOverride,
+;   startingGcode,G28 ; home all axes
+;   layerChangeGcode,
+;   retractionGcode,
+;   toolChangeGcode,
+;   endingGcode,M104 S0 ; turn off extruder,M140 S0 ; turn off bed,M84 ; disable motors
+;   exportFileFormat,gcode
+;   celebration,0
+;   celebrationSong,Random Song
+;   postProcessing,
+;   defaultSpeed,3600
+;   outlineUnderspeed,0.5
+;   solidInfillUnderspeed,0.8
+;   supportUnderspeed,0.8
+;   rapidXYspeed,4800
+;   rapidZspeed,1000
+;   minBridgingArea,50
+;   bridgingExtraInflation,0
+;   bridgingExtrusionMultiplier,1
+;   bridgingSpeedMultiplier,1
+;   filamentDiameter,1.75
+;   filamentPricePerKg,19.95
+;   filamentDensity,1.25
+;   useMinPrintHeight,0
+;   minPrintHeight,0
+;   useMaxPrintHeight,0
+;   maxPrintHeight,0
+;   useDiaphragm,0
+;   diaphragmLayerInterval,20
+;   robustSlicing,1
+;   mergeAllIntoSolid,0
+;   onlyRetractWhenCrossingOutline,1
+;   retractBetweenLayers,1
+;   useRetractionMinTravel,0
+;   retractionMinTravel,3
+;   retractWhileWiping,0
+;   onlyWipeOutlines,1
+;   avoidCrossingOutline,0
+;   maxMovementDetourFactor,3
+;   toolChangeRetractionDistance,12
+;   toolChangeExtraRestartDistance,-0.5
+;   toolChangeRetractionSpeed,600
+;   externalThinWallType,0
+;   internalThinWallType,2
+;   thinWallAllowedOverlapPercentage,10
+;   singleExtrusionMinLength,1
+;   singleExtrusionMinPrintingWidthPercentage,50
+;   singleExtrusionMaxPrintingWidthPercentage,200
+;   singleExtrusionEndpointExtension,0.2
+;   horizontalSizeCompensation,0
+G90
+M82
+M106 S0
+M140 S60
+M190 S60
+M104 S200 T0
+M109 S200 T0
+G28 ; home all axes
+G92 E0
+G1 E-1.0000 F1800
+; process Process1
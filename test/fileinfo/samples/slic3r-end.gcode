@@ -0,0 +1,137 @@
+G1 E-1.00000 F1800.00000
+G92 E0
+M107
+M104 S0 ; turn off temperature
+G28 X0  ; home X axis
+M84     ; disable motors
+
+; filament used = 3456.7mm (24.9cm3)
+
+; avoid_crossing_perimeters = 0
+; bed_shape = 0x0,200x0,200x200,0x200
+; bed_temperature = 60
+; before_layer_gcode = 
+; bridge_acceleration = 0
+; bridge_fan_speed = 100
+; brim_width = 0
+; complete_objects = 0
+; cooling = 1
+; default_acceleration = 0
+; disable_fan_first_layers = 3
+; duplicate_distance = 6
+; end_gcode = M104 S0 ; turn off temperature\nG28 X0  ; home X axis\nM84     ; disable motors\n
+; extruder_clearance_height = 20
+; extruder_clearance_radius = 20
+; extruder_offset = 0x0
+; extrusion_axis = E
+; extrusion_multiplier = 1
+; fan_always_on = 0
+; fan_below_layer_time = 60
+; filament_colour = #FFFFFF
+; filament_diameter = 1.75
+; first_layer_acceleration = 0
+; first_layer_bed_temperature = 60
+; first_layer_extrusion_width = 200%
+; first_layer_speed = 30
+; first_layer_temperature = 200
+; gcode_arcs = 0
+; gcode_comments = 0
+; gcode_flavor = reprap
+; infill_acceleration = 0
+; infill_first = 0
+; layer_gcode = 
+; max_fan_speed = 100
+; max_print_speed = 80
+; max_volumetric_speed = 0
+; min_fan_speed = 35
+; min_print_speed = 10
+; min_skirt_length = 0
+; notes = 
+; nozzle_diameter = 0.4
+; only_retract_when_crossing_perimeters = 1
+; ooze_prevention = 0
+; output_filename_format = [input_filename_base].gcode
+; perimeter_acceleration = 0
+; post_process = 
+; pressure_advance = 0
+; resolution = 0
+; retract_before_travel = 2
+; retract_layer_change = 1
+; retract_length = 1
+; retract_length_toolchange = 10
+; retract_lift = 0
+; retract_restart_extra = 0
+; retract_restart_extra_toolchange = 0
+; retract_speed = 30
+; skirt_distance = 6
+; skirt_height = 1
+; skirts = 1
+; slowdown_below_layer_time = 5
+; spiral_vase = 0
+; standby_temperature_delta = -5
+; start_gcode = G28 ; home all axes\nG1 Z5 F5000 ; lift nozzle\n
+; temperature = 200
+; threads = 2
+; toolchange_gcode = 
+; travel_speed = 130
+; use_firmware_retraction = 0
+; use_relative_e_distances = 0
+; use_volumetric_e = 0
+; vibration_limit = 0
+; wipe = 0
+; z_offset = 0
+; dont_support_bridges = 1
+; extrusion_width = 0
+; first_layer_height = 0.3
+; infill_only_where_needed = 0
+; interface_shells = 0
+; layer_height = 0.2
+; raft_layers = 0
+; seam_position = aligned
+; support_material = 0
+; support_material_angle = 0
+; support_material_contact_distance = 0.2
+; support_material_enforce_layers = 0
+; support_material_extruder = 1
+; support_material_extrusion_width = 0
+; support_material_interface_extruder = 1
+; support_material_interface_layers = 3
+; support_material_interface_spacing = 0
+; support_material_interface_speed = 100%
+; support_material_pattern = pillars
+; support_material_spacing = 2.5
+; support_material_speed = 60
+; support_material_threshold = 0
+; xy_size_compensation = 0
+; bottom_solid_layers = 3
+; bridge_flow_ratio = 1
+; bridge_speed = 60
+; external_fill_pattern = rectilinear
+; external_perimeter_extrusion_width = 0
+; external_perimeter_speed = 50%
+; external_perimeters_first = 0
+; extra_perimeters = 1
+; fill_angle = 45
+; fill_density = 20%
+; fill_pattern = honeycomb
+; gap_fill_speed = 20
+; infill_every_layers = 1
+; infill_extruder = 1
+; infill_extrusion_width = 0
+; infill_overlap = 15%
+; infill_speed = 80
+; overhangs = 1
+; perimeter_extruder = 1
+; perimeter_extrusion_width = 0
+; perimeter_speed = 60
+; perimeters = 3
+; small_perimeter_speed = 15
+; solid_infill_below_area = 70
+; solid_infill_every_layers = 0
+; solid_infill_extruder = 1
+; solid_infill_extrusion_width = 0
+; solid_infill_speed = 20
+; thin_walls = 1
+; top_infill_extrusion_width = 0
+; top_solid_infill_speed = 15
+; top_solid_layers = 3
@@ -0,0 +1,22 @@
+; generated by Slic3r 1.2.9 on 2016-01-01 at 10:00:00
+
+; external perimeters extrusion width = 0.45mm
+; perimeters extrusion width = 0.45mm
+; infill extrusion width = 0.45mm
+; solid infill extrusion width = 0.45mm
+; top infill extrusion width = 0.45mm
+; first layer extrusion width = 0.42mm
+
+M107
+M190 S60 ; set bed temperature
+M104 S200 ; set temperature
+G28 ; home all axes
+G1 Z5 F5000 ; lift nozzle
+
+M109 S200 ; wait for temperature to be reached
+G21 ; set units to millimeters
+G90 ; use absolute coordinates
+M82 ; use absolute distances for extrusion
+G92 E0
+G1 E-1.00000 F1800.00000
+G92 E0
@@ -0,0 +1,75 @@
+// Host stand-in for the parts of the Arduino Due core that the network and file code use
+
+#ifndef ARDUINO_HOST_H_INCLUDED
+#define ARDUINO_HOST_H_INCLUDED
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+typedef uint32_t irqflags_t;
+typedef uint8_t byte;
+typedef int EAnalogChannel;
+
+struct OutputPin
+{
+	OutputPin() { }
+	OutputPin(int) { }
+	void SetHigh() const { }
+	void SetLow() const { }
+};
+
+enum { X0 = 100, X1, X2, X3, X4, X5, X6, X7, X8, X9, X10, X11, X12, X13, X14, X15, X16, X17 };
+
+#define PI			3.14159265f
+#define VARIANT_MCK	84000000
+#define HIGH		1
+#define LOW			0
+#define INPUT		0
+#define OUTPUT		1
+
+#define __disable_irq()
+#define __enable_irq()
+#define __DSB()
+#define __get_MSP()	0
+
+struct TcChannel { uint32_t TC_CV, TC_RA, TC_RC, TC_SR, TC_CCR, TC_IER, TC_IDR; };
+struct TcBlock { TcChannel TC_CHANNEL[3]; };
+extern TcBlock *TC1;
+
+typedef int spi_status_t;
+struct spi_device { int id; };
+
+extern "C"
+{
+	uint32_t millis();
+	uint32_t micros();
+	void delay(uint32_t ms);
+	void delayMicroseconds(uint32_t us);
+	int stricmp(const char *s1, const char *s2);
+}
+
+irqflags_t cpu_irq_save();
+void cpu_irq_restore(irqflags_t flags);
+void cpu_irq_enable();
+void cpu_irq_disable();
+bool inInterrupt();
+
+int digitalRead(int pin);
+void digitalWrite(int pin, int value);
+void pinMode(int pin, int mode);
+int analogRead(int pin);
+void analogWrite(int pin, int value);
+void watchdogEnable(int ms);
+void watchdogReset();
+
+long random(long howbig);
+long random(long howsmall, long howbig);
+
+inline bool isDigit(char c) { return c >= '0' && c <= '9'; }
+inline bool isAlpha(char c) { return (c | 0x20) >= 'a' && (c | 0x20) <= 'z'; }
+
+#endif
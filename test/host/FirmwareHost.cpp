@@ -0,0 +1,390 @@
+/*
+ * FirmwareHost.cpp
+ *
+ * Host versions of the functions that Network, Webserver, PrintMonitor and the file system code need from the rest
+ * of the firmware and from the Arduino core, see FirmwareHost.h.
+ */
+
+#include <chrono>
+#include <cstdarg>
+#include <strings.h>
+
+#include "RepRapFirmware.h"
+#include "FirmwareHost.h"
+
+HostCounters hostCounters;
+std::string hostLastGCode;
+bool hostVerbose = false;
+
+//*************************************************************************************************
+// Arduino core
+
+static const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+TcBlock *TC1 = nullptr;
+
+extern "C" uint32_t micros()
+{
+	return (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+extern "C" uint32_t millis()
+{
+	return (uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+extern "C" void delay(uint32_t ms)
+{
+	const uint32_t start = millis();
+	while (millis() - start < ms) { }
+}
+
+extern "C" void delayMicroseconds(uint32_t us)
+{
+	const uint32_t start = micros();
+	while (micros() - start < us) { }
+}
+
+extern "C" int stricmp(const char *s1, const char *s2)
+{
+	return strcasecmp(s1, s2);
+}
+
+irqflags_t cpu_irq_save() { return 0; }
+void cpu_irq_restore(irqflags_t flags) { }
+bool inInterrupt() { return false; }
+
+long random(long howbig)
+{
+	return (howbig <= 0) ? 0 : ::random() % howbig;
+}
+
+long random(long howsmall, long howbig)
+{
+	return (howsmall >= howbig) ? howsmall : howsmall + random(howbig - howsmall);
+}
+
+// Platform has these devices as members, but the host never talks to them
+MAX31855::MAX31855(uint8_t cs, bool deferInit) { }
+MCP4461::MCP4461() { }
+
+//*************************************************************************************************
+// Platform - only the file system, the network settings and the messages
+
+Platform::Platform() :
+		autoSaveEnabled(false), board(DEFAULT_BOARD_TYPE), active(false), errorCodeBits(0),
+		fileStructureInitialised(false), tickState(0), debugCode(0)
+{
+	ioStatistics = new IoStatistics(this);
+	macroCache = new MacroCache(this);
+	massStorage = new MassStorage(this);
+
+	for (size_t i = 0; i < MAX_FILES; i++)
+	{
+		files[i] = new FileStore(this);
+	}
+
+	ARRAY_INIT(nvData.ipAddress, IP_ADDRESS);
+	ARRAY_INIT(nvData.netMask, NET_MASK);
+	ARRAY_INIT(nvData.gateWay, GATE_WAY);
+	ARRAY_INIT(nvData.macAddress, MAC_ADDRESS);
+}
+
+// The FAT image must have been opened with disk_host_open before this is called
+void Platform::Init()
+{
+	configGeneration = ::random();
+	bootId = ::random();
+
+	massStorage->Init();
+	for (size_t file = 0; file < MAX_FILES; file++)
+	{
+		files[file]->Init();
+	}
+	fileStructureInitialised = true;
+
+	nozzleDiameter = NOZZLE_DIAMETER;
+	filamentWidth = FILAMENT_WIDTH;
+	sysDir = SYS_DIR;
+	macroDir = MACRO_DIR;
+	webDir = WEB_DIR;
+	gcodeDir = GCODE_DIR;
+	configFile = CONFIG_FILE;
+	defaultFile = DEFAULT_FILE;
+	active = true;
+}
+
+float Platform::Time()
+{
+	return micros() * TIME_FROM_REPRAP;
+}
+
+void Platform::ClassReport(float &lastTime)
+{
+}
+
+FileStore* Platform::GetFileStore(const char* directory, const char* fileName, bool write)
+{
+	if (!fileStructureInitialised)
+	{
+		return nullptr;
+	}
+
+	for (size_t i = 0; i < MAX_FILES; i++)
+	{
+		if (!files[i]->inUse)
+		{
+			if (files[i]->Open(directory, fileName, write))
+			{
+				files[i]->inUse = true;
+				return files[i];
+			}
+			else
+			{
+				return nullptr;
+			}
+		}
+	}
+	Message(HOST_MESSAGE, "Max open file count exceeded.\n");
+	return NULL;
+}
+
+void Platform::Message(const MessageType type, const char *message)
+{
+	switch (type)
+	{
+		case HTTP_MESSAGE:
+		case TELNET_MESSAGE:
+			reprap.GetWebserver()->HandleGCodeReply((type == HTTP_MESSAGE) ? WebSource::HTTP : WebSource::Telnet, message);
+			break;
+
+		default:
+			if (strstr(message, "no free transactions") != nullptr)
+			{
+				++hostCounters.noFreeTransactions;
+			}
+			else
+			{
+				++hostCounters.messages;
+			}
+			if (hostVerbose)
+			{
+				fputs(message, stdout);
+			}
+			break;
+	}
+}
+
+void Platform::MessageF(const MessageType type, const char *fmt, va_list vargs)
+{
+	char formatBuffer[FORMAT_STRING_LENGTH];
+	StringRef formatString(formatBuffer, ARRAY_SIZE(formatBuffer));
+	formatString.vprintf(fmt, vargs);
+	Message(type, formatBuffer);
+}
+
+void Platform::MessageF(const MessageType type, const char *fmt, ...)
+{
+	va_list vargs;
+	va_start(vargs, fmt);
+	MessageF(type, fmt, vargs);
+	va_end(vargs);
+}
+
+//*************************************************************************************************
+// RepRap - the network modules, and fixed responses instead of the machine status
+
+RepRap::RepRap() : toolList(nullptr), currentTool(nullptr), lastToolWarningTime(0.0), activeExtruders(0),
+	activeToolHeaters(0), ticksInSpinState(0), spinningModule(noModule), debug(0), stopped(false),
+	active(false), resetting(false), processingConfig(true), beepFrequency(0), beepDuration(0)
+{
+	OutputBuffer::Init();
+	platform = new Platform();
+	network = new Network(platform);
+	webserver = new Webserver(platform, network);
+	gCodes = nullptr;
+	move = nullptr;
+	heat = nullptr;
+	printMonitor = new PrintMonitor(platform, nullptr);
+	statusTracker = nullptr;
+	auxStatusTracker = nullptr;
+
+	strncpy(password, DEFAULT_PASSWORD, ARRAY_SIZE(password));
+	strncpy(myName, DEFAULT_NAME, ARRAY_SIZE(myName));
+	message[0] = 0;
+}
+
+void RepRap::Init()
+{
+	platform->Init();
+	network->Init();
+	webserver->Init();
+	printMonitor->Init();
+	active = true;
+	processingConfig = false;
+	network->Enable();
+}
+
+// Run G-Codes from a Webserver source until it has no more, answering each line with "ok" like GCodes does
+static void RunGCodes(Webserver *webserver, WebSource source, MessageType replyType, std::string& line)
+{
+	while (webserver->GCodeAvailable(source))
+	{
+		const char c = webserver->ReadGCode(source);
+		if (c == '\n' || c == 0)
+		{
+			++hostCounters.gcodesRun;
+			hostLastGCode = line;
+			line.clear();
+			reprap.GetPlatform()->Message(replyType, "ok\n");
+		}
+		else
+		{
+			line += c;
+		}
+	}
+}
+
+void RepRap::Spin()
+{
+	if (!active)
+		return;
+
+	spinningModule = moduleNetwork;
+	network->Spin();
+
+	spinningModule = moduleWebserver;
+	webserver->Spin();
+
+	spinningModule = moduleGcodes;
+	static std::string httpLine, telnetLine;
+	RunGCodes(webserver, WebSource::HTTP, HTTP_MESSAGE, httpLine);
+	RunGCodes(webserver, WebSource::Telnet, TELNET_MESSAGE, telnetLine);
+
+	// The tick interrupt keeps the lwIP timers going
+	network->Interrupt();
+	spinningModule = noModule;
+}
+
+void RepRap::EmergencyStop()
+{
+}
+
+bool RepRap::NoPasswordSet() const
+{
+	return (!password[0] || StringEquals(password, DEFAULT_PASSWORD));
+}
+
+bool RepRap::CheckPassword(const char *pw) const
+{
+	return StringEquals(pw, password);
+}
+
+bool RepRap::IsHeaterAssignedToTool(int8_t heater) const
+{
+	return false;
+}
+
+// A status response of about the same length and shape as a type 1 response of an idle single-tool machine
+OutputBuffer *RepRap::GetStatusResponse(uint8_t type, ResponseSource source, uint32_t since)
+{
+	static uint32_t seq = 0;
+	OutputBuffer *response;
+	if (!OutputBuffer::Allocate(response))
+	{
+		return nullptr;
+	}
+
+	char status[512];
+	snprintf(status, ARRAY_SIZE(status), "{\"status\":\"I\",\"coords\":{\"axesHomed\":[0,0,0],\"extr\":[0.0],\"xyz\":[0.00,0.00,0.00]},"
+			"\"currentTool\":-1,\"params\":{\"atxPower\":0,\"fanPercent\":[0.00,100.00],\"speedFactor\":100.00,\"extrFactors\":[100.00]},"
+			"\"seq\":%u,\"sensors\":{\"probeValue\":0,\"fanRPM\":0},\"temps\":{\"bed\":{\"current\":21.4,\"active\":0.0,\"state\":0,\"heater\":0},"
+			"\"heads\":{\"current\":[21.2],\"active\":[0.0],\"standby\":[0.0],\"state\":[0]},\"names\":[\"\"],\"tempLimit\":262.0},"
+			"\"time\":%.1f}", (unsigned int)++seq, (double)platform->Time());
+	response->copy(status);
+	return response;
+}
+
+OutputBuffer *RepRap::GetLegacyStatusResponse(uint8_t type, int seq)
+{
+	return GetStatusResponse(type, ResponseSource::HTTP, 0);
+}
+
+OutputBuffer *RepRap::GetConfigResponse()
+{
+	OutputBuffer *response;
+	if (!OutputBuffer::Allocate(response))
+	{
+		return nullptr;
+	}
+	response->printf("{\"axisMins\":[0.0,0.0,0.0],\"axisMaxes\":[230.0,210.0,200.0],\"firmwareName\":\"%s\",\"firmwareVersion\":\"%s\"}", NAME, VERSION);
+	return response;
+}
+
+OutputBuffer *RepRap::GetFilesResponse(const char *dir, bool flagsDirs)
+{
+	OutputBuffer *response;
+	if (!OutputBuffer::Allocate(response))
+	{
+		return nullptr;
+	}
+
+	response->copy("{\"dir\":");
+	response->EncodeString(dir, strlen(dir), false);
+	response->cat(",\"files\":[");
+
+	FileInfo fileInfo;
+	bool firstFile = true;
+	for (bool gotFile = platform->GetMassStorage()->FindFirst(dir, fileInfo); gotFile; gotFile = platform->GetMassStorage()->FindNext(fileInfo))
+	{
+		if (OutputBuffer::GetBytesLeft(response) < strlen(fileInfo.fileName) * 2 + 4)
+		{
+			break;
+		}
+		if (!firstFile)
+		{
+			response->cat(',');
+		}
+		response->EncodeString(fileInfo.fileName, FILENAME_LENGTH, false);
+		firstFile = false;
+	}
+	response->cat("],\"err\":0}");
+	return response;
+}
+
+//*************************************************************************************************
+// GCodes, Move and Heat - PrintMonitor only asks them about the print, and the host never prints
+
+void GCodes::Reset()
+{
+}
+
+bool GCodes::IsRunning() const
+{
+	return false;
+}
+
+float GCodes::FractionOfFilePrinted() const
+{
+	return 0.0;
+}
+
+bool Move::IsExtruding() const
+{
+	return false;
+}
+
+void Move::LiveCoordinates(float m[DRIVES])
+{
+	for (size_t drive = 0; drive < DRIVES; drive++)
+	{
+		m[drive] = 0.0;
+	}
+}
+
+bool Heat::HeaterAtSetTemperature(int8_t heater) const
+{
+	return false;
+}
+
+// End
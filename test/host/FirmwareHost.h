@@ -0,0 +1,26 @@
+/*
+ * FirmwareHost.h
+ *
+ * The host tests link Network, Webserver, PrintMonitor and the file system code of the firmware, but not the machine
+ * control classes. FirmwareHost.cpp stands in for the parts of Platform, RepRap, GCodes, Move and Heat that they call.
+ * G-Codes from HTTP and Telnet are answered with "ok" the way GCodes would, without executing them.
+ */
+
+#ifndef FIRMWAREHOST_H_
+#define FIRMWAREHOST_H_
+
+#include <cstdint>
+#include <string>
+
+struct HostCounters
+{
+	uint32_t noFreeTransactions;		// "no free transactions" messages from Network
+	uint32_t messages;					// all other messages for the host
+	uint32_t gcodesRun;					// G-Code lines read from the Webserver
+};
+
+extern HostCounters hostCounters;
+extern std::string hostLastGCode;		// the last G-Code line read from the Webserver, without the terminator
+extern bool hostVerbose;				// print the messages for the host as well as counting them
+
+#endif /* FIRMWAREHOST_H_ */
@@ -0,0 +1,102 @@
+/*
+ * HostTest.cpp
+ *
+ * Helpers shared by the host tests, see HostTest.h
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "RepRapFirmware.h"
+#include "diskio_host.h"
+#include "FirmwareHost.h"
+#include "HostTest.h"
+
+int hostFailures = 0;
+
+void Check(bool condition, const char *what)
+{
+	if (!condition)
+	{
+		printf("FAILED: %s\n", what);
+		++hostFailures;
+	}
+}
+
+double Now()
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Write an empty FAT16 file system of 32MB, FatFs is built without f_mkfs
+static bool MakeImage(const char *fileName)
+{
+	const size_t sectorSize = 512, totalSectors = 65536, reservedSectors = 1, fatSectors = 64, rootEntries = 512;
+	std::vector<uint8_t> sector(sectorSize, 0);
+
+	FILE *f = fopen(fileName, "wb");
+	if (f == nullptr)
+	{
+		return false;
+	}
+
+	static const uint8_t bootSector[62] = {
+		0xEB, 0x3C, 0x90, 'M', 'S', 'D', 'O', 'S', '5', '.', '0',
+		0x00, 0x02,						// bytes per sector
+		4,								// sectors per cluster
+		reservedSectors, 0x00,
+		2,								// number of FATs
+		rootEntries & 0xFF, rootEntries >> 8,
+		0x00, 0x00,						// total sectors, see below
+		0xF8,							// media descriptor
+		fatSectors, 0x00,
+		63, 0, 255, 0,					// sectors per track, heads
+		0, 0, 0, 0,						// hidden sectors
+		0x00, 0x00, 0x01, 0x00,			// total sectors
+		0x80, 0x00, 0x29, 0x78, 0x56, 0x34, 0x12,
+		'N', 'O', ' ', 'N', 'A', 'M', 'E', ' ', ' ', ' ', ' ',
+		'F', 'A', 'T', '1', '6', ' ', ' ', ' '
+	};
+	memcpy(sector.data(), bootSector, sizeof(bootSector));
+	sector[510] = 0x55;
+	sector[511] = 0xAA;
+	bool ok = fwrite(sector.data(), sectorSize, 1, f) == 1;
+
+	std::vector<uint8_t> empty(sectorSize, 0);
+	for (size_t i = 1; ok && i < totalSectors; i++)
+	{
+		const bool fatStart = (i == reservedSectors || i == reservedSectors + fatSectors);
+		if (fatStart)
+		{
+			static const uint8_t fatEntries[4] = { 0xF8, 0xFF, 0xFF, 0xFF };
+			memcpy(sector.data(), fatEntries, sizeof(fatEntries));
+			memset(sector.data() + sizeof(fatEntries), 0, sectorSize - sizeof(fatEntries));
+		}
+		ok = fwrite((fatStart) ? sector.data() : empty.data(), sectorSize, 1, f) == 1;
+	}
+	return fclose(f) == 0 && ok;
+}
+
+bool StartFirmware(const char *imageFile)
+{
+	if (!MakeImage(imageFile) || disk_host_open(imageFile) != 0)
+	{
+		printf("Can't create the FAT image %s\n", imageFile);
+		return false;
+	}
+
+	hostVerbose = true;
+	reprap.Init();
+	hostVerbose = false;
+	MassStorage * const massStorage = reprap.GetPlatform()->GetMassStorage();
+	if (!massStorage->MakeDirectory("0:/www") || !massStorage->MakeDirectory("0:/gcodes") || !massStorage->MakeDirectory("0:/sys"))
+	{
+		printf("Can't make the directories on the card\n");
+		return false;
+	}
+	return true;
+}
+
+// End
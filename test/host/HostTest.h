@@ -0,0 +1,19 @@
+/*
+ * HostTest.h
+ *
+ * Helpers shared by the host tests: failure counting, timing, and starting the firmware modules on a fresh FAT image.
+ */
+
+#ifndef HOSTTEST_H_
+#define HOSTTEST_H_
+
+extern int hostFailures;
+
+void Check(bool condition, const char *what);		// Count and report a failure if condition is false
+double Now();										// Seconds from an arbitrary start, for timing
+
+// Create an empty FAT image, use it as the card, initialise the modules in FirmwareHost.cpp and make the
+// www, gcodes and sys directories. Returns false after printing the reason if it can't.
+bool StartFirmware(const char *imageFile);
+
+#endif /* HOSTTEST_H_ */
@@ -0,0 +1,2 @@
+// Host stand-in for the Arduino core's WMath.h, which lwipopts.h includes for LWIP_RAND
+#include <stdlib.h>
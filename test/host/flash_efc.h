@@ -0,0 +1 @@
+// Host stand-in, the firmware sources only need this header to exist
@@ -0,0 +1,21 @@
+// Host stand-in for the ASF SD/MMC stack. The card is the FAT image opened by diskio_host.c.
+
+#ifndef SD_MMC_HOST_H_INCLUDED
+#define SD_MMC_HOST_H_INCLUDED
+
+#include <stdint.h>
+
+typedef uint8_t sd_mmc_err_t;
+
+#define SD_MMC_OK				0
+#define SD_MMC_ERR_NO_CARD		1
+#define SD_MMC_ERR_UNUSABLE		2
+#define SD_MMC_ERR_SLOT			3
+#define SD_MMC_ERR_COMM			4
+#define SD_MMC_ERR_PARAM		5
+#define SD_MMC_ERR_WP			6
+
+inline void sd_mmc_init() { }
+inline sd_mmc_err_t sd_mmc_check(uint8_t slot) { return SD_MMC_OK; }
+
+#endif
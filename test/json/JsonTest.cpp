@@ -0,0 +1,390 @@
+/*
+ * JsonTest.cpp
+ *
+ * Host test and benchmark of JsonWriter. A type 2 status response with typical values is built twice, once with the
+ * OutputBuffer::catf calls that RepRap::GetStatusResponse used before JsonWriter and once with JsonWriter, and the two
+ * must be identical. Both are timed, and the stack each one needs is measured by running it on a thread whose stack
+ * was filled with a pattern beforehand. Then JsonWriter::FormatFloat is compared with snprintf's %.<n>f.
+ *
+ * The times are those of the host. The stack figures are of the host build too, but the difference between the two
+ * comes mostly from vsnprintf and the FORMAT_STRING_LENGTH buffer of catf, which the Duet build has as well.
+ *
+ * Usage: jsontest
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <pthread.h>
+#include <string>
+
+#include "RepRapFirmware.h"
+#include "HostTest.h"
+
+const unsigned int Iterations = 200000;
+const size_t ThreadStackSize = 64 * 1024;
+
+static const float coords[AXES] = { 123.456, -45.678, 0.3 };
+static const float extruderPositions[2] = { 1234.56, 0.0 };
+static const float fanValues[3] = { 0.5, 1.0, 0.0 };
+static const float temperatures[3] = { 60.12, 210.04, 24.9 }, activeTemperatures[3] = { 60.0, 210.0, 0.0 }, standbyTemperatures[3] = { 0.0, 180.0, 0.0 };
+static const char * const geometry = "cartesian";
+static const char * const machineName = "My \"Printer\"";
+
+// The response as the catf version of GetStatusResponse wrote it
+static OutputBuffer *CatfResponse()
+{
+	OutputBuffer *response;
+	if (!OutputBuffer::Allocate(response))
+	{
+		return nullptr;
+	}
+
+	response->printf("{\"status\":\"%c\",\"coords\":{", 'P');
+	response->catf("\"axesHomed\":[%d,%d,%d]", 1, 1, 1);
+	response->catf(",\"extr\":");
+	char ch = '[';
+	for (size_t extruder = 0; extruder < 2; extruder++)
+	{
+		response->catf("%c%.1f", ch, extruderPositions[extruder]);
+		ch = ',';
+	}
+	response->cat("],\"xyz\":");
+	ch = '[';
+	for (size_t axis = 0; axis < AXES; axis++)
+	{
+		response->catf("%c%.2f", ch, coords[axis]);
+		ch = ',';
+	}
+	response->catf("]},\"currentTool\":%d", 0);
+	response->catf(",\"params\":{\"atxPower\":%d", 0);
+	response->cat(",\"fanPercent\":[");
+	for (size_t fan = 0; fan < 3; fan++)
+	{
+		response->catf((fan == 2) ? "%.2f" : "%.2f,", fanValues[fan] * 100.0);
+	}
+	response->catf("],\"speedFactor\":%.2f,\"extrFactors\":", 100.0);
+	ch = '[';
+	for (size_t extruder = 0; extruder < 2; extruder++)
+	{
+		response->catf("%c%.2f", ch, 100.0);
+		ch = ',';
+	}
+	response->cat("]}");
+	response->catf(",\"seq\":%d", 12);
+	response->cat(",\"sensors\":{");
+	response->catf("\"probeValue\":%d", 0);
+	response->catf(",\"fanRPM\":%d}", 0);
+	response->cat(",\"temps\":{");
+	response->catf("\"bed\":{\"current\":%.1f,\"active\":%.1f,\"state\":%d},", temperatures[0], activeTemperatures[0], 2);
+	response->cat("\"heads\":{\"current\":");
+	ch = '[';
+	for (size_t heater = 1; heater < 3; heater++)
+	{
+		response->catf("%c%.1f", ch, temperatures[heater]);
+		ch = ',';
+	}
+	response->cat("],\"active\":");
+	ch = '[';
+	for (size_t heater = 1; heater < 3; heater++)
+	{
+		response->catf("%c%.1f", ch, activeTemperatures[heater]);
+		ch = ',';
+	}
+	response->cat("],\"standby\":");
+	ch = '[';
+	for (size_t heater = 1; heater < 3; heater++)
+	{
+		response->catf("%c%.1f", ch, standbyTemperatures[heater]);
+		ch = ',';
+	}
+	response->cat("],\"state\":");
+	ch = '[';
+	for (size_t heater = 1; heater < 3; heater++)
+	{
+		response->catf("%c%d", ch, 2);
+		ch = ',';
+	}
+	response->cat("]}}");
+	response->catf(",\"time\":%.1f", 12345.67);
+	response->catf(",\"coldExtrudeTemp\":%1.f", 160.0);
+	response->catf(",\"coldRetractTemp\":%1.f", 90.0);
+	response->catf(",\"endstops\":%d", 0);
+	response->catf(",\"geometry\":\"%s\"", geometry);
+	response->cat(",\"name\":");
+	response->EncodeString(machineName, 40, false);
+	response->catf(",\"probe\":{\"threshold\":%d", 500);
+	response->catf(",\"height\":%.2f", 0.7);
+	response->catf(",\"type\":%d}", 1);
+	response->cat(",\"tools\":[");
+	response->catf("{\"number\":%d,\"heaters\":[", 0);
+	response->catf("%d", 1);
+	response->cat("],\"drives\":[");
+	response->catf("%d", 0);
+	response->cat("]}]}");
+	return response;
+}
+
+// The same response as GetStatusResponse writes it now
+static OutputBuffer *JsonWriterResponse()
+{
+	OutputBuffer *response;
+	if (!OutputBuffer::Allocate(response))
+	{
+		return nullptr;
+	}
+
+	JsonWriter json(response);
+	json.StartObject();
+	json.String("status", "P");
+	json.StartObject("coords");
+	json.StartArray("axesHomed");
+	for (size_t axis = 0; axis < AXES; axis++)
+	{
+		json.Int(nullptr, 1);
+	}
+	json.EndArray();
+	json.StartArray("extr");
+	for (size_t extruder = 0; extruder < 2; extruder++)
+	{
+		json.Float(nullptr, extruderPositions[extruder], 1);
+	}
+	json.EndArray();
+	json.StartArray("xyz");
+	for (size_t axis = 0; axis < AXES; axis++)
+	{
+		json.Float(nullptr, coords[axis], 2);
+	}
+	json.EndArray();
+	json.EndObject();
+	json.Int("currentTool", 0);
+	json.StartObject("params");
+	json.Int("atxPower", 0);
+	json.StartArray("fanPercent");
+	for (size_t fan = 0; fan < 3; fan++)
+	{
+		json.Float(nullptr, fanValues[fan] * 100.0, 2);
+	}
+	json.EndArray();
+	json.Float("speedFactor", 100.0, 2);
+	json.StartArray("extrFactors");
+	for (size_t extruder = 0; extruder < 2; extruder++)
+	{
+		json.Float(nullptr, 100.0, 2);
+	}
+	json.EndArray();
+	json.EndObject();
+	json.Int("seq", 12);
+	json.StartObject("sensors");
+	json.Int("probeValue", 0);
+	json.UInt("fanRPM", 0);
+	json.EndObject();
+	json.StartObject("temps");
+	json.StartObject("bed");
+	json.Float("current", temperatures[0], 1);
+	json.Float("active", activeTemperatures[0], 1);
+	json.Int("state", 2);
+	json.EndObject();
+	json.StartObject("heads");
+	json.StartArray("current");
+	for (size_t heater = 1; heater < 3; heater++)
+	{
+		json.Float(nullptr, temperatures[heater], 1);
+	}
+	json.EndArray();
+	json.StartArray("active");
+	for (size_t heater = 1; heater < 3; heater++)
+	{
+		json.Float(nullptr, activeTemperatures[heater], 1);
+	}
+	json.EndArray();
+	json.StartArray("standby");
+	for (size_t heater = 1; heater < 3; heater++)
+	{
+		json.Float(nullptr, standbyTemperatures[heater], 1);
+	}
+	json.EndArray();
+	json.StartArray("state");
+	for (size_t heater = 1; heater < 3; heater++)
+	{
+		json.Int(nullptr, 2);
+	}
+	json.EndArray();
+	json.EndObject();
+	json.EndObject();
+	json.Float("time", 12345.67, 1);
+	json.Float("coldExtrudeTemp", 160.0, 0);
+	json.Float("coldRetractTemp", 90.0, 0);
+	json.UInt("endstops", 0);
+	json.String("geometry", geometry);
+	json.String("name", machineName, 40);
+	json.StartObject("probe");
+	json.Int("threshold", 500);
+	json.Float("height", 0.7, 2);
+	json.Int("type", 1);
+	json.EndObject();
+	json.StartArray("tools");
+	json.StartObject();
+	json.Int("number", 0);
+	json.StartArray("heaters");
+	json.Int(nullptr, 1);
+	json.EndArray();
+	json.StartArray("drives");
+	json.Int(nullptr, 0);
+	json.EndArray();
+	json.EndObject();
+	json.EndArray();
+	json.EndObject();
+	return response;
+}
+
+static OutputBuffer *EmptyResponse()
+{
+	OutputBuffer *response;
+	return (OutputBuffer::Allocate(response)) ? response : nullptr;
+}
+
+static std::string Text(OutputBuffer *buf)
+{
+	std::string text;
+	for (OutputBuffer *b = buf; b != nullptr; b = b->Next())
+	{
+		text.append(b->Data(), b->DataLength());
+	}
+	return text;
+}
+
+typedef OutputBuffer *(*ResponseBuilder)();
+
+static void *BuildAndRelease(void *builder)
+{
+	OutputBuffer::ReleaseAll(((ResponseBuilder)builder)());
+	return nullptr;
+}
+
+// Run the builder on a thread with a stack filled with a pattern and return how much of the stack it overwrote
+static size_t StackUsed(ResponseBuilder builder)
+{
+	uint8_t * const stack = (uint8_t *)aligned_alloc(4096, ThreadStackSize);
+	memset(stack, 0xA5, ThreadStackSize);
+	pthread_attr_t attr;
+	pthread_attr_init(&attr);
+	pthread_attr_setstack(&attr, stack, ThreadStackSize);
+	pthread_t thread;
+	pthread_create(&thread, &attr, BuildAndRelease, (void *)builder);
+	pthread_join(thread, nullptr);
+	pthread_attr_destroy(&attr);
+
+	size_t untouched = 0;
+	while (untouched < ThreadStackSize && stack[untouched] == 0xA5)
+	{
+		untouched++;
+	}
+	free(stack);
+	return ThreadStackSize - untouched;
+}
+
+static void Benchmark(const char *name, ResponseBuilder builder)
+{
+	size_t bytes = 0;
+	const double start = Now();
+	for (unsigned int i = 0; i < Iterations; i++)
+	{
+		OutputBuffer * const response = builder();
+		bytes += response->Length();
+		OutputBuffer::ReleaseAll(response);
+	}
+	const double elapsed = Now() - start;
+
+	// Subtract what the thread itself and the allocation of the first buffer need
+	const size_t stack = StackUsed(builder) - StackUsed(EmptyResponse);
+	printf("%-12s %6.2f us/response %7.1f MB/s, %5u bytes of stack\n", name, elapsed * 1.0e6 / Iterations, bytes / elapsed / 1.0e6, (unsigned int)stack);
+}
+
+static void TestStatusResponse()
+{
+	OutputBuffer * const catfResponse = CatfResponse();
+	OutputBuffer * const jsonResponse = JsonWriterResponse();
+	const std::string catfText = Text(catfResponse), jsonText = Text(jsonResponse);
+	OutputBuffer::ReleaseAll(catfResponse);
+	OutputBuffer::ReleaseAll(jsonResponse);
+
+	Check(!catfText.empty() && catfText == jsonText, "JsonWriter writes the status response byte for byte like catf");
+	if (catfText != jsonText)
+	{
+		printf("  catf:       %s\n  JsonWriter: %s\n", catfText.c_str(), jsonText.c_str());
+	}
+}
+
+// Compare one value with snprintf. We print -0.0 and anything that rounds to it without the sign.
+static bool SameAsPrintf(float value, uint8_t decimals, unsigned int& reported)
+{
+	char expected[JsonWriter::maxNumberLength], actual[JsonWriter::maxNumberLength];
+	snprintf(expected, sizeof(expected), "%.*f", decimals, (double)value);
+	actual[JsonWriter::FormatFloat(actual, value, decimals)] = 0;
+	if (strcmp(expected, actual) == 0 || (expected[0] == '-' && strspn(expected + 1, "0.") == strlen(expected + 1) && strcmp(expected + 1, actual) == 0))
+	{
+		return true;
+	}
+	if (reported++ < 5)
+	{
+		printf("  %.9g with %u decimals: %%f gives %s, FormatFloat %s\n", (double)value, decimals, expected, actual);
+	}
+	return false;
+}
+
+static void TestFormatFloat()
+{
+	unsigned int values = 0, mismatches = 0, reported = 0;
+
+	// Floats spread over the range of temperatures and positions, with every precision we use
+	for (float value = -2000.0; value < 2000.0; value += 0.0137)
+	{
+		for (uint8_t decimals = 0; decimals <= 4; decimals++)
+		{
+			++values;
+			mismatches += (SameAsPrintf(value, decimals, reported)) ? 0 : 1;
+		}
+	}
+
+	// Multiples of 1/64 are exact ties at some precisions, which %f rounds to even
+	for (int i = -64000; i <= 64000; i++)
+	{
+		for (uint8_t decimals = 0; decimals <= JsonWriter::maxDecimals; decimals++)
+		{
+			++values;
+			mismatches += (SameAsPrintf(i / 64.0, decimals, reported)) ? 0 : 1;
+		}
+	}
+
+	// Values too big for the fast path, and the ones that aren't numbers
+	const float others[] = { 4294967295.0, 1.0e10, -3.4e38, 1.0e-7, -1.0e-7, NAN, INFINITY, -INFINITY };
+	for (float value : others)
+	{
+		for (uint8_t decimals = 0; decimals <= JsonWriter::maxDecimals; decimals++)
+		{
+			++values;
+			mismatches += (SameAsPrintf(value, decimals, reported)) ? 0 : 1;
+		}
+	}
+
+	printf("FormatFloat: %u mismatches with %%f in %u values\n", mismatches, values);
+	Check(mismatches == 0, "FormatFloat gives the same digits as %f");
+}
+
+int main()
+{
+	setvbuf(stdout, nullptr, _IOLBF, 0);
+	OutputBuffer::Init();
+
+	TestStatusResponse();
+	Benchmark("catf", CatfResponse);
+	Benchmark("JsonWriter", JsonWriterResponse);
+	TestFormatFloat();
+
+	printf((hostFailures == 0) ? "All JSON tests passed\n" : "%d JSON tests failed\n", hostFailures);
+	return (hostFailures == 0) ? 0 : 1;
+}
+
+// End
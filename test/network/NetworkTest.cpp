@@ -0,0 +1,535 @@
+/*
+ * NetworkTest.cpp
+ *
+ * Host test of Network, Webserver and lwIP. The firmware's network code runs on an in-memory netif (ethernet_host.c)
+ * with its file system on a FAT image (diskio_host.c), and TestClient drives it with scripted HTTP, FTP and Telnet
+ * sessions. The test checks the replies and reports requests per second, upload and download rates, latencies and
+ * how often the firmware ran out of network transactions or pbufs.
+ *
+ * The rates are those of the host, not of a Duet, so they are only useful for comparing two builds with each other.
+ * The counters (frames, retransmissions, transaction and pbuf exhaustion) don't depend on the speed of the host.
+ *
+ * Usage: networktest [image file]		(the image is created, by default in the current directory)
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "RepRapFirmware.h"
+#include "diskio_host.h"
+#include "ethernet_host.h"
+#include "lwip/pbuf.h"
+#include "FirmwareHost.h"
+#include "HostTest.h"
+#include "TestClient.h"
+
+const uint8_t ClientIp[4] = { 192, 168, 1, 2 };
+const uint32_t Timeout = 5000;					// milliseconds
+
+// Latencies of one test in milliseconds
+class Latencies
+{
+public:
+	void Add(double seconds) { values.push_back(seconds * 1000.0); }
+	size_t Count() const { return values.size(); }
+
+	void Print(const char *name, double elapsed)
+	{
+		std::sort(values.begin(), values.end());
+		printf("%-32s %6u in %6.3f s = %8.1f/s, latency ms: p50 %.2f, p95 %.2f, max %.2f\n", name, (unsigned int)values.size(),
+				elapsed, values.size() / elapsed, Percentile(0.5), Percentile(0.95), (values.empty()) ? 0.0 : values.back());
+	}
+
+private:
+	double Percentile(double p) const
+	{
+		return (values.empty()) ? 0.0 : values[std::min(values.size() - 1, (size_t)(p * values.size()))];
+	}
+
+	std::vector<double> values;
+};
+
+//*************************************************************************************************
+// HTTP
+
+static size_t HttpResponseLength(const std::string& response)
+{
+	const size_t headerEnd = response.find("\n\n");
+	const size_t contentLength = response.find("Content-Length: ");
+	if (headerEnd == std::string::npos || contentLength == std::string::npos || contentLength > headerEnd)
+	{
+		return 0;
+	}
+	return headerEnd + 2 + strtoul(response.c_str() + contentLength + 16, nullptr, 10);
+}
+
+// Wait for our FIN to be acknowledged, then forget the connection
+static void CloseConnection(TestClient& client, int conn)
+{
+	client.Close(conn);
+	client.RunUntil([&]() { return client.AllSent(conn) || client.WasReset(conn); }, Timeout);
+	client.Release(conn);
+}
+
+// Send a request on a new connection and return what came back before the firmware closed it.
+// If split isn't zero, the request reaches the firmware in one pbuf chain with the split between the two pbufs.
+static std::string HttpRequest(TestClient& client, const std::string& request, size_t split = 0)
+{
+	const int conn = client.Connect(80);
+	std::string response;
+	if (client.WaitForEstablished(conn, Timeout))
+	{
+		if (split != 0)
+		{
+			client.WriteOutOfOrder(conn, request, split);
+		}
+		else
+		{
+			client.Write(conn, request);
+		}
+		client.WaitForFinished(conn, Timeout);
+		response = client.Received(conn);
+	}
+	CloseConnection(client, conn);
+	return response;
+}
+
+static std::string StatusRequest(bool keepAlive)
+{
+	return std::string("GET /rr_status?type=1 HTTP/1.1\r\nHost: duet\r\nConnection: ") + ((keepAlive) ? "keep-alive" : "close") + "\r\n\r\n";
+}
+
+// One request per connection, the way the web interface polls
+static void TestStatusRequests(TestClient& client, size_t count)
+{
+	Latencies latencies;
+	size_t good = 0;
+	const double start = Now();
+	for (size_t i = 0; i < count; i++)
+	{
+		const double requestStart = Now();
+		const std::string response = HttpRequest(client, StatusRequest(false));
+		latencies.Add(Now() - requestStart);
+		if (response.compare(0, 15, "HTTP/1.1 200 OK") == 0 && HttpResponseLength(response) == response.size() && response.back() == '}')
+		{
+			++good;
+		}
+	}
+	latencies.Print("rr_status, new connections", Now() - start);
+	Check(good == count, "rr_status on new connections");
+}
+
+// G-Codes sent with rr_gcode, each one must reach the G-Code buffer of the Webserver
+static void TestGCodeRequests(TestClient& client, size_t count)
+{
+	Latencies latencies;
+	size_t good = 0;
+	const uint32_t gcodesRun = hostCounters.gcodesRun;
+	const double start = Now();
+	for (size_t i = 0; i < count; i++)
+	{
+		const double requestStart = Now();
+		const std::string response = HttpRequest(client, "GET /rr_gcode?gcode=G1%20X10%20Y20%20F3000 HTTP/1.1\r\nHost: duet\r\n\r\n");
+		latencies.Add(Now() - requestStart);
+		if (response.find("{\"buff\":") != std::string::npos)
+		{
+			++good;
+		}
+	}
+	latencies.Print("rr_gcode", Now() - start);
+	Check(good == count && hostCounters.gcodesRun - gcodesRun == count, "rr_gcode");
+}
+
+// A request split over two pbufs at every position, including next to each delimiter and inside each %xx escape.
+// The G-Code must arrive decoded and without a stray byte from the pbuf boundary.
+static void TestSplitRequests(TestClient& client)
+{
+	const std::string request = "GET /rr_gcode?gcode=G1%20X10%20Y20%20F3000 HTTP/1.1\r\nHost: duet\r\n\r\n";
+	size_t good = 0;
+	for (size_t split = 1; split < request.size(); split++)
+	{
+		hostLastGCode.clear();
+		const std::string response = HttpRequest(client, request, split);
+		if (response.find("{\"buff\":") != std::string::npos && hostLastGCode == "G1 X10 Y20 F3000")
+		{
+			++good;
+		}
+		else if (hostVerbose)
+		{
+			printf("  split at %u: G-Code \"%s\"\n", (unsigned int)split, hostLastGCode.c_str());
+		}
+	}
+	Check(good == request.size() - 1, "rr_gcode split over two pbufs");
+}
+
+// The HTTP interpreter is protected in Webserver. This one stops when the request runs out instead of rejecting it,
+// so that it can parse an incomplete request over and over without a connection behind the transaction.
+class ParserBenchmark : public Webserver
+{
+public:
+	class Interpreter : public HttpInterpreter
+	{
+	public:
+		Interpreter() : HttpInterpreter(reprap.GetPlatform(), reprap.GetWebserver(), reprap.GetNetwork()), ranOut(false) { }
+		void NoMoreDataAvailable() override { ranOut = true; }
+		bool ranOut;
+	};
+};
+
+// Parse a browser's rr_status request split over two pbufs, one character at a time through CharFromClient the way
+// Webserver::Spin used to, and in spans with ParseRequest. The request has no blank line at the end, so only the
+// parsing is timed. TestSplitRequests checks that the two arrive at the same request.
+static void TestParserSpeed(size_t count)
+{
+	static const char * const request =
+		"GET /rr_status?type=3&since=1234 HTTP/1.1\r\n"
+		"Host: 192.168.1.14\r\n"
+		"Connection: keep-alive\r\n"
+		"Accept: application/json, text/javascript, */*; q=0.01\r\n"
+		"X-Requested-With: XMLHttpRequest\r\n"
+		"User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/51.0.2704.79 Safari/537.36\r\n"
+		"Referer: http://192.168.1.14/reprap.htm\r\n"
+		"Accept-Encoding: gzip, deflate, sdch\r\n"
+		"Accept-Language: en-GB,en-US;q=0.8,en;q=0.6\r\n"
+		"If-None-Match: \"0001a2b3c4d5e6f7z\"\r\n";
+	const size_t length = strlen(request), split = 200;
+	pbuf first, second;
+	memset(&first, 0, sizeof(first));
+	memset(&second, 0, sizeof(second));
+	first.payload = (void *)request;
+	first.len = first.tot_len = split;
+	first.next = &second;
+	second.payload = (void *)(request + split);
+	second.len = second.tot_len = length - split;
+
+	static NetworkTransaction transaction(nullptr);
+	ParserBenchmark::Interpreter interpreter;
+	const uint32_t messages = hostCounters.messages;
+	double elapsed[2];
+	size_t complete[2] = { 0, 0 };
+	for (size_t method = 0; method < 2; method++)
+	{
+		const double start = Now();
+		for (size_t i = 0; i < count; i++)
+		{
+			interpreter.ResetState();
+			interpreter.ranOut = false;
+			transaction.Set(&first, nullptr, receiving);
+			if (method == 0)
+			{
+				char c;
+				while (transaction.Read(c) && !interpreter.CharFromClient(c)) { }
+				if (!transaction.HasMoreDataToRead())
+				{
+					interpreter.NoMoreDataAvailable();
+				}
+			}
+			else
+			{
+				while (!interpreter.ParseRequest(&transaction)) { }
+			}
+			if (interpreter.ranOut)
+			{
+				++complete[method];
+			}
+		}
+		elapsed[method] = Now() - start;
+	}
+	printf("%-32s %6.3f us/request = %6.1f MB/s\n", "HTTP parser, byte by byte", elapsed[0] * 1.0e6 / count, length * count / elapsed[0] / 1.0e6);
+	printf("%-32s %6.3f us/request = %6.1f MB/s\n", "HTTP parser, spans", elapsed[1] * 1.0e6 / count, length * count / elapsed[1] / 1.0e6);
+	Check(complete[0] == count && complete[1] == count && hostCounters.messages == messages, "HTTP parser benchmark");
+}
+
+// Several clients polling at once, each with its own connections
+static void TestConcurrentRequests(TestClient& client, size_t clients, size_t requestsPerClient)
+{
+	struct Poller
+	{
+		int conn;
+		size_t done;
+		double requestStart;
+		enum { idle, waiting, closing } state;
+	};
+
+	std::vector<Poller> pollers(clients, Poller{ -1, 0, 0.0, Poller::idle });
+	Latencies latencies;
+	size_t good = 0;
+	const uint32_t noFreeTransactions = hostCounters.noFreeTransactions;
+	const uint32_t resets = client.GetStats().resets;
+	const double start = Now();
+
+	client.RunUntil([&]() {
+		bool allDone = true;
+		for (Poller& p : pollers)
+		{
+			switch (p.state)
+			{
+			case Poller::idle:
+				if (p.done < requestsPerClient)
+				{
+					p.conn = client.Connect(80);
+					client.Write(p.conn, StatusRequest(false));
+					p.requestStart = Now();
+					p.state = Poller::waiting;
+				}
+				break;
+
+			case Poller::waiting:
+				if (client.IsFinished(p.conn))
+				{
+					latencies.Add(Now() - p.requestStart);
+					const std::string& response = client.Received(p.conn);
+					if (response.compare(0, 15, "HTTP/1.1 200 OK") == 0 && HttpResponseLength(response) == response.size())
+					{
+						++good;
+					}
+					client.Close(p.conn);
+					p.state = Poller::closing;
+				}
+				break;
+
+			case Poller::closing:
+				if (client.AllSent(p.conn) || client.WasReset(p.conn))
+				{
+					client.Release(p.conn);
+					++p.done;
+					p.state = Poller::idle;
+				}
+				break;
+			}
+			allDone = allDone && p.done == requestsPerClient;
+		}
+		return allDone;
+	}, Timeout * 4);
+
+	char name[40];
+	snprintf(name, ARRAY_SIZE(name), "rr_status, %u clients", (unsigned int)clients);
+	latencies.Print(name, Now() - start);
+	printf("%-32s %u times without a free transaction, %u connections reset\n", "", hostCounters.noFreeTransactions - noFreeTransactions,
+			client.GetStats().resets - resets);
+	Check(good == clients * requestsPerClient, "concurrent rr_status requests");
+}
+
+static void MakeData(std::string& data, size_t length)
+{
+	data.resize(length);
+	uint32_t x = 12345;
+	for (char& c : data)
+	{
+		x = x * 1103515245 + 12345;
+		c = (char)(x >> 16);
+	}
+}
+
+// Upload a file with rr_upload, then download it again as a web file
+static void TestUploadAndDownload(TestClient& client, size_t length)
+{
+	std::string data;
+	MakeData(data, length);
+	CRC32 crc;
+	crc.Update(data.data(), data.size());
+
+	char request[200];
+	snprintf(request, ARRAY_SIZE(request), "POST /rr_upload?name=0:/www/upload.bin&crc32=%08x HTTP/1.1\r\nHost: duet\r\nContent-Length: %u\r\n\r\n",
+			(unsigned int)crc.Get(), (unsigned int)length);
+
+	double start = Now();
+	std::string response = HttpRequest(client, std::string(request) + data);
+	double elapsed = Now() - start;
+	printf("%-32s %6u KB in %6.3f s = %6.2f MB/s\n", "rr_upload", (unsigned int)(length / 1024), elapsed, length / elapsed / 1.0e6);
+	Check(response.find("{\"err\":0}") != std::string::npos, "rr_upload");
+
+	start = Now();
+	response = HttpRequest(client, "GET /upload.bin HTTP/1.1\r\nHost: duet\r\n\r\n");
+	elapsed = Now() - start;
+	printf("%-32s %6u KB in %6.3f s = %6.2f MB/s\n", "GET of the uploaded file", (unsigned int)(length / 1024), elapsed, length / elapsed / 1.0e6);
+	const size_t headerEnd = response.find("\n\n");
+	Check(headerEnd != std::string::npos && response.compare(headerEnd + 2, std::string::npos, data) == 0, "download of the uploaded file");
+}
+
+//*************************************************************************************************
+// FTP
+
+// Wait for a reply line with the given code and remove it from the received data
+static bool FtpReply(TestClient& client, int conn, const char *code)
+{
+	std::string& received = client.Received(conn);
+	const bool ok = client.RunUntil([&]() { return received.find("\r\n") != std::string::npos || client.IsFinished(conn); }, Timeout)
+						&& received.compare(0, strlen(code), code) == 0;
+	const size_t lineEnd = received.find("\r\n");
+	received.erase(0, (lineEnd == std::string::npos) ? lineEnd : lineEnd + 2);
+	return ok;
+}
+
+static int FtpPassive(TestClient& client, int control)
+{
+	client.Write(control, "PASV\r\n");
+	std::string& received = client.Received(control);
+	if (!client.RunUntil([&]() { return received.find("\r\n") != std::string::npos; }, Timeout))
+	{
+		return -1;
+	}
+	unsigned int a, b, c, d, p1, p2;
+	const size_t bracket = received.find('(');
+	const bool ok = received.compare(0, 3, "227") == 0 && bracket != std::string::npos
+					&& sscanf(received.c_str() + bracket, "(%u,%u,%u,%u,%u,%u)", &a, &b, &c, &d, &p1, &p2) == 6;
+	received.erase(0, received.find("\r\n") + 2);
+	if (!ok)
+	{
+		return -1;
+	}
+	const int data = client.Connect(p1 * 256 + p2);
+	return (client.WaitForEstablished(data, Timeout)) ? data : -1;
+}
+
+static void TestFtp(TestClient& client, size_t length)
+{
+	const int control = client.Connect(21);
+	Check(client.WaitForEstablished(control, Timeout) && FtpReply(client, control, "220"), "FTP connection");
+	client.Write(control, "USER anonymous\r\n");
+	Check(FtpReply(client, control, "331"), "FTP USER");
+	client.Write(control, "PASS " DEFAULT_PASSWORD "\r\n");
+	Check(FtpReply(client, control, "230"), "FTP PASS");
+
+	// Upload
+	std::string data;
+	MakeData(data, length);
+	int dataConn = FtpPassive(client, control);
+	Check(dataConn >= 0, "FTP PASV for STOR");
+	if (dataConn >= 0)
+	{
+		const double start = Now();
+		client.Write(control, "STOR ftp.bin\r\n");
+		Check(FtpReply(client, control, "150"), "FTP STOR");
+		client.Write(dataConn, data);
+		CloseConnection(client, dataConn);
+		Check(FtpReply(client, control, "226"), "FTP STOR transfer");
+		const double elapsed = Now() - start;
+		printf("%-32s %6u KB in %6.3f s = %6.2f MB/s\n", "FTP STOR", (unsigned int)(length / 1024), elapsed, length / elapsed / 1.0e6);
+	}
+
+	// Listing
+	dataConn = FtpPassive(client, control);
+	Check(dataConn >= 0, "FTP PASV for LIST");
+	if (dataConn >= 0)
+	{
+		client.Write(control, "LIST\r\n");
+		Check(FtpReply(client, control, "150"), "FTP LIST");
+		client.WaitForFinished(dataConn, Timeout);
+		Check(client.Received(dataConn).find("ftp.bin") != std::string::npos, "FTP listing of the uploaded file");
+		CloseConnection(client, dataConn);
+		Check(FtpReply(client, control, "226"), "FTP LIST transfer");
+	}
+
+	client.Write(control, "QUIT\r\n");
+	Check(FtpReply(client, control, "221"), "FTP QUIT");
+	client.WaitForFinished(control, Timeout);
+	CloseConnection(client, control);
+}
+
+//*************************************************************************************************
+// Telnet
+
+static void TestTelnet(TestClient& client, int conn, uint32_t connectTime, size_t lines)
+{
+	// The first packet within telnetSetupDuration of connecting is taken for Telnet negotiation and discarded
+	client.RunUntil([&]() { return millis() - connectTime > telnetSetupDuration; }, telnetSetupDuration + 1000);
+
+	Latencies latencies;
+	size_t good = 0;
+	const uint32_t gcodesRun = hostCounters.gcodesRun;
+	std::string& received = client.Received(conn);
+	const double start = Now();
+	for (size_t i = 0; i < lines; i++)
+	{
+		const double lineStart = Now();
+		client.Write(conn, "G1 X10 Y20 F3000\n");
+		if (client.RunUntil([&]() { return received.find("ok\r\n") != std::string::npos || client.IsFinished(conn); }, Timeout)
+			&& received.find("ok\r\n") != std::string::npos)
+		{
+			++good;
+		}
+		latencies.Add(Now() - lineStart);
+		received.clear();
+	}
+	latencies.Print("Telnet G-Code lines", Now() - start);
+	Check(good == lines && hostCounters.gcodesRun - gcodesRun == lines, "Telnet G-Codes");
+
+	// Telnet reads a character at a time, so a line split over two pbufs tests NetworkTransaction::Read at the boundary
+	const std::string line = "G1 X10 Y20 F3000\n";
+	good = 0;
+	for (size_t split = 1; split < line.size(); split++)
+	{
+		hostLastGCode.clear();
+		client.WriteOutOfOrder(conn, line, split);
+		if (client.RunUntil([&]() { return received.find("ok\r\n") != std::string::npos || client.IsFinished(conn); }, Timeout)
+			&& hostLastGCode == "G1 X10 Y20 F3000")
+		{
+			++good;
+		}
+		received.clear();
+	}
+	Check(good == line.size() - 1, "Telnet G-Codes split over two pbufs");
+
+	client.Write(conn, "quit\n");
+	Check(client.WaitForText(conn, "Goodbye.", Timeout), "Telnet quit");
+	client.WaitForFinished(conn, Timeout);
+	CloseConnection(client, conn);
+}
+
+//*************************************************************************************************
+
+int main(int argc, char **argv)
+{
+	setvbuf(stdout, nullptr, _IOLBF, 0);
+	const char * const imageFile = (argc > 1) ? argv[1] : "card.img";
+	if (!StartFirmware(imageFile))
+	{
+		return 2;
+	}
+
+	TestClient client(ClientIp, reprap.GetPlatform()->IPAddress(), []() { reprap.Spin(); });
+	if (!client.Resolve(Timeout))
+	{
+		printf("FAILED: the firmware doesn't answer ARP requests\n");
+		return 1;
+	}
+
+	// Open the Telnet session first, so that its setup time is over by the time the other tests have finished
+	const int telnet = client.Connect(23);
+	Check(client.WaitForEstablished(telnet, Timeout), "Telnet connection");
+	const uint32_t telnetConnectTime = millis();
+
+	Check(HttpRequest(client, "GET /rr_connect?password=" DEFAULT_PASSWORD " HTTP/1.1\r\nHost: duet\r\n\r\n").find("{\"err\":0}") != std::string::npos, "rr_connect");
+
+	TestStatusRequests(client, 500);
+	TestGCodeRequests(client, 500);
+	TestSplitRequests(client);
+	TestParserSpeed(200000);
+	TestConcurrentRequests(client, 4, 100);
+	TestConcurrentRequests(client, 12, 50);
+	TestUploadAndDownload(client, 1024 * 1024);
+	TestFtp(client, 256 * 1024);
+	TestTelnet(client, telnet, telnetConnectTime, 200);
+
+	const TestClient::Stats& clientStats = client.GetStats();
+	EthernetHostStats linkStats;
+	ethernet_host_get_stats(&linkStats, 0);
+	printf("Frames to firmware %u, from firmware %u, retransmissions %u, dropped without a pbuf %u, without a receive buffer %u\n",
+			linkStats.framesIn, linkStats.framesOut, clientStats.retransmissions, linkStats.rxNoPbuf, linkStats.rxOverruns);
+	printf("Times without a free transaction: %u\n", hostCounters.noFreeTransactions);
+
+	hostVerbose = true;
+	reprap.GetNetwork()->Diagnostics();
+	hostVerbose = false;
+
+	disk_host_close();
+	printf((hostFailures == 0) ? "All network tests passed\n" : "%d network tests failed\n", hostFailures);
+	return (hostFailures == 0) ? 0 : 1;
+}
+
+// End
@@ -0,0 +1,511 @@
+/*
+ * TestClient.cpp
+ *
+ * See TestClient.h
+ */
+
+#include "TestClient.h"
+
+#include <cstring>
+
+#include "Arduino.h"
+#include "ethernet_host.h"
+
+const uint16_t MSS = 1460;
+const uint16_t ReceiveWindow = 65535;				// we consume everything as soon as it arrives
+const uint32_t RetransmitTimeout = 500;				// milliseconds without progress before we send unacknowledged data again
+
+const uint8_t TCP_FIN = 0x01, TCP_SYN = 0x02, TCP_RST = 0x04, TCP_PSH = 0x08, TCP_ACK = 0x10;
+
+static inline void Put16(uint8_t *p, uint16_t v) { p[0] = v >> 8; p[1] = v & 0xFF; }
+static inline void Put32(uint8_t *p, uint32_t v) { Put16(p, v >> 16); Put16(p + 2, v & 0xFFFF); }
+static inline uint16_t Get16(const uint8_t *p) { return (p[0] << 8) | p[1]; }
+static inline uint32_t Get32(const uint8_t *p) { return ((uint32_t)Get16(p) << 16) | Get16(p + 2); }
+
+// Sequence number comparison that copes with wrap-around
+static inline bool SeqBefore(uint32_t a, uint32_t b) { return (int32_t)(a - b) < 0; }
+
+TestClient::TestClient(const uint8_t ip[4], const uint8_t serverIp[4], std::function<void()> spinFunction)
+	: spin(spinFunction), serverMacKnown(false), nextPort(49152), nextIpId(1)
+{
+	memcpy(ipAddress, ip, 4);
+	memcpy(serverIpAddress, serverIp, 4);
+	static const uint8_t mac[6] = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x02 };
+	memcpy(macAddress, mac, sizeof(mac));
+	memset(serverMacAddress, 0xFF, sizeof(serverMacAddress));
+	memset(&stats, 0, sizeof(stats));
+}
+
+uint16_t TestClient::Checksum(const uint8_t *data, size_t length, uint32_t sum)
+{
+	for (size_t i = 0; i + 1 < length; i += 2)
+	{
+		sum += Get16(data + i);
+	}
+	if (length & 1)
+	{
+		sum += data[length - 1] << 8;
+	}
+	while (sum >> 16)
+	{
+		sum = (sum & 0xFFFF) + (sum >> 16);
+	}
+	return ~sum & 0xFFFF;
+}
+
+void TestClient::SendFrame(const uint8_t *frame, size_t length)
+{
+	if (ethernet_host_send(frame, length) == 0)
+	{
+		++stats.framesSent;
+	}
+	else
+	{
+		++stats.framesDropped;
+	}
+}
+
+bool TestClient::Resolve(uint32_t timeout)
+{
+	uint8_t frame[42];
+	memset(frame, 0xFF, 6);
+	memcpy(frame + 6, macAddress, 6);
+	Put16(frame + 12, 0x0806);
+	Put16(frame + 14, 1);							// Ethernet
+	Put16(frame + 16, 0x0800);						// IPv4
+	frame[18] = 6;
+	frame[19] = 4;
+	Put16(frame + 20, 1);							// request
+	memcpy(frame + 22, macAddress, 6);
+	memcpy(frame + 28, ipAddress, 4);
+	memset(frame + 32, 0, 6);
+	memcpy(frame + 38, serverIpAddress, 4);
+	SendFrame(frame, sizeof(frame));
+	return RunUntil([this]() { return serverMacKnown; }, timeout);
+}
+
+void TestClient::HandleArp(const uint8_t *frame, size_t length)
+{
+	if (length < 42 || Get16(frame + 16) != 0x0800)
+	{
+		return;
+	}
+
+	const uint16_t op = Get16(frame + 20);
+	if (memcmp(frame + 28, serverIpAddress, 4) == 0)
+	{
+		memcpy(serverMacAddress, frame + 22, 6);
+		serverMacKnown = true;
+	}
+
+	if (op == 1 && memcmp(frame + 38, ipAddress, 4) == 0)
+	{
+		uint8_t reply[42];
+		memcpy(reply, frame + 6, 6);
+		memcpy(reply + 6, macAddress, 6);
+		memcpy(reply + 12, frame + 12, 8);
+		Put16(reply + 20, 2);
+		memcpy(reply + 22, macAddress, 6);
+		memcpy(reply + 28, ipAddress, 4);
+		memcpy(reply + 32, frame + 22, 10);
+		SendFrame(reply, sizeof(reply));
+	}
+}
+
+int TestClient::Connect(uint16_t port)
+{
+	Connection c;
+	c.inUse = true;
+	c.state = State::synSent;
+	c.localPort = nextPort++;
+	if (nextPort == 0)
+	{
+		nextPort = 49152;
+	}
+	c.remotePort = port;
+	c.sndUna = c.sndNxt = (uint32_t)random();
+	c.rcvNxt = 0;
+	c.peerWindow = 0;
+	c.closeRequested = c.finSent = c.finReceived = c.wasReset = false;
+	c.lastProgress = millis();
+
+	size_t handle = 0;
+	while (handle < connections.size() && connections[handle].inUse)
+	{
+		++handle;
+	}
+	if (handle == connections.size())
+	{
+		connections.push_back(c);
+	}
+	else
+	{
+		connections[handle] = c;
+	}
+
+	Connection& conn = connections[handle];
+	SendSegment(conn, conn.sndNxt, TCP_SYN, nullptr, 0, true);
+	++conn.sndNxt;
+	return (int)handle;
+}
+
+void TestClient::Write(int conn, const std::string& data)
+{
+	Connection& c = connections[conn];
+	c.sendBuffer += data;
+	Transmit(c);
+}
+
+// Send the data as two segments, the second one first. lwIP keeps the second one in its out-of-order queue until the first
+// one arrives and then passes both up in one pbuf chain. Both segments must fit in the peer's window and in an MSS each.
+void TestClient::WriteOutOfOrder(int conn, const std::string& data, size_t split)
+{
+	Connection& c = connections[conn];
+	if (c.state != State::established || !c.sendBuffer.empty() || data.size() > c.peerWindow || split > MSS || data.size() - split > MSS)
+	{
+		Write(conn, data);
+		return;
+	}
+
+	c.sendBuffer = data;
+	SendSegment(c, c.sndNxt + split, TCP_PSH, data.data() + split, data.size() - split);
+	SendSegment(c, c.sndNxt, TCP_PSH, data.data(), split);
+	c.sndNxt += data.size();
+	c.lastProgress = millis();
+}
+
+void TestClient::Close(int conn)
+{
+	Connection& c = connections[conn];
+	c.closeRequested = true;
+	Transmit(c);
+}
+
+void TestClient::Release(int conn)
+{
+	Connection& c = connections[conn];
+	if (c.state != State::closed)
+	{
+		SendRst(c.localPort, c.remotePort, c.sndNxt);
+	}
+	c.inUse = false;
+	c.sendBuffer.clear();
+	c.received.clear();
+}
+
+bool TestClient::IsEstablished(int conn) const
+{
+	return connections[conn].state == State::established;
+}
+
+bool TestClient::IsFinished(int conn) const
+{
+	const Connection& c = connections[conn];
+	return c.finReceived || c.wasReset;
+}
+
+bool TestClient::AllSent(int conn) const
+{
+	const Connection& c = connections[conn];
+	return c.state != State::synSent && c.sndUna == c.sndNxt && c.sendBuffer.empty();
+}
+
+bool TestClient::WasReset(int conn) const
+{
+	return connections[conn].wasReset;
+}
+
+std::string& TestClient::Received(int conn)
+{
+	return connections[conn].received;
+}
+
+TestClient::Connection *TestClient::Find(uint16_t localPort, uint16_t remotePort)
+{
+	for (Connection& c : connections)
+	{
+		if (c.inUse && c.localPort == localPort && c.remotePort == remotePort)
+		{
+			return &c;
+		}
+	}
+	return nullptr;
+}
+
+void TestClient::SendSegment(Connection& c, uint32_t seq, uint8_t flags, const char *data, size_t length, bool withMss)
+{
+	const size_t tcpHeaderLength = (withMss) ? 24 : 20;
+	const size_t ipLength = 20 + tcpHeaderLength + length;
+	uint8_t frame[14 + 20 + 24 + MSS];
+
+	memcpy(frame, serverMacAddress, 6);
+	memcpy(frame + 6, macAddress, 6);
+	Put16(frame + 12, 0x0800);
+
+	uint8_t * const ip = frame + 14;
+	ip[0] = 0x45;
+	ip[1] = 0;
+	Put16(ip + 2, ipLength);
+	Put16(ip + 4, nextIpId++);
+	Put16(ip + 6, 0x4000);							// don't fragment
+	ip[8] = 64;
+	ip[9] = 6;
+	Put16(ip + 10, 0);
+	memcpy(ip + 12, ipAddress, 4);
+	memcpy(ip + 16, serverIpAddress, 4);
+	Put16(ip + 10, Checksum(ip, 20));
+
+	uint8_t * const tcp = ip + 20;
+	Put16(tcp, c.localPort);
+	Put16(tcp + 2, c.remotePort);
+	Put32(tcp + 4, seq);
+	Put32(tcp + 8, (flags & TCP_SYN) ? 0 : c.rcvNxt);
+	tcp[12] = (tcpHeaderLength / 4) << 4;
+	tcp[13] = flags | ((flags & TCP_SYN) ? 0 : TCP_ACK);
+	Put16(tcp + 14, ReceiveWindow);
+	Put16(tcp + 16, 0);
+	Put16(tcp + 18, 0);
+	if (withMss)
+	{
+		tcp[20] = 2;
+		tcp[21] = 4;
+		Put16(tcp + 22, MSS);
+	}
+	if (length != 0)
+	{
+		memcpy(tcp + tcpHeaderLength, data, length);
+	}
+
+	// Pseudo header: source, destination, protocol and TCP length
+	uint32_t sum = Get16(ipAddress) + Get16(ipAddress + 2) + Get16(serverIpAddress) + Get16(serverIpAddress + 2) + 6 + tcpHeaderLength + length;
+	Put16(tcp + 16, Checksum(tcp, tcpHeaderLength + length, sum));
+
+	SendFrame(frame, 14 + ipLength);
+}
+
+void TestClient::SendRst(uint16_t localPort, uint16_t remotePort, uint32_t seq)
+{
+	Connection c;
+	c.localPort = localPort;
+	c.remotePort = remotePort;
+	c.rcvNxt = 0;
+	SendSegment(c, seq, TCP_RST, nullptr, 0);
+}
+
+// Send as much queued data as the peer's window allows, then our FIN if it has been asked for
+void TestClient::Transmit(Connection& c)
+{
+	if (c.state != State::established)
+	{
+		return;
+	}
+
+	size_t inFlight = c.sndNxt - c.sndUna;
+	if (c.finSent)
+	{
+		return;
+	}
+
+	while (inFlight < c.sendBuffer.size() && inFlight < c.peerWindow)
+	{
+		size_t length = c.sendBuffer.size() - inFlight;
+		if (length > MSS)
+		{
+			length = MSS;
+		}
+		if (length > c.peerWindow - inFlight)
+		{
+			length = c.peerWindow - inFlight;
+		}
+		SendSegment(c, c.sndNxt, TCP_PSH, c.sendBuffer.data() + inFlight, length);
+		c.sndNxt += length;
+		inFlight += length;
+	}
+
+	if (c.closeRequested && inFlight == c.sendBuffer.size())
+	{
+		SendSegment(c, c.sndNxt, TCP_FIN, nullptr, 0);
+		++c.sndNxt;
+		c.finSent = true;
+	}
+}
+
+void TestClient::HandleTcp(const uint8_t *ip, size_t length)
+{
+	const size_t ipHeaderLength = (ip[0] & 0x0F) * 4;
+	const size_t totalLength = Get16(ip + 2);
+	if (totalLength > length || totalLength < ipHeaderLength + 20 || memcmp(ip + 16, ipAddress, 4) != 0)
+	{
+		return;
+	}
+
+	const uint8_t * const tcp = ip + ipHeaderLength;
+	const size_t tcpHeaderLength = (tcp[12] >> 4) * 4;
+	const char * const data = (const char *)tcp + tcpHeaderLength;
+	const size_t dataLength = totalLength - ipHeaderLength - tcpHeaderLength;
+	const uint32_t seq = Get32(tcp + 4), ack = Get32(tcp + 8);
+	const uint8_t flags = tcp[13];
+
+	Connection * const c = Find(Get16(tcp + 2), Get16(tcp));
+	if (c == nullptr || c->state == State::closed)
+	{
+		if ((flags & TCP_RST) == 0)
+		{
+			SendRst(Get16(tcp + 2), Get16(tcp), ack);
+		}
+		return;
+	}
+
+	if (flags & TCP_RST)
+	{
+		c->state = State::closed;
+		c->wasReset = true;
+		++stats.resets;
+		return;
+	}
+
+	if (c->state == State::synSent)
+	{
+		if ((flags & (TCP_SYN | TCP_ACK)) == (TCP_SYN | TCP_ACK) && ack == c->sndNxt)
+		{
+			c->state = State::established;
+			c->rcvNxt = seq + 1;
+			c->sndUna = ack;
+			c->peerWindow = Get16(tcp + 14);
+			c->lastProgress = millis();
+			SendSegment(*c, c->sndNxt, 0, nullptr, 0);
+			Transmit(*c);
+		}
+		return;
+	}
+
+	// Process the acknowledgement
+	if (flags & TCP_ACK)
+	{
+		if (SeqBefore(c->sndUna, ack) && !SeqBefore(c->sndNxt, ack))
+		{
+			size_t acked = ack - c->sndUna;
+			if (c->finSent && ack == c->sndNxt)
+			{
+				--acked;									// our FIN doesn't occupy the send buffer
+			}
+			c->sendBuffer.erase(0, acked);
+			c->sndUna = ack;
+			c->lastProgress = millis();
+		}
+		c->peerWindow = Get16(tcp + 14);
+	}
+
+	// Process the data and FIN, we only accept what arrives in order
+	if (dataLength != 0 || (flags & TCP_FIN))
+	{
+		if (seq == c->rcvNxt && !c->finReceived)
+		{
+			c->received.append(data, dataLength);
+			c->rcvNxt += dataLength;
+			if (flags & TCP_FIN)
+			{
+				++c->rcvNxt;
+				c->finReceived = true;
+			}
+		}
+		SendSegment(*c, c->sndNxt, 0, nullptr, 0);
+	}
+
+	if (c->finReceived && c->finSent && c->sndUna == c->sndNxt)
+	{
+		c->state = State::closed;
+	}
+	else
+	{
+		Transmit(*c);
+	}
+}
+
+void TestClient::Poll()
+{
+	uint8_t frame[1536];
+	size_t length;
+	while ((length = ethernet_host_receive(frame, sizeof(frame))) != 0)
+	{
+		++stats.framesReceived;
+		if (length < 14 || (memcmp(frame, macAddress, 6) != 0 && frame[0] != 0xFF))
+		{
+			continue;
+		}
+
+		const uint16_t type = Get16(frame + 12);
+		if (type == 0x0806)
+		{
+			HandleArp(frame, length);
+		}
+		else if (type == 0x0800 && length >= 34 && frame[14 + 9] == 6)
+		{
+			HandleTcp(frame + 14, length - 14);
+		}
+	}
+
+	// Send unacknowledged data again if nothing has happened for a while. If the window is closed, this probes it.
+	const uint32_t now = millis();
+	for (Connection& c : connections)
+	{
+		if (c.inUse && c.state == State::synSent && now - c.lastProgress >= RetransmitTimeout)
+		{
+			++stats.retransmissions;
+			c.lastProgress = now;
+			SendSegment(c, c.sndUna, TCP_SYN, nullptr, 0, true);
+		}
+		else if (c.inUse && c.state == State::established && c.sndNxt != c.sndUna && now - c.lastProgress >= RetransmitTimeout)
+		{
+			++stats.retransmissions;
+			c.lastProgress = now;
+			c.sndNxt = c.sndUna;
+			c.finSent = false;
+			if (c.peerWindow == 0 && !c.sendBuffer.empty())
+			{
+				SendSegment(c, c.sndNxt, 0, c.sendBuffer.data(), 1);
+				++c.sndNxt;
+			}
+			else
+			{
+				Transmit(c);
+			}
+		}
+	}
+}
+
+bool TestClient::RunUntil(std::function<bool()> condition, uint32_t timeout)
+{
+	const uint32_t start = millis();
+	for (;;)
+	{
+		spin();
+		Poll();
+		if (condition())
+		{
+			return true;
+		}
+		if (millis() - start >= timeout)
+		{
+			return false;
+		}
+	}
+}
+
+bool TestClient::WaitForEstablished(int conn, uint32_t timeout)
+{
+	return RunUntil([this, conn]() { return IsEstablished(conn) || WasReset(conn); }, timeout) && IsEstablished(conn);
+}
+
+bool TestClient::WaitForText(int conn, const char *text, uint32_t timeout)
+{
+	return RunUntil([this, conn, text]() { return Received(conn).find(text) != std::string::npos || IsFinished(conn); }, timeout)
+			&& Received(conn).find(text) != std::string::npos;
+}
+
+bool TestClient::WaitForFinished(int conn, uint32_t timeout)
+{
+	return RunUntil([this, conn]() { return IsFinished(conn); }, timeout);
+}
+
+// End
@@ -0,0 +1,93 @@
+/*
+ * TestClient.h
+ *
+ * A minimal Ethernet/ARP/IPv4/TCP client for the host network test. It exchanges frames with the firmware through the
+ * in-memory netif of ethernet_host.c, so everything the firmware does - lwIP, Network and Webserver - runs unchanged.
+ *
+ * The client is deliberately simple: no options except MSS, no window scaling, no out-of-order queue. Every data
+ * segment and FIN is acknowledged straight away, and unacknowledged data is sent again (go-back-N) after a timeout.
+ */
+
+#ifndef TESTCLIENT_H_
+#define TESTCLIENT_H_
+
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+class TestClient
+{
+public:
+	// Counters of things the client had to put up with
+	struct Stats
+	{
+		uint32_t framesSent, framesReceived;
+		uint32_t framesDropped;				// frames the firmware's receive buffers didn't accept
+		uint32_t retransmissions;			// timeouts that made us send unacknowledged data again
+		uint32_t resets;					// connections reset by the firmware
+	};
+
+	TestClient(const uint8_t ip[4], const uint8_t serverIp[4], std::function<void()> spin);
+
+	bool Resolve(uint32_t timeout);						// Find the MAC address of the firmware with ARP
+
+	int Connect(uint16_t port);							// Start a connection, returns its handle
+	void Write(int conn, const std::string& data);		// Queue data, it is sent as the peer's window allows
+	void WriteOutOfOrder(int conn, const std::string& data, size_t split);	// Send data[split..] before data[0..split]
+	void Close(int conn);								// Send a FIN once all queued data has gone
+	void Release(int conn);								// Forget a connection, sending RST if it is still open
+
+	bool IsEstablished(int conn) const;
+	bool IsFinished(int conn) const;					// The firmware has closed its side or reset the connection
+	bool AllSent(int conn) const;						// All queued data has been acknowledged
+	bool WasReset(int conn) const;
+	std::string& Received(int conn);					// Data received so far, the caller may consume it
+
+	void Poll();										// Process frames from the firmware and send pending data
+	bool RunUntil(std::function<bool()> condition, uint32_t timeout);	// Spin the firmware and poll until the condition holds
+
+	// Blocking helpers
+	bool WaitForEstablished(int conn, uint32_t timeout);
+	bool WaitForText(int conn, const char *text, uint32_t timeout);		// Wait until the received data contains the text
+	bool WaitForFinished(int conn, uint32_t timeout);
+
+	const Stats& GetStats() const { return stats; }
+
+private:
+	enum class State : uint8_t { synSent, established, closed };
+
+	struct Connection
+	{
+		bool inUse;
+		State state;
+		uint16_t localPort, remotePort;
+		uint32_t sndUna, sndNxt, rcvNxt;
+		uint16_t peerWindow;
+		std::string sendBuffer;							// data from sndUna onwards, both in flight and unsent
+		std::string received;
+		bool closeRequested, finSent, finReceived, wasReset;
+		uint32_t lastProgress;							// when something we sent was last acknowledged
+	};
+
+	void HandleArp(const uint8_t *frame, size_t length);
+	void HandleTcp(const uint8_t *ip, size_t length);
+	void Transmit(Connection& c);
+	void SendSegment(Connection& c, uint32_t seq, uint8_t flags, const char *data, size_t length, bool withMss = false);
+	void SendFrame(const uint8_t *frame, size_t length);
+	void SendRst(uint16_t localPort, uint16_t remotePort, uint32_t seq);
+	Connection *Find(uint16_t localPort, uint16_t remotePort);
+
+	static uint16_t Checksum(const uint8_t *data, size_t length, uint32_t sum = 0);
+
+	std::function<void()> spin;
+	uint8_t ipAddress[4], serverIpAddress[4];
+	uint8_t macAddress[6], serverMacAddress[6];
+	bool serverMacKnown;
+	uint16_t nextPort, nextIpId;
+	std::vector<Connection> connections;
+	Stats stats;
+};
+
+#endif /* TESTCLIENT_H_ */